@@ -125,18 +125,19 @@ static void testUtility() {
 }
 
 #include "../include/wwidget/Font.hpp"
-#include "../include/wwidget/fonts/FontDescription.hpp"
+#include "../include/wwidget/Bitmap.hpp"
 
 #include <fstream>
 
 static void testFont() {
 	Font font("/usr/share/fonts/TTF/DejaVuSerif.ttf");
-	shared_ptr<BitmapFont> bmf = font.get(32);
+	for(uint32_t c = 32; c < 127; c++) font.glyph(c);
+	Bitmap const& bmf = font.atlas();
 
 	if(auto file = std::ofstream("./test.txt")) {
-		for(size_t y = 0; y < bmf->height(); y++) {
-			for(size_t x = 0; x < bmf->width(); x++) {
-				size_t idx = x + y * bmf->width();
+		for(size_t y = 0; y < bmf.height(); y++) {
+			for(size_t x = 0; x < bmf.width(); x++) {
+				size_t idx = x + y * bmf.width();
 				// " .-:=+*#@";
 				const char ramp[] =
 					"@MBHENR#KWXDFPQASUZbdehx"
@@ -144,7 +145,7 @@ static void testFont() {
 					"z$CIu23Jcfry%1v7l+it[] {"
 					"}?j|()=~!-/<>\"^_';,:`. ";
 
-				float f = (sizeof(ramp) - 2) * (1 - bmf->data()[idx] / 255.f);
+				float f = (sizeof(ramp) - 2) * (1 - bmf.data()[idx] / 255.f);
 
 				file << ramp[(size_t) f];
 			}
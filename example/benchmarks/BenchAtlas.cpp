@@ -0,0 +1,117 @@
+#include <wwidget/CanvasNVG.hpp>
+#include <wwidget/Bitmap.hpp>
+
+#include "Benchmark.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+using namespace wwidget;
+
+namespace {
+
+/// A nanovg backend which doesn't render, but counts what a GL backend would do
+struct CountingRenderer {
+	int    nextImage     = 1;
+	size_t textures      = 0; //!< Live textures
+	size_t uploads       = 0; //!< Texture creations and updates
+	size_t drawCalls     = 0; //!< Fill, stroke and triangle calls, each is at least one draw call in nanovg's GL backend
+	size_t textureBinds  = 0; //!< Draw calls which use a different texture than the one before
+	int    boundTexture  = -1;
+
+	void draw(NVGpaint* paint) {
+		++drawCalls;
+		if(paint->image != boundTexture) {
+			boundTexture = paint->image;
+			++textureBinds;
+		}
+	}
+	void resetFrame() { drawCalls = textureBinds = uploads = 0; boundTexture = -1; }
+
+	static CountingRenderer& self(void* uptr) { return *(CountingRenderer*) uptr; }
+
+	NVGcontext* create() {
+		NVGparams params;
+		memset(&params, 0, sizeof(params));
+		params.userPtr = this;
+		params.renderCreate = [](void*) { return 1; };
+		params.renderCreateTexture = [](void* u, int, int, int, int, const unsigned char*) {
+			self(u).textures++; self(u).uploads++; return self(u).nextImage++;
+		};
+		params.renderDeleteTexture = [](void* u, int) { self(u).textures--; return 1; };
+		params.renderUpdateTexture = [](void* u, int, int, int, int, int, const unsigned char*) { self(u).uploads++; return 1; };
+		params.renderGetTextureSize = [](void*, int, int* w, int* h) { *w = *h = 1; return 1; };
+		params.renderViewport = [](void* u, float, float, float) { self(u).boundTexture = -1; }; // Every frame starts unbound
+		params.renderCancel   = [](void*) {};
+		params.renderFlush    = [](void*) {};
+		params.renderFill = [](void* u, NVGpaint* p, NVGcompositeOperationState, NVGscissor*, float, const float*, const NVGpath*, int) { self(u).draw(p); };
+		params.renderStroke = [](void* u, NVGpaint* p, NVGcompositeOperationState, NVGscissor*, float, float, const NVGpath*, int) { self(u).draw(p); };
+		params.renderTriangles = [](void* u, NVGpaint* p, NVGcompositeOperationState, NVGscissor*, const NVGvertex*, int) { self(u).draw(p); };
+		params.renderDelete = [](void*) {};
+		return nvgCreateInternal(&params);
+	}
+};
+
+constexpr unsigned IconCount = 500;
+constexpr unsigned IconSize  = 32;
+constexpr unsigned Columns   = 25;
+
+void run(bool atlas, bool backgrounds) {
+	CountingRenderer renderer;
+	std::vector<shared<Bitmap>> icons;
+	double frameTime;
+	{
+		CanvasNVG canvas(renderer.create(), nvgDeleteInternal);
+		canvas.useAtlas(atlas);
+
+		for(unsigned i = 0; i < IconCount; i++) {
+			auto bm = make_shared<Bitmap>();
+			bm->init(IconSize, IconSize, Bitmap::RGBA);
+			memset(bm->data(), (int) i, IconSize * IconSize * 4);
+			icons.emplace_back(std::move(bm));
+		}
+
+		auto frame = [&]() {
+			canvas.beginFrame({Columns * 40.f, (IconCount / Columns) * 40.f}, 92);
+			for(unsigned i = 0; i < IconCount; i++) {
+				Rect to { (i % Columns) * 40.f, (i / Columns) * 40.f, (float) IconSize, (float) IconSize };
+				if(backgrounds) {
+					canvas.fillColor(Color::black()).rect(to).fill();
+				}
+				canvas.fillTexture(to, icons[i]).rect(to).fill();
+			}
+			canvas.endFrame();
+		};
+
+		renderer.resetFrame();
+		frame(); // First frame creates the textures
+		size_t firstUploads = renderer.uploads;
+
+		renderer.resetFrame();
+		BenchTimer timer;
+		constexpr int Frames = 200;
+		for(int i = 0; i < Frames; i++) frame();
+		frameTime = timer.micros() / Frames;
+
+		printf("%-8s %-16s textures %4zu   uploads (first frame) %4zu   draw calls/frame %5zu   texture binds/frame %5zu   cpu %7.1fus/frame\n",
+			atlas ? "atlas" : "no atlas", backgrounds ? "icon+background" : "icons only",
+			renderer.textures, firstUploads,
+			renderer.drawCalls / Frames, renderer.textureBinds / Frames,
+			frameTime);
+
+		icons.clear(); // Releases all regions, the page has to be evicted
+		if(renderer.textures > 1) { // Only nanovg's font atlas should be left
+			printf("!! %zu textures leaked\n", renderer.textures - 1);
+		}
+	}
+}
+
+} // namespace
+
+void benchAtlas() {
+	bench_header("CanvasNVG: 500 icons (32x32), with and without texture atlas");
+	for(bool backgrounds : { false, true }) {
+		run(false, backgrounds);
+		run(true, backgrounds);
+	}
+}
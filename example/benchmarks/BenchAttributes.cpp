@@ -0,0 +1,108 @@
+#include <wwidget/widget/Text.hpp>
+
+#include "Benchmark.hpp"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace wwidget;
+
+namespace {
+
+constexpr int Widgets = 2000;
+constexpr int Runs    = 20;
+
+/// An attribute with a value which doesn't have to be parsed, like the ones of compiled forms and lua
+struct FloatAttribute final : public Attribute {
+	float value;
+	FloatAttribute(float f) : value(f) {}
+	float toFloat() const override { return value; }
+	bool  toBool() const override { return value != 0; }
+	Padding toPadding() const override { return Padding(value); }
+};
+
+/// Sets attributes of the text and of its base class, the values change every run so the setters don't return early
+struct Values {
+	std::string fontSize, wrap, width, height, padding, cacheAsLayer;
+
+	Values(int run) :
+		fontSize(std::to_string(12 + run % 2)),
+		wrap(run % 2 ? "true" : "false"),
+		width(std::to_string(100 + run % 2)),
+		height(std::to_string(20 + run % 2)),
+		padding(std::to_string(2 + run % 2)),
+		cacheAsLayer("false")
+	{}
+};
+constexpr int AttributesPerWidget = 6;
+
+template<class Fn>
+void run(const char* name, Fn&& apply) {
+	std::vector<shared<Text>> texts;
+	for(int i = 0; i < Widgets; i++) texts.push_back(make_shared<Text>());
+
+	std::vector<double> samples;
+	for(int r = 0; r < Runs; r++) {
+		BenchTimer timer;
+		for(auto& text : texts) apply(*text, r);
+		samples.push_back(timer.micros() * 1000 / (Widgets * AttributesPerWidget));
+	}
+	bench_keep(texts);
+	double median = bench_percentile(samples, .5);
+	printf("%-28s median %6.1fns   min %6.1fns per attribute\n", name, median, samples.front());
+}
+
+} // namespace
+
+void benchAttributes() {
+	bench_header("Setting 6 attributes of 2000 texts");
+
+	std::vector<Values> values;
+	for(int r = 0; r < Runs; r++) values.emplace_back(r);
+
+	run("by name, parsed", [&](Text& t, int r) {
+		auto& v = values[r];
+		t.setAttribute("fontSize",     StringAttribute(v.fontSize));
+		t.setAttribute("wrap",         StringAttribute(v.wrap));
+		t.setAttribute("width",        StringAttribute(v.width));
+		t.setAttribute("height",       StringAttribute(v.height));
+		t.setAttribute("padding",      StringAttribute(v.padding));
+		t.setAttribute("cacheAsLayer", StringAttribute(v.cacheAsLayer));
+	});
+	run("by name, typed", [&](Text& t, int r) {
+		t.setAttribute("fontSize",     FloatAttribute(12 + r % 2));
+		t.setAttribute("wrap",         FloatAttribute(r % 2));
+		t.setAttribute("width",        FloatAttribute(100 + r % 2));
+		t.setAttribute("height",       FloatAttribute(20 + r % 2));
+		t.setAttribute("padding",      FloatAttribute(2 + r % 2));
+		t.setAttribute("cacheAsLayer", FloatAttribute(0));
+	});
+
+	// Like Form, lua and the editor can do: the attributes are looked up once
+	auto& table        = Text::classAttributes();
+	auto* fontSize     = table.find("fontSize");
+	auto* wrap         = table.find("wrap");
+	auto* width        = table.find("width");
+	auto* height       = table.find("height");
+	auto* padding      = table.find("padding");
+	auto* cacheAsLayer = table.find("cacheAsLayer");
+
+	run("resolved, parsed", [&](Text& t, int r) {
+		auto& v = values[r];
+		fontSize->set(t,     StringAttribute(v.fontSize));
+		wrap->set(t,         StringAttribute(v.wrap));
+		width->set(t,        StringAttribute(v.width));
+		height->set(t,       StringAttribute(v.height));
+		padding->set(t,      StringAttribute(v.padding));
+		cacheAsLayer->set(t, StringAttribute(v.cacheAsLayer));
+	});
+	run("resolved, typed", [&](Text& t, int r) {
+		fontSize->set(t,     12.f + r % 2);
+		wrap->set(t,         r % 2 != 0);
+		width->set(t,        100.f + r % 2);
+		height->set(t,       20.f + r % 2);
+		padding->set(t,      Padding(2.f + r % 2));
+		cacheAsLayer->set(t, false);
+	});
+}
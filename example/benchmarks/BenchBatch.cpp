@@ -0,0 +1,65 @@
+#include <wwidget/CanvasSoftware.hpp>
+
+#include "Benchmark.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+using namespace wwidget;
+
+namespace {
+
+constexpr int Count  = 100000;
+constexpr int Width  = 1280;
+constexpr int Height = 720;
+
+/// Best of a few frames, so the first frame's allocations don't count
+template<class Draw>
+double frameTime(Canvas& canvas, Draw&& draw) {
+	double best = 1e9;
+	for(int frame = 0; frame < 5; frame++) {
+		canvas.beginFrame({Width, Height}, 96);
+		BenchTimer timer;
+		draw(canvas);
+		best = std::min(best, timer.seconds());
+		canvas.endFrame();
+	}
+	return best;
+}
+
+void compare(Canvas& canvas, const char* name, std::vector<Rect> const& areas, std::vector<Color> const& colors) {
+	double single = frameTime(canvas, [&](Canvas& c) {
+		for(size_t i = 0; i < areas.size(); i++)
+			c.fillColor(colors[i]).rect(areas[i]).fill();
+	});
+	double batched = frameTime(canvas, [&](Canvas& c) {
+		c.rects(areas.data(), colors.data(), areas.size());
+	});
+	printf("%-34s one at a time %8.2fms   batched %8.2fms   %5.1fx\n",
+		name, single * 1e3, batched * 1e3, single / batched);
+}
+
+} // namespace
+
+void benchBatch() {
+	bench_header("CanvasSoftware: 100k rects, one at a time vs. Canvas::rects()");
+
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> x(0, Width - 4), y(0, Height - 4);
+
+	std::vector<Rect>  areas;
+	std::vector<Color> colors;
+	for(int i = 0; i < Count; i++) {
+		areas.push_back({ std::floor(x(rng)), std::floor(y(rng)), 4, 4 });
+		colors.push_back(rgb(i * 7, i * 13, i * 3));
+	}
+
+	CanvasSoftware software;
+	compare(software, "4x4 opaque", areas, colors);
+
+	for(auto& a : areas) { a.min.x += .5f; a.max.x += .5f; }
+	for(auto& c : colors) c.a = .5f;
+	compare(software, "4x4 translucent, half pixel offset", areas, colors);
+}
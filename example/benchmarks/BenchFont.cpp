@@ -0,0 +1,91 @@
+#include <wwidget/Font.hpp>
+
+#include "Benchmark.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+
+// The baseline rasterizes coverage bitmaps per size, like fontstash does
+#if defined(__GNUC__)
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wunused-function"
+#endif
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "../../src/thirdparty/stb_truetype.h"
+#if defined(__GNUC__)
+	#pragma GCC diagnostic pop
+#endif
+
+using namespace wwidget;
+
+namespace {
+
+constexpr int SizeCount = 20;
+float sizeAt(int i) { return 8 + i * 3; } // 8px to 65px
+
+} // namespace
+
+void benchFont() {
+	bench_header("Font: SDF atlas vs. one coverage bitmap per size (printable ASCII, 20 sizes)");
+
+	const char* path = getenv("WWIDGET_BENCH_FONT");
+	if(!path) path = "/usr/share/fonts/TTF/LiberationMono-Regular.ttf";
+
+	std::ifstream file(path, std::ios::binary);
+	std::vector<uint8_t> data{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+	stbtt_fontinfo info;
+	if(data.empty() || !stbtt_InitFont(&info, data.data(), stbtt_GetFontOffsetForIndex(data.data(), 0))) {
+		printf("skipped: couldn't load '%s', set WWIDGET_BENCH_FONT to a .ttf file\n", path);
+		return;
+	}
+
+	// Baseline: every size rasterizes every glyph again
+	{
+		BenchTimer timer;
+		size_t bytes = 0;
+		for(int i = 0; i < SizeCount; i++) {
+			float scale = stbtt_ScaleForPixelHeight(&info, sizeAt(i));
+			for(uint32_t c = 32; c < 127; c++) {
+				int w = 0, h = 0, xoff, yoff;
+				uint8_t* bm = stbtt_GetCodepointBitmap(&info, scale, scale, c, &w, &h, &xoff, &yoff);
+				bytes += size_t(w) * h;
+				bench_keep(bm);
+				stbtt_FreeBitmap(bm, nullptr);
+			}
+		}
+		printf("%-22s rasterized %5d glyphs   %8.2fms   glyph memory %7zu KiB (before atlas padding)\n",
+			"per size (fontstash)", SizeCount * 95, timer.seconds() * 1e3, bytes / 1024);
+	}
+
+	// SDF: every glyph is rasterized once and scaled for every size
+	{
+		Font font;
+		font.load(std::move(data));
+
+		BenchTimer timer;
+		float      width = 0;
+		for(int i = 0; i < SizeCount; i++) {
+			for(uint32_t c = 32; c < 127; c++) {
+				auto& g = font.glyph(c);
+				width += g.advance * sizeAt(i);
+			}
+		}
+		bench_keep(width);
+		double first = timer.seconds();
+
+		timer.reset();
+		for(int i = 0; i < SizeCount; i++) {
+			for(uint32_t c = 32; c < 127; c++) {
+				width += font.glyph(c).advance * sizeAt(i);
+			}
+		}
+		bench_keep(width);
+
+		printf("%-22s rasterized %5zu glyphs   %8.2fms   atlas %ux%u, total memory %7zu KiB   cached lookups %.2fus\n",
+			"sdf atlas", font.stats().rasterized, first * 1e3,
+			font.atlas().width(), font.atlas().height(), font.memoryUsage() / 1024, timer.micros());
+	}
+}
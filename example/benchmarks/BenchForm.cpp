@@ -0,0 +1,92 @@
+#include <wwidget/widget/Form.hpp>
+
+#include "Benchmark.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+using namespace wwidget;
+
+// Generated from Rows.form.xml by the FormCpp rule
+wwidget::Form& form_Rows(wwidget::Form& form);
+
+namespace {
+
+constexpr int Rows = 1250; // 4 elements each
+constexpr int Runs = 10;
+
+constexpr int NestedForms = 500;
+
+constexpr const char* RowsPath = "example/benchmarks/Rows.form.xml"; // 50 of the rows of makeForm()
+constexpr int         RowsRuns = 200;
+
+std::string makeForm() {
+	std::string xml = "<form padding=\"4\">\n";
+	for(int i = 0; i < Rows; i++) {
+		xml +=
+			"\t<list flow=\"right\" padding=\"2 4\" align=\"fill\">\n"
+			"\t\t<text content=\"Item " + std::to_string(i) + "\" fontSize=\"14\" fontColor=\".9 .9 .9\"/>\n"
+			"\t\t<slider start=\"0\" scale=\"100\" width=\"120\"/>\n"
+			"\t\t<button text=\"Go\" align=\"center\"/>\n"
+			"\t</list>\n";
+	}
+	xml += "</form>\n";
+	return xml;
+}
+
+std::string makeNestedForms() {
+	std::string xml = "<form>\n";
+	for(int i = 0; i < NestedForms; i++) {
+		xml += "\t<form><text content=\"Item " + std::to_string(i) + "\"/></form>\n";
+	}
+	xml += "</form>\n";
+	return xml;
+}
+
+template<class Fn>
+void run(const char* name, Fn&& load, int runs = Runs) {
+	std::vector<double> samples;
+	for(int i = 0; i < runs; i++) {
+		auto form = make_shared<Form>();
+		form->addDefaultFactories();
+		BenchTimer timer;
+		load(*form);
+		samples.push_back(timer.micros() / 1000);
+		bench_keep(form);
+	}
+	double median = bench_percentile(samples, .5);
+	printf("%-12s median %8.2fms   min %8.2fms\n", name, median, samples.front());
+}
+
+} // namespace
+
+void benchForm() {
+	bench_header("Loading a form with 5000 elements from memory");
+
+	std::string xml      = makeForm();
+	std::string compiled = make_shared<Form>()->compile(xml.c_str());
+	printf("xml %zu bytes, compiled %zu bytes\n", xml.size(), compiled.size());
+
+	run("xml", [&](Form& form) { form.parse(xml.c_str()); });
+	run("compiled", [&](Form& form) { form.parseCompiled(compiled.data(), compiled.size()); });
+
+	bench_header("Loading a form with 500 nested forms");
+	std::string nested = makeNestedForms();
+	run("xml", [&](Form& form) { form.parse(nested.c_str()); });
+
+	bench_header("Loading a form with 200 elements, xml vs generated code vs prototypes");
+	std::ifstream file(RowsPath, std::ios::binary);
+	if(!file) {
+		printf("skipped: %s not found, run from the repository root\n", RowsPath);
+		return;
+	}
+	std::string rows { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+	std::string rowsCompiled = make_shared<Form>()->compile(rows.c_str());
+
+	run("xml", [&](Form& form) { form.parse(rows.c_str()); }, RowsRuns);
+	run("compiled", [&](Form& form) { form.parseCompiled(rowsCompiled.data(), rowsCompiled.size()); }, RowsRuns);
+	run("generated", [&](Form& form) { form_Rows(form); }, RowsRuns);
+	run("load", [&](Form& form) { form.load(RowsPath); }, RowsRuns); // The first run parses, the others clone the prototype
+}
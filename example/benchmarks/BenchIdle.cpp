@@ -0,0 +1,91 @@
+#include <wwidget/BasicContext.hpp>
+#include <wwidget/CanvasSoftware.hpp>
+#include <wwidget/widget/List.hpp>
+
+#include "Benchmark.hpp"
+
+#include <cstdio>
+#include <ctime>
+#include <thread>
+
+using namespace wwidget;
+
+namespace {
+
+using Clock = BasicContext::Clock;
+
+constexpr double Seconds = 1;
+constexpr auto   Vsync   = std::chrono::microseconds(16667);
+constexpr auto   Blink   = std::chrono::milliseconds(500);
+
+/// A row of a settings page, nothing about it changes
+class Row : public Widget {
+protected:
+	PreferredSize onCalcPreferredSize(PreferredSize const& constraint) override {
+		return { Size(100, 24), Size(100, 24), Size(10000, 24) };
+	}
+	void onDrawBackground(Canvas& c) override {
+		c.fillColor(rgb(48, 48, 48)).rect(Rect(size())).fill();
+		c.fillColor(rgba(255, 255, 255, .6f)).rect({8, 8, 120, 8}, 3).fill();
+	}
+};
+
+/// A blinking text cursor: the only animation of an idle UI
+class Caret : public Widget {
+	Clock::time_point mStart = Clock::now();
+protected:
+	PreferredSize onCalcPreferredSize(PreferredSize const& constraint) override {
+		return { Size(2, 24), Size(2, 24), Size(2, 24) };
+	}
+	void onDraw(Canvas& c) override {
+		auto phases = (Clock::now() - mStart) / Blink;
+		if(phases % 2 == 0) c.fillColor(Color::white()).rect(Rect(size())).fill();
+		context()->requestFrame(mStart + (phases + 1) * Blink);
+	}
+};
+
+void run(const char* name, bool onDemand) {
+	BasicContext context;
+	context.headless({400, 600});
+	context.canvas(make_shared<CanvasSoftware>());
+	context.renderOnDemand(onDemand);
+
+	auto list = context.rootWidget()->add<List>();
+	for(int i = 0; i < 24; i++) list->add<Row>()->alignx(AlignFill);
+	list->add<Caret>();
+
+	size_t frames = 0;
+	auto   wall   = Clock::now();
+	auto   end    = wall + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(Seconds));
+	auto   cpu    = std::clock();
+	if(onDemand) {
+		context.requestFrame(end);
+		while(Clock::now() < end) {
+			context.update();
+			frames += context.needsDraw();
+			context.draw();
+			context.waitEvents();
+		}
+	}
+	else {
+		// Stands in for a window which polls for events and is throttled by vsync when it swaps
+		for(auto next = wall; Clock::now() < end; next += Vsync) {
+			context.update();
+			context.draw();
+			++frames;
+			std::this_thread::sleep_until(next + Vsync);
+		}
+	}
+	double cpuSeconds  = (double)(std::clock() - cpu) / CLOCKS_PER_SEC;
+	double wallSeconds = std::chrono::duration<double>(Clock::now() - wall).count();
+	printf("%-22s %5zu frames   %8.2fms cpu   %6.2f%% of a core\n",
+		name, frames, cpuSeconds * 1e3, 100 * cpuSeconds / wallSeconds);
+}
+
+} // namespace
+
+void benchIdle() {
+	bench_header("Idle UI with a blinking caret for 1s, CanvasSoftware 400x600");
+	run("poll, 60Hz", false);
+	run("render on demand", true);
+}
@@ -0,0 +1,65 @@
+#include <wwidget/Attributes.hpp>
+
+#include "Benchmark.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace wwidget;
+
+namespace {
+
+constexpr int Values = 20000;
+constexpr int Runs   = 20;
+
+template<class Fn>
+void run(const char* name, std::vector<std::string> const& values, Fn&& parse) {
+	std::vector<double> samples;
+	size_t bytes = 0;
+	for(auto& v : values) bytes += v.size();
+
+	for(int r = 0; r < Runs; r++) {
+		BenchTimer timer;
+		for(auto& v : values) parse(v);
+		samples.push_back(timer.micros());
+	}
+	double median = bench_percentile(samples, .5);
+	printf("%-30s median %6.1fns per value   %7.1f MB/s\n", name, median * 1000 / values.size(), bytes / median);
+}
+
+std::vector<std::string> generate(std::string (*value)(int i)) {
+	std::vector<std::string> result;
+	for(int i = 0; i < Values; i++) result.push_back(value(i));
+	return result;
+}
+
+} // namespace
+
+void benchParsing() {
+	bench_header("Parsing 20000 attribute values");
+
+	auto floats = generate([](int i) { return std::to_string(i * .37f); });
+	auto vectors = generate([](int i) {
+		return std::to_string(i % 7) + " " + std::to_string(i % 5 * 1.5f) + " " + std::to_string(i % 3) + " " + std::to_string(i % 11 * .25f);
+	});
+	auto hexColors = generate([](int i) {
+		char buffer[16];
+		snprintf(buffer, sizeof(buffer), "#%06x", (unsigned)(i * 2654435761u) & 0xFFFFFF);
+		return std::string(buffer);
+	});
+	auto namedColors = generate([](int i) {
+		const char* names[] = { "black", "white", "red", "orange", "transparent", "teal" };
+		return std::string(names[i % std::size(names)]);
+	});
+
+	float sink = 0;
+	run("float, strtof (reference)", floats, [&](std::string const& s) { sink += strtof(s.c_str(), nullptr); });
+	run("float", floats, [&](std::string const& s) { sink += StringAttribute(s).toFloat(); });
+	run("padding, 4 values", vectors, [&](std::string const& s) { sink += StringAttribute(s).toPadding().left; });
+	run("color, 4 values", vectors, [&](std::string const& s) { sink += StringAttribute(s).toColor().r; });
+	run("color, #rrggbb", hexColors, [&](std::string const& s) { sink += StringAttribute(s).toColor().r; });
+	run("color, named", namedColors, [&](std::string const& s) { sink += StringAttribute(s).toColor().r; });
+	bench_keep(sink);
+}
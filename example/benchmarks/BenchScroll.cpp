@@ -0,0 +1,82 @@
+#include <wwidget/BasicContext.hpp>
+#include <wwidget/CanvasSoftware.hpp>
+#include <wwidget/LayerCache.hpp>
+#include <wwidget/widget/List.hpp>
+
+#include "Benchmark.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+using namespace wwidget;
+
+namespace {
+
+constexpr int   Items  = 10000;
+constexpr int   Frames = 300;
+constexpr float Step   = 4; // Pixels scrolled per frame
+
+bool gLabels = false; // Only with WWIDGET_BENCH_FONT, there's no font to fall back to
+
+/// A list row: background, icon and label
+class Row : public Widget {
+	std::string mLabel;
+protected:
+	PreferredSize onCalcPreferredSize(PreferredSize const& constraint) override {
+		return { Size(100, 24), Size(100, 24), Size(10000, 24) };
+	}
+	void onDrawBackground(Canvas& c) override {
+		c.fillColor(mLabel.size() % 2 ? rgb(48, 48, 48) : rgb(56, 56, 56)).rect(Rect(size())).fill();
+		c.fillColor(rgb(90, 160, 220)).circle({12, 12}, 7).fill();
+		c.fillColor(rgba(255, 255, 255, .6f)).rect({26, 8, 60, 8}, 3).fill();
+		if(gLabels) c.fillColor(Color::white()).text({26, 17}, mLabel);
+	}
+public:
+	Row(int i) : mLabel("Item " + std::to_string(i)) {}
+};
+
+void run(const char* name, bool cached) {
+	BasicContext context;
+	context.headless({400, 600});
+	auto canvas = make_shared<CanvasSoftware>();
+	if(const char* font = getenv("WWIDGET_BENCH_FONT")) {
+		canvas->registerFont("sans", font);
+		gLabels = true;
+	}
+	context.canvas(canvas);
+
+	auto list = context.rootWidget()->add<List>();
+	list->scrollable(true);
+	list->cacheAsLayer(cached);
+	for(int i = 0; i < Items; i++) {
+		auto row = list->add<Row>(i);
+		row->alignx(AlignFill);
+	}
+	context.update();
+	context.draw();
+
+	std::vector<double> samples;
+	canvas->resetCounters();
+	for(int frame = 1; frame <= Frames; frame++) {
+		BenchTimer timer;
+		list->scrollOffset(frame * Step);
+		context.update();
+		context.draw();
+		samples.push_back(timer.micros());
+	}
+
+	double total = 0;
+	for(double s : samples) total += s;
+	printf("%-22s mean %8.1fus   p95 %8.1fus   %9.0f pixels/frame   %zu blits\n",
+		name, total / samples.size(), bench_percentile(samples, .95),
+		(double) canvas->counters().pixels / Frames, context.layers().counters().blits);
+}
+
+} // namespace
+
+void benchScroll() {
+	bench_header("Scrolling a 10k item List by 4px per frame, CanvasSoftware 400x600");
+	run("redraw", false);
+	run("cached, blitted", true);
+}
@@ -0,0 +1,86 @@
+#include <wwidget/CanvasSoftware.hpp>
+#include <wwidget/Bitmap.hpp>
+
+#include "Benchmark.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+using namespace wwidget;
+
+namespace {
+
+constexpr int Width  = 1280;
+constexpr int Height = 720;
+
+template<class Draw>
+void run(CanvasSoftware& canvas, const char* name, int count, Draw&& draw) {
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> x(0, Width), y(0, Height);
+
+	canvas.beginFrame({Width, Height}, 96);
+	canvas.resetCounters();
+	BenchTimer timer;
+	for(int i = 0; i < count; i++) {
+		draw(canvas, Point(x(rng), y(rng)), i);
+	}
+	canvas.endFrame();
+	double seconds = timer.seconds();
+
+	auto& counters = canvas.counters();
+	printf("%-26s %8.0f primitives/s   %8.1f Mpixels/s   (%zu primitives, %5.1fms)\n",
+		name, counters.primitives / seconds, counters.pixels / seconds * 1e-6, counters.primitives, seconds * 1e3);
+}
+
+} // namespace
+
+void benchSoftware() {
+	bench_header("CanvasSoftware: 1280x720 frame");
+
+	CanvasSoftware canvas;
+	const char* font = getenv("WWIDGET_BENCH_FONT");
+	if(font) canvas.registerFont("sans", font);
+
+	run(canvas, "rects 32x32 opaque", 20000, [](Canvas& c, Point p, int i) {
+		c.fillColor(rgb(i * 7, i * 13, i * 3)).rect({p.x, p.y, 32, 32}).fill();
+	});
+	run(canvas, "rects 32x32 translucent", 20000, [](Canvas& c, Point p, int i) {
+		c.fillColor(rgba(i * 7, i * 13, i * 3, .5f)).rect({p.x + .5f, p.y + .5f, 32, 32}).fill();
+	});
+	run(canvas, "rects full frame", 200, [](Canvas& c, Point p, int i) {
+		c.fillColor(rgba(i * 7, i * 13, i * 3, .5f)).rect({0, 0, Width, Height}).fill();
+	});
+	run(canvas, "rounded rects 64x32 r8", 10000, [](Canvas& c, Point p, int i) {
+		c.fillColor(rgba(200, 100, 50, .8f)).rect({p.x, p.y, 64, 32}, 8).fill();
+	});
+	run(canvas, "circles r16", 10000, [](Canvas& c, Point p, int i) {
+		c.fillColor(rgba(50, 100, 200, .8f)).circle(p, 16).fill();
+	});
+	run(canvas, "lines 64px w1.5", 10000, [](Canvas& c, Point p, int i) {
+		c.strokeColor(Color::white()).lineWidth(1.5f).moveTo(p).lineTo(p + Point(48, 42)).stroke();
+	});
+	run(canvas, "stroked rects 32x32 w1", 10000, [](Canvas& c, Point p, int i) {
+		c.strokeColor(Color::black()).lineWidth(1).rect({p.x + .5f, p.y + .5f, 32, 32}).stroke();
+	});
+
+	auto bm = make_shared<Bitmap>();
+	bm->init(64, 64, Bitmap::RGBA);
+	for(unsigned i = 0; i < 64 * 64 * 4; i++) bm->data()[i] = (uint8_t)(i * 31);
+	run(canvas, "textured rects 64x64", 5000, [&](Canvas& c, Point p, int i) {
+		c.fillTexture({p.x, p.y, 64, 64}, bm).rect({p.x, p.y, 64, 64}).fill();
+	});
+
+	if(canvas.font("sans").fontMetrics().line_height > 0) {
+		run(canvas, "text 12px, 16 glyphs", 5000, [](Canvas& c, Point p, int i) {
+			c.fillColor(Color::white()).fontSize(12).text(p, "The quick brown.");
+		});
+		run(canvas, "text 48px, 16 glyphs", 1000, [](Canvas& c, Point p, int i) {
+			c.fillColor(Color::white()).fontSize(48).text(p, "The quick brown.");
+		});
+	}
+	else {
+		printf("text skipped: no font, set WWIDGET_BENCH_FONT to a .ttf file\n");
+	}
+}
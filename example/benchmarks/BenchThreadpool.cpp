@@ -0,0 +1,136 @@
+#include <wwidget/async/Threadpool.hpp>
+
+#include "Benchmark.hpp"
+
+#include <array>
+#include <cstdio>
+
+using namespace wwidget;
+
+namespace {
+
+/// The previous implementation (single locked deque of std::function), kept for comparison
+class LegacyThreadpool {
+	volatile bool            mRunning = false;
+	std::mutex               mMutex;
+	std::condition_variable  mWaiting;
+	std::vector<std::thread> mThreads;
+	std::deque<std::function<void()>> mTasks;
+
+public:
+	LegacyThreadpool(size_t size) {
+		mRunning = true;
+		while(mThreads.size() < size) {
+			mThreads.emplace_back([this]() {
+				while(auto task = await_pop()) task();
+			});
+		}
+	}
+	~LegacyThreadpool() {
+		{ auto l = std::lock_guard<std::mutex>(mMutex); mRunning = false; }
+		mWaiting.notify_all();
+		for(auto& t : mThreads) t.join();
+	}
+
+	void add(std::function<void()>&& fn) {
+		auto l = std::lock_guard<std::mutex>(mMutex);
+		mTasks.emplace_back(fn);
+		mWaiting.notify_one();
+	}
+
+	std::function<void()> await_pop() {
+		auto l = std::unique_lock<std::mutex>(mMutex);
+		if(mTasks.empty()) {
+			mWaiting.wait(l, [this]() { return !mRunning || !mTasks.empty(); });
+			if(!mRunning && mTasks.empty()) return nullptr;
+		}
+		std::function<void()> result = mTasks.front();
+		mTasks.pop_front();
+		return result;
+	}
+};
+
+struct Result {
+	double tasksPerSecond;
+	double p50, p99, p999; // Microseconds from add() to execution
+};
+
+constexpr size_t ThroughputTasks = 200000;
+constexpr size_t LatencyTasks    = 20000;
+constexpr size_t LatencyBurst    = 64;
+
+template<class Pool>
+Result run(size_t threads) {
+	Result result;
+	Pool pool(threads);
+
+	// Throughput: many small tasks from one producer (e.g. image load completions)
+	{
+		std::atomic<size_t> done = 0;
+		BenchTimer timer;
+		for(size_t i = 0; i < ThroughputTasks; i++) {
+			pool.add([&done, payload = std::array<size_t, 4>{i, i, i, i}]() {
+				bench_keep(payload);
+				done.fetch_add(1, std::memory_order_relaxed);
+			});
+		}
+		while(done.load() < ThroughputTasks) std::this_thread::yield();
+		result.tasksPerSecond = ThroughputTasks / timer.seconds();
+	}
+
+	// Latency: bursts of tasks, measure time between add() and start of execution
+	{
+		std::vector<double> latencies(LatencyTasks);
+		BenchTimer origin;
+		for(size_t burst = 0; burst < LatencyTasks; burst += LatencyBurst) {
+			std::atomic<size_t> done = 0;
+			size_t count = std::min(LatencyBurst, LatencyTasks - burst);
+			for(size_t i = 0; i < count; i++) {
+				double submitted = origin.micros();
+				pool.add([&, submitted, idx = burst + i]() {
+					latencies[idx] = origin.micros() - submitted;
+					done.fetch_add(1, std::memory_order_release);
+				});
+			}
+			while(done.load(std::memory_order_acquire) < count) std::this_thread::yield();
+		}
+		result.p50  = bench_percentile(latencies, .5);
+		result.p99  = bench_percentile(latencies, .99);
+		result.p999 = bench_percentile(latencies, .999);
+	}
+
+	return result;
+}
+
+void print(const char* name, size_t threads, Result const& r) {
+	printf("%-8s %3zu threads: %10.0f tasks/s   latency p50 %8.1fus  p99 %8.1fus  p99.9 %8.1fus\n",
+		name, threads, r.tasksPerSecond, r.p50, r.p99, r.p999);
+}
+
+} // namespace
+
+void benchThreadpool() {
+	bench_header("Threadpool: legacy vs. work-stealing");
+	for(size_t threads : { 1, 2, 4, 8, 16, 32, 64 }) {
+		print("legacy",   threads, run<LegacyThreadpool>(threads));
+		print("stealing", threads, run<Threadpool>(threads));
+	}
+
+	bench_header("Threadpool: fork-join (TaskGroup, nested)");
+	for(size_t threads : { 1, 2, 4, 8, 16, 32, 64 }) {
+		Threadpool pool(threads);
+		std::atomic<size_t> count = 0;
+		BenchTimer timer;
+		{
+			TaskGroup outer(pool);
+			for(size_t i = 0; i < 256; i++) {
+				outer.run([&]() {
+					parallel_for(pool, 0, 1024, [&](size_t) {
+						count.fetch_add(1, std::memory_order_relaxed);
+					}, 32);
+				});
+			}
+		}
+		printf("stealing %3zu threads: %10.0f items/s\n", threads, count.load() / timer.seconds());
+	}
+}
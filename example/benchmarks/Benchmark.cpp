@@ -0,0 +1,55 @@
+#include "Benchmark.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+static int          gArgc;
+static char const** gArgv;
+
+bool bench_enabled(const char* name) {
+	if(gArgc <= 1) return true;
+	for(int i = 1; i < gArgc; i++) {
+		if(strcmp(gArgv[i], name) == 0) return true;
+	}
+	return false;
+}
+
+void bench_header(const char* title) {
+	printf("\n== %s ==\n", title);
+}
+
+double bench_percentile(std::vector<double>& samples, double p) {
+	if(samples.empty()) return 0;
+	std::sort(samples.begin(), samples.end());
+	size_t idx = std::min(samples.size() - 1, (size_t)(p * (samples.size() - 1) + .5));
+	return samples[idx];
+}
+
+void benchThreadpool();
+void benchAtlas();
+void benchFont();
+void benchSoftware();
+void benchBatch();
+void benchScroll();
+void benchIdle();
+void benchForm();
+void benchAttributes();
+void benchParsing();
+
+int main(int argc, char const** argv) {
+	gArgc = argc;
+	gArgv = argv;
+
+	if(bench_enabled("threadpool")) benchThreadpool();
+	if(bench_enabled("atlas"))      benchAtlas();
+	if(bench_enabled("font"))       benchFont();
+	if(bench_enabled("software"))   benchSoftware();
+	if(bench_enabled("batch"))      benchBatch();
+	if(bench_enabled("scroll"))     benchScroll();
+	if(bench_enabled("idle"))       benchIdle();
+	if(bench_enabled("form"))       benchForm();
+	if(bench_enabled("attributes")) benchAttributes();
+	if(bench_enabled("parsing"))    benchParsing();
+	return 0;
+}
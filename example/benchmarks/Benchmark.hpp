@@ -0,0 +1,28 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+/// Returns whether the benchmark should run (Names can be selected via the command line)
+bool bench_enabled(const char* name);
+/// Prints a section header
+void bench_header(const char* title);
+/// Returns the p-th percentile (0..1) of the samples, sorts them in the process
+double bench_percentile(std::vector<double>& samples, double p);
+
+/// Measures wall-clock time since construction or the last reset()
+struct BenchTimer {
+	using clock = std::chrono::steady_clock;
+
+	clock::time_point start = clock::now();
+
+	void   reset() noexcept { start = clock::now(); }
+	double seconds() const noexcept { return std::chrono::duration<double>(clock::now() - start).count(); }
+	double micros() const noexcept { return seconds() * 1e6; }
+};
+
+/// Prevents the compiler from optimizing away a value
+template<class T> inline
+void bench_keep(T const& value) {
+	asm volatile("" : : "g"(&value) : "memory");
+}
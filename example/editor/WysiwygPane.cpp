@@ -43,7 +43,9 @@ WysiwygPane::WysiwygPane() :
 	mForm(nullptr),
 	mSelected(nullptr),
 	mMarker(make_shared<WysiwygMarker>())
-{}
+{
+	handles(handles() | Dragged::handlerBit);
+}
 WysiwygPane::~WysiwygPane() {}
 
 void WysiwygPane::select(shared<Widget> w) {
@@ -64,8 +66,15 @@ void WysiwygPane::select(shared<Widget> w) {
 
 void WysiwygPane::load(std::string const& path) {
 	unload();
-	mForm = add<WysiwygForm>(path);
+	mForm = add<WysiwygForm>();
 	mForm->align(AlignCenter);
+	// Changes to the file are applied to the form, without losing its state
+	mForm->onReloaded = [this]() {
+		select(nullptr); // Might have been removed
+		if(onLoaded)
+			onLoaded(mForm);
+	};
+	mForm->watch().load(path);
 	if(onLoaded)
 		onLoaded(mForm);
 }
@@ -0,0 +1,43 @@
+#include <wwidget/widget/Form.hpp>
+#include <wwidget/Error.hpp>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+using namespace wwidget;
+
+// Compiles xml forms for Form::loadCompiled: formc <input.form.xml> <output.form.bin>
+int main(int argc, char const* argv[]) {
+	if(argc != 3) {
+		fprintf(stderr, "Usage: %s <input.form.xml> <output.form.bin>\n", argv[0]);
+		return 1;
+	}
+
+	std::ifstream in(argv[1], std::ios::binary);
+	if(!in) {
+		fprintf(stderr, "Failed opening %s\n", argv[1]);
+		return 1;
+	}
+	std::string xml { std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+
+	std::string compiled;
+	try {
+		auto form = make_shared<Form>();
+		compiled = form->addDefaultFactories().compile(xml.c_str());
+	}
+	catch(exceptions::ParsingError& e) {
+		e.setFile(argv[1]);
+		fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+
+	std::ofstream out(argv[2], std::ios::binary);
+	out.write(compiled.data(), compiled.size());
+	if(!out) {
+		fprintf(stderr, "Failed writing %s\n", argv[2]);
+		return 1;
+	}
+	return 0;
+}
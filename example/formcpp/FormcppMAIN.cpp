@@ -0,0 +1,53 @@
+#include <wwidget/widget/Form.hpp>
+#include <wwidget/Error.hpp>
+
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+using namespace wwidget;
+
+/// "path/to/Settings.form.xml" -> "form_Settings"
+static std::string functionFor(std::string path) {
+	path = path.substr(path.find_last_of("/\\") + 1);
+	path = path.substr(0, path.find('.'));
+	std::string result = "form_";
+	for(char c : path) result += isalnum((unsigned char) c) ? c : '_';
+	return result;
+}
+
+// Generates C++ from xml forms, see Form::generateCpp: formcpp <input.form.xml> <output.cpp> [function]
+int main(int argc, char const* argv[]) {
+	if(argc != 3 && argc != 4) {
+		fprintf(stderr, "Usage: %s <input.form.xml> <output.cpp> [function, default: form_<input name>]\n", argv[0]);
+		return 1;
+	}
+
+	std::ifstream in(argv[1], std::ios::binary);
+	if(!in) {
+		fprintf(stderr, "Failed opening %s\n", argv[1]);
+		return 1;
+	}
+	std::string xml { std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+
+	std::string code;
+	try {
+		auto form = make_shared<Form>();
+		code = form->addDefaultFactories().generateCpp(xml.c_str(), argc == 4 ? argv[3] : functionFor(argv[1]));
+	}
+	catch(exceptions::ParsingError& e) {
+		e.setFile(argv[1]);
+		fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+
+	std::ofstream out(argv[2], std::ios::binary);
+	out.write(code.data(), code.size());
+	if(!out) {
+		fprintf(stderr, "Failed writing %s\n", argv[2]);
+		return 1;
+	}
+	return 0;
+}
@@ -20,11 +20,29 @@ bool _test_result(bool success, const char* content, const char* file, int line)
 
 void testParsing();
 void testWidgetTreeOps();
+void testAsync();
+void testTextureAtlas();
+void testText();
+void testCanvasSoftware();
+void testCanvasRecorder();
+void testLayerCache();
+void testInput();
+void testForm();
+void testAttributes();
 void printSizes();
 
 int main(int argc, char const** argv) {
 	printSizes();
 	testWidgetTreeOps();
+	testAsync();
+	testTextureAtlas();
+	testText();
+	testCanvasSoftware();
+	testCanvasRecorder();
+	testLayerCache();
+	testInput();
+	testForm();
+	testAttributes();
 	// testParsing();
 	return 0;
 }
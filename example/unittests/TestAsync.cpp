@@ -0,0 +1,175 @@
+#include <wwidget/async/Threadpool.hpp>
+#include <wwidget/async/Queue.hpp>
+#include <wwidget/BasicContext.hpp>
+
+#include "Test.hpp"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace wwidget;
+
+void testAsync() {
+	// Task: inline, heap and move-only callables
+	{
+		int calls = 0;
+		Task small([&]() { ++calls; });
+		small();
+		expect_eq(calls, 1);
+
+		char big[Task::BufferSize * 2] = {};
+		Task large([&calls, big]() { calls += 1 + big[0]; });
+		Task moved = std::move(large);
+		expect(!large);
+		moved();
+		expect_eq(calls, 2);
+
+		auto ptr = std::make_unique<int>(40);
+		Task moveOnly([p = std::move(ptr), &calls]() { calls += *p; });
+		moveOnly();
+		expect_eq(calls, 42);
+	}
+
+	// Threadpool: all tasks run exactly once
+	for(size_t threads : { 1, 2, 8 }) {
+		Threadpool pool(threads);
+		std::atomic<int> count = 0;
+		{
+			TaskGroup group(pool);
+			for(int i = 0; i < 10000; i++) {
+				group.run([&]() { ++count; });
+			}
+		}
+		expect_eq(count.load(), 10000);
+	}
+
+	// Tasks spawning tasks, parallel_for
+	{
+		Threadpool pool(4);
+		std::atomic<int> count = 0;
+		{
+			TaskGroup outer(pool);
+			for(int i = 0; i < 64; i++) {
+				outer.run([&]() {
+					TaskGroup inner(pool);
+					for(int j = 0; j < 64; j++)
+						inner.run([&]() { ++count; });
+				});
+			}
+		}
+		expect_eq(count.load(), 64 * 64);
+
+		std::vector<int> values(1000, 0);
+		parallel_for(pool, 0, values.size(), [&](size_t i) { values[i] = (int) i; }, 16);
+		bool allSet = true;
+		for(size_t i = 0; i < values.size(); i++) allSet = allSet && values[i] == (int) i;
+		expect(allSet);
+	}
+
+	// join() waits for tasks which are still running on other threads
+	{
+		Threadpool pool(2);
+		std::atomic<bool> started = false, finished = false;
+		TaskGroup group(pool);
+		group.run([&]() {
+			started = true;
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			finished = true;
+		});
+		while(!started) std::this_thread::yield();
+		group.join();
+		expect(finished.load());
+		expect(group.done());
+	}
+
+	// Tasks added before start() are executed after it
+	{
+		Threadpool pool;
+		std::atomic<int> count = 0;
+		pool.add([&]() { ++count; });
+		expect(pool.runOne());
+		expect_eq(count.load(), 1);
+		pool.add([&]() { ++count; });
+		pool.start(2);
+		pool.stop();
+		expect_eq(count.load(), 2);
+	}
+
+	// TaskQueue: per-producer order is kept, even when the ring overflows
+	{
+		TaskQueue queue(8);
+		std::atomic<int> wakeups = 0;
+		queue.wakeup([&]() { ++wakeups; });
+
+		constexpr int Producers = 4, PerProducer = 2000;
+		std::vector<int> last(Producers, -1);
+		bool ordered = true;
+		int  executed = 0;
+
+		std::vector<std::thread> producers;
+		for(int p = 0; p < Producers; p++) {
+			producers.emplace_back([&, p]() {
+				for(int i = 0; i < PerProducer; i++) {
+					queue.add([&, p, i]() {
+						ordered = ordered && last[p] == i - 1;
+						last[p] = i;
+					});
+				}
+			});
+		}
+		while(executed < Producers * PerProducer) {
+			executed += (int) queue.executeSingleConsumer();
+		}
+		for(auto& t : producers) t.join();
+
+		expect(ordered);
+		expect_eq(executed, Producers * PerProducer);
+		expect(queue.empty());
+		expect(wakeups.load() >= 1);
+
+		int before = wakeups.load();
+		queue.add([]() {});
+		expect_eq(wakeups.load(), before + 1);
+		queue.add([]() {});
+		expect_eq(wakeups.load(), before + 1); // Only signaled once until it is drained
+		expect_eq(queue.executeSingleConsumer(), 2u);
+	}
+
+	// BasicContext: budgeted updates carry background work over, input is never postponed
+	{
+		BasicContext context;
+		context.taskBudget(std::chrono::microseconds(500));
+
+		std::vector<TaskPriority> order;
+		int background = 0;
+		for(int i = 0; i < 5000; i++) {
+			context.defer(TaskPriority::Background, [&]() {
+				auto until = TaskQueue::Clock::now() + std::chrono::microseconds(2);
+				while(TaskQueue::Clock::now() < until);
+				if(background++ == 0) order.push_back(TaskPriority::Background);
+			});
+		}
+		context.defer([&]() { order.push_back(TaskPriority::Layout); });
+		context.defer(TaskPriority::Input, [&]() { order.push_back(TaskPriority::Input); });
+
+		context.update();
+		auto& stats = context.taskStats();
+		expect_eq(stats.executed[(size_t) TaskPriority::Input], 1u);
+		expect_eq(stats.executed[(size_t) TaskPriority::Layout], 1u);
+		expect(stats.carriedOver[(size_t) TaskPriority::Background] > 0);
+		expect_eq(stats.executed[(size_t) TaskPriority::Background] + stats.carriedOver[(size_t) TaskPriority::Background], 5000u);
+		expect(order.size() == 3 && order[0] == TaskPriority::Input && order[1] == TaskPriority::Layout);
+
+		int frames = 1;
+		while(context.taskStats().carriedOver[(size_t) TaskPriority::Background] > 0 && frames < 10000) {
+			context.defer(TaskPriority::Input, [&]() { order.push_back(TaskPriority::Input); });
+			context.update();
+			expect_eq(context.taskStats().executed[(size_t) TaskPriority::Input], 1u);
+			++frames;
+		}
+		expect_eq(background, 5000);
+		expect(frames > 1);
+	}
+}
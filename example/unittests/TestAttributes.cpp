@@ -0,0 +1,122 @@
+#include <wwidget/widget/Button.hpp>
+#include <wwidget/widget/Form.hpp>
+#include <wwidget/widget/Image.hpp>
+#include <wwidget/widget/Knob.hpp>
+#include <wwidget/widget/ProgressBar.hpp>
+#include <wwidget/widget/TextField.hpp>
+#include <wwidget/widget/TextView.hpp>
+
+#include "Test.hpp"
+
+#include <stdexcept>
+#include <string>
+
+using namespace wwidget;
+
+void testAttributes() {
+	// Attributes are found in the class and its base classes
+	{
+		auto& table = Text::classAttributes();
+		expect_eq(table.className(), "wwidget::Text");
+		expect(table.base() == &Widget::classAttributes());
+
+		AttributeInfo const* fontSize = table.find("fontSize");
+		expect(fontSize && fontSize->type() == AttributeType::Float);
+		expect(table.find("width") == Widget::classAttributes().find("width"));
+		expect(!table.find("flow"));
+		expect(!Widget::classAttributes().find("fontSize"));
+
+		test_hint("Classes replace the attributes of their base classes");
+		AttributeInfo const* content = TextField::classAttributes().find("content");
+		expect(content && content != table.find("content"));
+	}
+
+	// Resolved attributes are set and read with typed values
+	{
+		auto text = make_shared<Text>();
+		AttributeInfo const* fontSize = text->attributeTable().find("fontSize");
+		expect(fontSize->set(*text, 20.f));
+		expect_eq(text->fontSize(), 20.f);
+		expect(!fontSize->set(*text, true));
+		expect(!fontSize->set(*text, "21"));
+		expect_eq(text->fontSize(), 20.f);
+
+		float f = 0;
+		expect(fontSize->readable() && fontSize->get(*text, f));
+		expect_eq(f, 20.f);
+
+		AttributeInfo const* content = text->attributeTable().find("content");
+		expect(content->set(*text, "Hello"));
+		std::string s;
+		expect(content->get(*text, s));
+		expect_eq(s, "Hello");
+
+		AttributeInfo const* klass = text->attributeTable().find("class");
+		expect(!klass->readable() && !klass->get(*text, s));
+
+		fontSize->set(*text, StringAttribute(std::string("12")));
+		expect_eq(text->fontSize(), 12.f);
+	}
+
+	// setAttribute() uses the table of the widget's class
+	{
+		auto knob = make_shared<Knob>();
+		expect(&knob->attributeTable() == &Slider::classAttributes());
+		expect(knob->setAttribute("exponent", StringAttribute(std::string("2"))));
+		expect_eq(knob->exponent(), 2.0);
+		expect(knob->setAttribute("name", StringAttribute(std::string("k"))));
+		expect_eq(std::string(knob->name()), "k");
+		expect(!knob->setAttribute("fontSize", StringAttribute(std::string("2"))));
+	}
+
+	// The default widgets describe their setters as code, for Form::generateCpp()
+	{
+		AttributeTable const* tables[] = {
+			&Widget::classAttributes(), &Form::classAttributes(), &Button::classAttributes(), &Image::classAttributes(),
+			&List::classAttributes(), &ProgressBar::classAttributes(), &Slider::classAttributes(), &Text::classAttributes(),
+			&TextField::classAttributes(), &TextView::classAttributes(),
+		};
+		for(auto* table : tables) {
+			for(auto& attribute : *table) {
+				test_hint(attribute.name().data()); // names are literals
+				expect(attribute.code() && std::string(attribute.code()).find('%') != std::string::npos);
+			}
+		}
+	}
+
+	// Values are parsed without depending on the locale
+	{
+		expect_eq(StringAttribute("1.5").toFloat(), 1.5f);
+		expect_eq(StringAttribute(" +2e1").toFloat(), 20.f);
+		expect_eq(StringAttribute("-3").toInt(), -3);
+		expect_exception(std::invalid_argument, []() { StringAttribute("px").toFloat(); });
+		expect_exception(std::out_of_range, []() { StringAttribute("99999999999999999999").toInt(); });
+
+		expect(StringAttribute("1 2").toPoint() == Point(1, 2));
+		expect(StringAttribute("1 2 ").toPadding() == Padding(1, 2));
+		expect(StringAttribute("  4").toPadding() == Padding(4));
+		expect_exception(std::runtime_error, []() { StringAttribute("1 2 3").toPadding(); });
+
+		std::string_view rest;
+		expect(from_string<Point>("3 4 five", &rest) == Point(3, 4));
+		expect_eq(rest, " five");
+	}
+
+	// Colors can be hexadecimal or named
+	{
+		auto color = [](const char* s) { return (uint32_t) StringAttribute(s).toColor(); };
+		expect_eq(color("#ff8000"),   0xFFFF8000u);
+		expect_eq(color("#FF800080"), 0x80FF8000u);
+		expect_eq(color("#f80"),      0xFFFF8800u);
+		expect_eq(color("red"),       0xFFFF0000u);
+		expect_eq(color("transparent"), 0x00000000u);
+		expect_eq(color("0 0 1"),     0xFF0000FFu);
+		expect_exception(std::runtime_error, []() { StringAttribute("#12345").toColor(); });
+		expect_exception(std::runtime_error, []() { StringAttribute("blurple").toColor(); });
+
+		test_hint("Colors are written in a format they are read from");
+		Color c(.5f, .25f, 1, .5f);
+		Color read = StringAttribute(to_string(c)).toColor();
+		expect(read.r == c.r && read.g == c.g && read.b == c.b && read.a == c.a);
+	}
+}
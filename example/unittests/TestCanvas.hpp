@@ -0,0 +1,75 @@
+#pragma once
+
+#include <wwidget/Canvas.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+/// A canvas which draws nothing and measures text as if every character was 8x16 pixels
+class TestCanvas : public wwidget::Canvas {
+public:
+	using Canvas = wwidget::Canvas;
+	using Rect   = wwidget::Rect;
+	using Point  = wwidget::Point;
+	using Color  = wwidget::Color;
+
+	size_t measurements = 0; //!< textBounds and textBoxBounds calls
+	size_t textDraws    = 0; //!< text and textBox calls
+
+	Canvas& beginFrame(wwidget::Size const&, float) override { return *this; }
+	Canvas& endFrame() override { return *this; }
+	Canvas& cancelFrame() override { return *this; }
+
+	Canvas& pushState() override { return *this; }
+	Canvas& popState() override { return *this; }
+	Canvas& resetState() override { return *this; }
+
+	Canvas& scissor(Rect const&) override { return *this; }
+	Canvas& scissorIntersect(Rect const&) override { return *this; }
+	Canvas& resetScissor() override { return *this; }
+
+	Canvas& resetTransform() override { return *this; }
+	Canvas& translate(float, float) override { return *this; }
+	Canvas& scale(float, float) override { return *this; }
+
+	Canvas& lineWidth(float) override { return *this; }
+	Canvas& fillColor(Color const&) override { return *this; }
+	Canvas& fillTexture(Rect const&, wwidget::shared<wwidget::Bitmap> const&, Color const&) override { return *this; }
+	Canvas& strokeColor(Color const&) override { return *this; }
+	Canvas& strokeTexture(Rect const&, wwidget::shared<wwidget::Bitmap> const&, Color const&) override { return *this; }
+
+	Canvas& rect(Rect const&) override { return *this; }
+	Canvas& rect(Rect const&, float) override { return *this; }
+	Canvas& circle(Point const&, float) override { return *this; }
+	Canvas& elipse(Point const&, float, float) override { return *this; }
+	Canvas& arc(Point const&, float, float, float, bool) override { return *this; }
+
+	Canvas& moveTo(Point const&) override { return *this; }
+	Canvas& lineTo(Point const&) override { return *this; }
+
+	Canvas& registerFont(const char*, const char*) override { return *this; }
+	Canvas& font(const char*) override { return *this; }
+	Canvas& fontSize(float) override { return *this; }
+	Canvas& fontBlur(float) override { return *this; }
+	Canvas& fontLetterSpacing(float) override { return *this; }
+	Canvas& fontLineHeight(float) override { return *this; }
+
+	Canvas& text(Point const&, std::string_view) override { ++textDraws; return *this; }
+	Canvas& textBox(Point const&, float, std::string_view) override { ++textDraws; return *this; }
+
+	Rect textBounds(Point const& p, std::string_view txt) override {
+		++measurements;
+		return Rect(p.x, p.y, 8.f * txt.size(), 16);
+	}
+	Rect textBoxBounds(Point const& p, float maxWidth, std::string_view txt) override {
+		++measurements;
+		float lines = std::max(1.f, std::ceil(8.f * txt.size() / maxWidth));
+		return Rect(p.x, p.y, std::min(maxWidth, 8.f * txt.size()), 16 * lines);
+	}
+	wwidget::FontMetrics fontMetrics() override { return { 12, -4, 16 }; }
+
+	Canvas& fill() override { return *this; }
+	Canvas& fillPreserve() override { return *this; }
+	Canvas& stroke() override { return *this; }
+	Canvas& strokePreserve() override { return *this; }
+};
@@ -0,0 +1,221 @@
+#include <wwidget/CanvasRecorder.hpp>
+#include <wwidget/BasicContext.hpp>
+#include <wwidget/Bitmap.hpp>
+#include <wwidget/widget/List.hpp>
+#include <wwidget/widget/Text.hpp>
+
+#include "Test.hpp"
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+using namespace wwidget;
+
+void testCanvasRecorder() {
+	// Every call is one line of the log
+	{
+		CanvasRecorder canvas;
+		canvas.beginFrame({64, 32}, 96);
+		canvas.pushState();
+		canvas.scissorIntersect({0, 0, 32, 32});
+		canvas.translate(.5f, -1);
+		canvas.fillColor(rgb(255, 0, 0)).rect({1, 2, 3, 4}).fill();
+		canvas.strokeColor(rgba(0, 0, 255, .5f)).circle({8, 8}, 4).stroke();
+		canvas.text({0, 20}, "say \"hi\"");
+		canvas.popState();
+		canvas.endFrame();
+
+		expect_eq(canvas.log(),
+			"beginFrame 64 32\n"
+			"pushState\n"
+			"scissorIntersect 0 0 32 32\n"
+			"translate 0.5 -1\n"
+			"fillColor #ff0000ff\n"
+			"rect 1 2 3 4\n"
+			"fill\n"
+			"strokeColor #0000ff80\n"
+			"circle 8 8 4\n"
+			"stroke\n"
+			"text 0 20 \"say \\\"hi\\\"\"\n"
+			"popState\n"
+			"endFrame\n"
+		);
+
+		auto& stats = canvas.frameStats();
+		expect_eq(stats.commands, 13u);
+		expect_eq(stats.statePushes, 1u);
+		expect_eq(stats.scissors, 1u);
+		expect_eq(stats.fills, 1u);
+		expect_eq(stats.strokes, 1u);
+		expect_eq(stats.textRuns, 1u);
+		expect_eq(stats.textureBinds, 0u);
+		expect_eq(canvas.frames(), 1u);
+	}
+
+	// Texture binds are only counted when the texture changes, counting works without the log
+	{
+		auto a = make_shared<Bitmap>();
+		auto b = make_shared<Bitmap>();
+		a->init(4, 4, Bitmap::RGBA);
+		b->init(8, 2, Bitmap::RGBA);
+
+		CanvasRecorder canvas;
+		canvas.beginFrame({64, 32}, 96);
+		canvas.fillTexture({0, 0, 4, 4}, a).rect({0, 0, 4, 4}).fill();
+		canvas.fillTexture({4, 0, 4, 4}, a).rect({4, 0, 4, 4}).fill();
+		canvas.fillTexture({0, 0, 8, 2}, b).rect({0, 0, 8, 2}).fill();
+		canvas.fillColor(Color::white()).rect({0, 0, 1, 1}).fill();
+		canvas.fillTexture({0, 0, 4, 4}, a).rect({0, 0, 4, 4}).fill();
+		canvas.endFrame();
+		expect_eq(canvas.frameStats().textureBinds, 3u);
+		expect(canvas.log().find("fillTexture 0 0 8 2 texture2(8x2) #ffffffff\n") != std::string::npos);
+
+		canvas.recordLog(false);
+		canvas.beginFrame({64, 32}, 96);
+		canvas.fillTexture({0, 0, 4, 4}, b).rect({0, 0, 4, 4}).fill();
+		canvas.endFrame();
+		expect(canvas.log().empty());
+		expect_eq(canvas.frameStats().commands, 5u); // Including beginFrame and endFrame
+		expect_eq(canvas.frameStats().textureBinds, 1u);
+	}
+
+	// Batches are one command, with one line per primitive
+	{
+		CanvasRecorder canvas;
+		Rect                   areas[] = { {0, 0, 2, 2}, {4, 0, 2, 2} };
+		Color                  colors[] = { Color::black(), Color::white() };
+		Point                  points[] = { {0, 0}, {1, 2} };
+		Canvas::GlyphRun       runs[] = { { {0, 10}, "a" }, { {0, 20}, "b" } };
+
+		canvas.beginFrame({64, 32}, 96);
+		canvas.rects(areas, colors, 2);
+		canvas.polyline(points, 2);
+		canvas.glyphRuns(runs, 2);
+		canvas.endFrame();
+
+		expect_eq(canvas.log(),
+			"beginFrame 64 32\n"
+			"rects 2\n"
+			"  0 0 2 2 #000000ff\n"
+			"  4 0 2 2 #ffffffff\n"
+			"polyline 2\n"
+			"  0 0\n"
+			"  1 2\n"
+			"glyphRuns 2\n"
+			"  0 10 \"a\"\n"
+			"  0 20 \"b\"\n"
+			"endFrame\n"
+		);
+		expect_eq(canvas.frameStats().commands, 5u);
+		expect_eq(canvas.frameStats().fills, 1u);
+		expect_eq(canvas.frameStats().strokes, 1u);
+		expect_eq(canvas.frameStats().textRuns, 1u);
+	}
+
+	// Headless: scrolling a long list only draws what's visible
+	{
+		BasicContext context;
+		auto canvas = context.headless({200, 100});
+		expect(context.headless());
+
+		auto list = context.rootWidget()->add<List>();
+		list->scrollable(true);
+		for(int i = 0; i < 1000; i++)
+			list->add<Text>("Item " + std::to_string(i));
+
+		context.update();
+		context.draw();
+		expect_eq(list->width(), 200);
+		expect_eq(list->height(), 100);
+		auto const first = canvas->frameStats();
+		expect(first.textRuns > 0 && first.textRuns <= 8);
+
+		for(int i = 1; i <= 20; i++) {
+			list->scrollOffset(i * 37.f);
+			context.update();
+			context.draw();
+			auto& stats = canvas->frameStats();
+			test_hint("Scrolling must not draw invisible items");
+			expect(stats.textRuns <= first.textRuns + 1);
+			expect(stats.fills <= 2);
+		}
+		expect(canvas->log().find("\"Item 0\"") == std::string::npos);
+		expect_eq(canvas->frames(), 21u);
+	}
+
+	// Render on demand: frames are only drawn when something changed
+	{
+		using Clock = BasicContext::Clock;
+
+		BasicContext context;
+		auto canvas = context.headless({200, 100});
+		context.renderOnDemand(true);
+		auto text = context.rootWidget()->add<Text>("Hello");
+
+		context.update();
+		context.draw();
+		expect_eq(canvas->frames(), 1u);
+		for(int i = 0; i < 10; i++) {
+			context.update();
+			context.draw();
+		}
+		test_hint("Nothing changed, nothing may be drawn");
+		expect_eq(canvas->frames(), 1u);
+		expect(!context.needsDraw());
+
+		text->content("World");
+		expect(context.needsDraw());
+		context.update();
+		context.draw();
+		expect_eq(canvas->frames(), 2u);
+
+		context.defer([]() {}); // Tasks might change anything
+		context.update();
+		context.draw();
+		expect_eq(canvas->frames(), 3u);
+
+		context.headless({300, 100});
+		context.update();
+		context.draw();
+		expect_eq(canvas->frames(), 4u);
+
+		// Sleeps until a requested frame is due
+		auto due = Clock::now() + std::chrono::milliseconds(20);
+		context.requestFrame(due);
+		context.update();
+		context.draw();
+		expect_eq(canvas->frames(), 4u);
+		while(!context.needsDraw()) context.waitEvents();
+		expect(Clock::now() >= due);
+		context.update();
+		context.draw();
+		expect_eq(canvas->frames(), 5u);
+		expect(context.frameDeadline() == Clock::time_point::max());
+
+		// Work deferred from other threads wakes it up
+		std::atomic<bool> ran { false };
+		auto timeout = Clock::now() + std::chrono::seconds(5);
+		context.requestFrame(timeout); // Don't hang if waking up is broken
+		std::thread worker([&]() {
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			context.defer(TaskPriority::Background, [&]() { ran = true; });
+		});
+		while(!ran && Clock::now() < timeout) {
+			context.waitEvents();
+			context.update();
+		}
+		worker.join();
+		expect(ran.load());
+		expect(Clock::now() < timeout);
+		context.draw();
+		expect_eq(canvas->frames(), 6u);
+
+		// Doesn't sleep while something is waiting to be drawn
+		context.redraw();
+		context.requestFrame(Clock::now() + std::chrono::seconds(5)); // Don't hang if it sleeps anyway
+		auto before = Clock::now();
+		context.waitEvents();
+		expect(Clock::now() - before < std::chrono::seconds(1));
+	}
+}
@@ -0,0 +1,141 @@
+#include <wwidget/CanvasSoftware.hpp>
+#include <wwidget/Bitmap.hpp>
+
+#include "Test.hpp"
+
+#include <cstring>
+#include <vector>
+
+using namespace wwidget;
+
+namespace {
+
+uint8_t const* pixel(CanvasSoftware const& c, unsigned x, unsigned y) {
+	return c.bitmap().data() + (y * c.bitmap().width() + x) * 4;
+}
+bool near(int a, int b, int tolerance = 2) { return a - b <= tolerance && b - a <= tolerance; }
+
+} // namespace
+
+void testCanvasSoftware() {
+	CanvasSoftware canvas;
+
+	// Pixel aligned fills cover whole pixels, half pixels are half covered
+	{
+		canvas.beginFrame({16, 16}, 96);
+		canvas.fillColor(rgb(255, 0, 0)).rect({2, 2, 4, 4}).fill();
+		canvas.fillColor(rgb(0, 0, 255)).rect({8.5f, 2, 2, 2}).fill();
+		canvas.endFrame();
+
+		expect(pixel(canvas, 2, 2)[0] == 255 && pixel(canvas, 2, 2)[3] == 255);
+		expect(pixel(canvas, 5, 5)[0] == 255);
+		expect_eq(pixel(canvas, 6, 5)[3], 0);
+		expect_eq(pixel(canvas, 1, 2)[3], 0);
+
+		expect(near(pixel(canvas, 8, 2)[2], 128) && near(pixel(canvas, 8, 2)[3], 128));
+		expect(pixel(canvas, 9, 3)[2] == 255);
+		expect(near(pixel(canvas, 10, 3)[3], 128));
+
+		expect_eq(canvas.counters().primitives, 2u);
+	}
+
+	// Blending with premultiplied alpha, scissor and transforms
+	{
+		canvas.beginFrame({16, 16}, 96);
+		canvas.fillColor(Color::white()).rect({0, 0, 16, 16}).fill();
+		canvas.fillColor(Color(0, 0, 0, .5f)).rect({0, 0, 16, 16}).fill();
+		expect(near(pixel(canvas, 3, 3)[0], 128) && pixel(canvas, 3, 3)[3] == 255);
+
+		canvas.pushState();
+		canvas.translate(4, 4).scale(2, 2);
+		canvas.scissor({0, 0, 2, 2}); // Pixels 4 to 8
+		canvas.fillColor(Color::black()).rect({-10, -10, 100, 100}).fill();
+		canvas.popState();
+		canvas.endFrame();
+
+		expect_eq(pixel(canvas, 4, 4)[0], 0);
+		expect_eq(pixel(canvas, 7, 7)[0], 0);
+		expect(near(pixel(canvas, 8, 8)[0], 128));
+		expect(near(pixel(canvas, 3, 3)[0], 128));
+	}
+
+	// Circles are symmetric and anti-aliased
+	{
+		canvas.beginFrame({32, 32}, 96);
+		canvas.fillColor(Color::white()).circle({16, 16}, 10).fill();
+		canvas.endFrame();
+
+		expect_eq(pixel(canvas, 16, 16)[3], 255);
+		expect_eq(pixel(canvas, 2, 16)[3], 0);
+		expect(near(pixel(canvas, 6, 16)[3], pixel(canvas, 25, 16)[3]));
+		expect(near(pixel(canvas, 16, 6)[3], pixel(canvas, 16, 25)[3]));
+		int edge = pixel(canvas, 16 + 7, 16 + 7)[3]; // 9.9 from the center
+		expect(edge > 0 && edge < 255);
+	}
+
+	// Strokes: joints don't leave holes or cancel out
+	{
+		canvas.beginFrame({32, 32}, 96);
+		canvas.strokeColor(Color::white()).lineWidth(4);
+		canvas.moveTo({4, 4}).lineTo({24, 4}).lineTo({24, 24}).stroke();
+		canvas.strokeColor(Color::white()).lineWidth(2).rect({10, 10, 8, 8}).stroke();
+		canvas.endFrame();
+
+		expect_eq(pixel(canvas, 14, 4)[3], 255);
+		expect_eq(pixel(canvas, 24, 14)[3], 255);
+		expect_eq(pixel(canvas, 24, 4)[3], 255); // The joint
+		expect_eq(pixel(canvas, 14, 7)[3], 0);
+		expect_eq(pixel(canvas, 10, 14)[3], 255);
+		expect_eq(pixel(canvas, 14, 14)[3], 0); // Inside the stroked rect
+	}
+
+	// Textures are mapped onto the target rect
+	{
+		auto bm = make_shared<Bitmap>();
+		bm->init(2, 1, Bitmap::RGBA);
+		uint8_t texels[] = { 255, 0, 0, 255,   0, 255, 0, 255 };
+		memcpy(bm->data(), texels, sizeof(texels));
+
+		canvas.beginFrame({16, 16}, 96);
+		canvas.fillTexture({0, 0, 16, 16}, bm).rect({0, 0, 16, 16}).fill();
+		canvas.endFrame();
+
+		expect(pixel(canvas, 1, 8)[0] == 255 && pixel(canvas, 1, 8)[1] == 0);
+		expect(pixel(canvas, 14, 8)[1] == 255 && pixel(canvas, 14, 8)[0] == 0);
+	}
+
+	// Batches draw the same as single calls
+	{
+		Rect  areas[]  = { {1, 1, 6, 3}, {2.5f, 2.25f, 4, 4.5f}, {9, 9, .5f, 20} };
+		Color colors[] = { rgb(255, 0, 0), rgba(0, 0, 255, .5f), Color::white() };
+
+		auto draw = [&](bool batched) {
+			canvas.beginFrame({16, 16}, 96);
+			canvas.translate(.5f, 0);
+			if(batched) canvas.rects(areas, colors, 3);
+			else for(int i = 0; i < 3; i++) canvas.fillColor(colors[i]).rect(areas[i]).fill();
+			canvas.endFrame();
+			return std::vector<uint8_t>(canvas.bitmap().data(), canvas.bitmap().data() + 16 * 16 * 4);
+		};
+		auto single = draw(false);
+		expect(draw(true) == single);
+
+		auto bm = make_shared<Bitmap>();
+		bm->init(4, 2, Bitmap::RGBA);
+		for(unsigned i = 0; i < 8; i++) {
+			uint8_t texel[] = { uint8_t(i * 30), uint8_t(255 - i * 30), 0, 255 };
+			memcpy(bm->data() + i * 4, texel, 4);
+		}
+		Canvas::TexturedQuad quads[] = { { {0, 0, 8, 8}, {0, 0, 2, 2} }, { {8, 4, 4, 4}, {2, 1, 2, 1} } };
+		canvas.beginFrame({16, 16}, 96);
+		canvas.Canvas::texturedQuads(bm, quads, 2); // The fallback, with fillTexture() and fill()
+		canvas.endFrame();
+		single.assign(canvas.bitmap().data(), canvas.bitmap().data() + 16 * 16 * 4);
+
+		canvas.beginFrame({16, 16}, 96);
+		canvas.texturedQuads(bm, quads, 2);
+		canvas.endFrame();
+		expect(std::equal(single.begin(), single.end(), canvas.bitmap().data()));
+		expect(pixel(canvas, 10, 6)[0] >= 180 && pixel(canvas, 10, 6)[0] <= 210); // Between texels 6 and 7
+	}
+}
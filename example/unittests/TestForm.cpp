@@ -0,0 +1,259 @@
+#include <wwidget/widget/Form.hpp>
+#include <wwidget/widget/Text.hpp>
+#include <wwidget/AttributeCollector.hpp>
+#include <wwidget/BasicContext.hpp>
+#include <wwidget/Error.hpp>
+
+#include "Test.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <typeinfo>
+
+using namespace wwidget;
+
+// Generated from Sample.form.xml by the FormCpp rule
+wwidget::Form& form_Sample(wwidget::Form& form);
+
+namespace {
+
+const char* const SamplePath = "example/unittests/Sample.form.xml";
+
+std::string read(const char* path) {
+	std::ifstream file(path, std::ios::binary);
+	return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+}
+
+void write(std::string const& path, std::string const& text) {
+	std::ofstream(path, std::ios::binary) << text;
+}
+
+/// Doesn't implement onClone()
+class Unclonable : public Widget {};
+
+/// The types and attributes of a widget tree, one widget per line
+std::string dump(Widget& w, int depth = 0) {
+	std::string result(depth, '\t');
+	result += typeid(w).name();
+	auto collector = MakeStringAttributeCollector([&](std::string_view name, std::string_view value, std::string_view) {
+		if(name == "ptr") return;
+		result += " ";
+		result += name;
+		result += "=";
+		result += value;
+	});
+	w.getAttributes(collector);
+	result += "\n";
+	for(auto child = w.children(); child; child = child->nextSibling())
+		result += dump(*child, depth + 1);
+	return result;
+}
+
+} // namespace
+
+void testForm() {
+	std::string sample = read(SamplePath);
+	expect(!sample.empty());
+	const char* Sample = sample.c_str();
+
+	// Compiled forms create the same trees as xml
+	{
+		auto xml = make_shared<Form>();
+		xml->addDefaultFactories().parse(Sample);
+
+		auto compiled = make_shared<Form>();
+		std::string binary = compiled->compile(Sample);
+		compiled->parseCompiled(binary.data(), binary.size());
+
+		expect_eq(dump(*compiled), dump(*xml));
+		expect(dump(*xml).find("Hello") != std::string::npos);
+		expect(dump(*xml).find("ProgressBar") != std::string::npos);
+		test_hint("Strings are pooled");
+		expect(binary.find("fill") == binary.rfind("fill"));
+	}
+
+	// Compiled forms which end inside an element are rejected
+	{
+		auto form = make_shared<Form>();
+		std::string binary = form->compile("<form><widget><widget/></widget></form>");
+		binary.pop_back(); // The End of the outer widget
+		uint32_t opBytes;
+		memcpy(&opBytes, binary.data() + 20, sizeof(opBytes)); // Header::opBytes, the size has to stay consistent
+		--opBytes;
+		memcpy(binary.data() + 20, &opBytes, sizeof(opBytes));
+		expect_exception(exceptions::ParsingError, [&]() { form->parseCompiled(binary.data(), binary.size()); });
+	}
+
+	// Generated code creates the same trees as xml
+	{
+		auto xml = make_shared<Form>();
+		xml->load(SamplePath);
+
+		auto generated = make_shared<Form>();
+		form_Sample(*generated);
+
+		expect_eq(dump(*generated), dump(*xml));
+		expect_eq(std::string(generated->name()), "root");
+	}
+
+	// Nested forms use the factories of their parent, changing them doesn't change the parent's
+	{
+		auto form = make_shared<Form>();
+		form->addDefaultFactories().factory<Widget>("thing");
+		form->parse("<form><form name=\"nested\"><thing name=\"a\"/></form></form>");
+		expect(form->find("a"));
+
+		auto nested = form->find<Form>("nested");
+		expect(nested);
+		nested->factory<Widget>("other").parse("<form><other name=\"b\"/></form>");
+		expect(nested->find("b"));
+		expect_exception(exceptions::ParsingError, [&]() { form->parse("<form><other/></form>"); });
+	}
+
+	// Clones are deep copies
+	{
+		auto form = make_shared<Form>();
+		form->addDefaultFactories().parse(Sample);
+		auto copy = form->clone();
+		expect(copy->children() && copy->children() != form->children());
+		expect_eq(dump(*copy), dump(*form));
+
+		auto unclonable = make_shared<Unclonable>();
+		expect_exception(exceptions::InvalidOperation, [&]() { unclonable->clone(); });
+	}
+
+	// Loading a file again clones its prototype, until the file changes
+	{
+		namespace fs = std::filesystem;
+		std::string path = (fs::temp_directory_path() / "wwidget-test-prototype.form.xml").string();
+		write(path, "<form name=\"a\"><text content=\"1\"/></form>");
+		auto modified = fs::last_write_time(path);
+
+		auto first = make_shared<Form>();
+		first->load(path);
+		expect_eq(std::string(first->name()), "a");
+
+		test_hint("Same modification time: the prototype is used, the file isn't read");
+		write(path, "<form name=\"b\"><text content=\"2\"/><text/></form>");
+		fs::last_write_time(path, modified);
+		auto second = make_shared<Form>();
+		second->load(path);
+		expect_eq(dump(*second), dump(*first));
+		expect(second->children() != first->children());
+
+		fs::last_write_time(path, modified + std::chrono::seconds(1));
+		auto third = make_shared<Form>();
+		third->load(path);
+		expect_eq(std::string(third->name()), "b");
+		expect_eq(third->children()->nextSibling()->nextSibling(), nullptr);
+		expect(third->children()->nextSibling());
+
+		test_hint("Widgets which can't be cloned are parsed every time");
+		write(path, "<form><unclonable name=\"u\"/></form>");
+		auto form = make_shared<Form>();
+		form->factory<Unclonable>("unclonable").addDefaultFactories();
+		form->load(path);
+		form->load(path);
+		expect(form->children() && form->children()->nextSibling());
+		expect(dynamic_cast<Unclonable*>(form->lastChild().get()));
+
+		Form::clearPrototypes();
+		fs::remove(path);
+	}
+
+	// Reloading changes the widgets which changed, the others keep their state
+	{
+		namespace fs = std::filesystem;
+		std::string path = (fs::temp_directory_path() / "wwidget-test-reload.form.xml").string();
+		write(path,
+			"<form>"
+				"<list name=\"l\"><text name=\"a\" content=\"1\" fontSize=\"20\"/><text name=\"b\"/></list>"
+				"<button name=\"c\" text=\"Go\"/>"
+			"</form>");
+
+		auto form = make_shared<Form>();
+		form->watch().load(path);
+		auto list = form->find("l");
+		auto a    = form->find<Text>("a");
+		auto c    = form->find("c");
+
+		write(path,
+			"<form>"
+				"<list name=\"l\"><text name=\"a\" content=\"2\" fontSize=\"20\"/><text name=\"d\"/></list>"
+				"<button name=\"c\" text=\"Go\"/>"
+			"</form>");
+		form->reload();
+		expect(form->find("l") == list && form->find("a") == a && form->find("c") == c);
+		expect_eq(a->content(), "2");
+		expect(!form->search("b"));
+		expect(a->nextSibling() == form->find("d"));
+
+		test_hint("Elements which lost an attribute are created again");
+		write(path,
+			"<form>"
+				"<list name=\"l\"><text name=\"a\" content=\"2\"/><text name=\"d\"/></list>"
+				"<button name=\"c\" text=\"Go\"/>"
+			"</form>");
+		form->reload();
+		expect(form->find("a") != a && form->find("l") == list);
+		expect(list->children() == form->find("a"));
+
+		test_hint("Widgets removed from the form are built again");
+		list->remove();
+		write(path,
+			"<form>"
+				"<list name=\"l\"><text name=\"a\" content=\"3\"/><text name=\"d\"/></list>"
+				"<button name=\"c\" text=\"Go\"/>"
+			"</form>");
+		list = nullptr;
+		form->reload();
+		list = form->find("l");
+		expect(list && list->parent() == form && list->nextSibling() == c);
+		expect_eq(form->find<Text>("a")->content(), "3");
+
+		test_hint("Broken files change nothing");
+		write(path, "<form><list name=\"l\"><text name=\"a\"");
+		expect_exception(exceptions::ParsingError, [&]() { form->reload(); });
+		write(path, "<form><unknown/></form>");
+		expect_exception(exceptions::ParsingError, [&]() { form->reload(); });
+		expect(form->find("l") == list && form->find("c") == c);
+
+		test_hint("Changed files are reloaded by the context of the form");
+		BasicContext context;
+		context.headless({200, 100});
+		context.rootWidget()->add(form);
+		bool reloaded = false;
+		form->onReloaded = [&]() { reloaded = true; };
+		write(path, "<form><list name=\"l\"/><button name=\"c\" text=\"Go\"/></form>");
+		for(int i = 0; i < 200 && !reloaded; i++) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+			context.update();
+		}
+		expect(reloaded);
+		expect(!form->search("d") && form->find("c") == c);
+
+		form->remove();
+		fs::remove(path);
+	}
+
+	// Broken data is rejected
+	{
+		auto form = make_shared<Form>();
+		std::string binary = form->compile(Sample);
+		expect_exception(exceptions::ParsingError, [&]() { form->parseCompiled(Sample, strlen(Sample)); });
+		expect_exception(exceptions::ParsingError, [&]() { form->parseCompiled(binary.data(), binary.size() - 1); });
+		expect(!form->children());
+
+		test_hint("Operations are checked while loading");
+		std::string broken = binary;
+		broken.back() = (char) 0xFF;
+		expect_exception(exceptions::ParsingError, [&]() { make_shared<Form>()->parseCompiled(broken.data(), broken.size()); });
+		broken = binary;
+		broken.back() = (char) 0x05; // an attribute without its name, text and value
+		expect_exception(exceptions::ParsingError, [&]() { make_shared<Form>()->parseCompiled(broken.data(), broken.size()); });
+	}
+}
@@ -0,0 +1,338 @@
+#include <wwidget/BasicContext.hpp>
+#include <wwidget/CanvasRecorder.hpp>
+#include <wwidget/InputQueue.hpp>
+#include <wwidget/widget/List.hpp>
+
+#include "Test.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace wwidget;
+
+namespace {
+
+/// Logs the events it receives, one line each
+class EventLog : public Widget {
+public:
+	std::string log;
+	size_t      pathLength = 0;
+
+	EventLog() { handles(handles() | Moved::handlerBit | Dragged::handlerBit); }
+
+	void on(Click const& c) override {
+		if(c.direction != Event::DIR_DOWN) return;
+		log += "click " + std::to_string(c.button) + (c.down() ? " down\n" : " up\n");
+		c.handled = true;
+	}
+	void on(Moved const& m) override {
+		if(m.direction != Event::DIR_DOWN) return;
+		log += "moved " + std::to_string((int) m.position.x) + " " + std::to_string((int) m.moved_x) + "\n";
+		pathLength = m.pathLength;
+		m.handled = true;
+	}
+	void on(Dragged const& d) override {
+		if(d.direction != Event::DIR_DOWN) return;
+		log += "dragged " + std::to_string((int) d.position.x) + " " + std::to_string((int) d.moved_x) + "\n";
+		pathLength = d.pathLength;
+		d.handled = true;
+	}
+	void on(KeyEvent const& k) override {
+		if(k.direction != Event::DIR_DOWN) return;
+		log += "key " + std::to_string(k.key) + "\n";
+		k.handled = true;
+	}
+};
+
+/// Overrides on(TextInput) without declaring it, counts how often it's asked anyway
+class Undeclared : public Widget {
+public:
+	size_t texts = 0;
+
+	void on(TextInput const& t) override { ++texts; }
+};
+
+/// Handles text input only while it's focused, passes it on to Widget::on() otherwise
+class FocusedText : public Widget {
+public:
+	size_t texts = 0;
+
+	FocusedText() { handles(handles() | TextInput::handlerBit); }
+
+	void on(TextInput const& t) override {
+		if(t.direction == Event::DIR_DOWN) ++texts;
+		if(focused()) t.handled = true;
+		else          Widget::on(t);
+	}
+};
+
+/// Handles text input
+class TextSink : public Widget {
+public:
+	std::string text;
+
+	TextSink() { handles(handles() | TextInput::handlerBit); }
+
+	void on(TextInput const& t) override {
+		text += t.utf8;
+		t.handled = true;
+	}
+};
+
+/// Logs when it's entered and left, and requests a redraw like widgets with a hover effect do
+class HoverLog : public Widget {
+public:
+	std::string& log;
+	char         name;
+
+	HoverLog(std::string& log, char name) : log(log), name(name) {}
+
+	PreferredSize onCalcPreferredSize(PreferredSize const& constraint) override {
+		return { Size(200, 20), Size(200, 20), Size(200, 20) };
+	}
+	void on(Enter const& e) override { log += std::string("+") + name; requestRedraw(); }
+	void on(Leave const& e) override { log += std::string("-") + name; requestRedraw(); }
+};
+
+TextInput character(uint32_t c) {
+	TextInput t;
+	t.utf32 = c;
+	t.calcUtf8();
+	return t;
+}
+
+Moved motion(float from, float to) {
+	Moved m;
+	m.old_x = from;
+	m.old_y = 10;
+	m.position = {to, 10};
+	m.moved_x = to - from;
+	m.moved_y = 0;
+	return m;
+}
+
+Dragged drag(float from, float to) {
+	Dragged d;
+	(Moved&) d = motion(from, to);
+	d.buttons[0] = true;
+	return d;
+}
+
+/// Types a hundred characters for every key, by queueing them while the key is dispatched
+class KeyRepeater : public TextSink {
+public:
+	InputQueue& queue;
+
+	KeyRepeater(InputQueue& queue) : queue(queue) {}
+
+	void on(KeyEvent const& k) override {
+		if(k.direction != Event::DIR_DOWN) return;
+		for(int i = 0; i < 100; i++) queue.push(character('a' + k.key));
+		k.handled = true;
+	}
+};
+
+} // namespace
+
+void testInput() {
+	BasicContext context;
+	auto canvas = context.headless({200, 100});
+	auto widget = context.rootWidget()->add<EventLog>();
+	context.update();
+	context.draw();
+
+	// Motion between clicks and keys is coalesced, everything keeps its order
+	{
+		auto& input = context.input();
+		for(int x = 0; x < 100; x++) input.push(motion(x, x + 1));
+
+		Click click;
+		click.position = {100, 10};
+		click.button   = 0;
+		click.state    = Event::DOWN;
+		input.push(click);
+
+		for(int x = 100; x < 150; x++) input.push(drag(x, x + 1));
+
+		click.position = {150, 10};
+		click.state    = Event::UP;
+		input.push(click);
+
+		KeyEvent key;
+		key.key = 65;
+		input.push(key);
+		for(int x = 150; x < 160; x++) input.push(motion(x, x + 1));
+
+		expect_eq(input.size(), 6u);
+		expect(widget->log.empty()); // Nothing is dispatched before the update
+		context.update();
+		expect(input.empty());
+		expect_eq(widget->log,
+			"moved 100 100\n"
+			"click 0 down\n"
+			"dragged 150 50\n"
+			"click 0 up\n"
+			"key 65\n"
+			"moved 160 10\n"
+		);
+		expect_eq(input.counters().received, 163u);
+		expect_eq(input.counters().coalesced, 157u);
+		expect_eq(input.counters().dispatched, 6u);
+		expect_eq(widget->pathLength, 0u);
+
+		test_hint("Input has to be drawn, even if the widgets don't request a redraw");
+		expect(context.needsDraw());
+	}
+
+	// Paths of coalesced motion are kept on request
+	{
+		auto& input = context.input();
+		input.keepPaths(true);
+		widget->log.clear();
+		for(int x = 0; x < 20; x++) input.push(motion(x, x + 1));
+		context.update();
+		expect_eq(widget->log, "moved 20 20\n");
+		expect_eq(widget->pathLength, 20u);
+		input.keepPaths(false);
+	}
+
+	// Events skip widgets and subtrees which don't handle them
+	{
+		Widget root;
+		auto panel = root.add<Widget>();
+		std::vector<shared<Undeclared>> undeclared;
+		for(int i = 0; i < 100; i++) undeclared.push_back(panel->add<Undeclared>());
+		auto asked = [&]() {
+			size_t n = 0;
+			for(auto& u : undeclared) n += u->texts;
+			return n;
+		};
+
+		expect(!(panel->subtreeHandles() & TextInput::handlerBit));
+		expect(!(root.subtreeHandles() & TextInput::handlerBit));
+		expect(root.subtreeHandles() & Click::handlerBit); // The default on(Click) focuses
+		test_hint("Nobody declared text input, it mustn't be dispatched");
+		expect(!root.send(character('a')));
+		expect_eq(asked(), 0u);
+
+		auto sink = panel->add<TextSink>();
+		expect(root.subtreeHandles() & TextInput::handlerBit);
+		expect(root.send(character('c')));
+		expect_eq(sink->text, "c");
+		expect_eq(asked(), 0u);
+
+		test_hint("Removing the sink narrows the masks down right away");
+		sink->remove();
+		expect(!(panel->subtreeHandles() & TextInput::handlerBit));
+		expect(!(root.subtreeHandles() & TextInput::handlerBit));
+		expect(root.subtreeHandles() & Click::handlerBit);
+		expect(!root.send(character('d')));
+		expect_eq(asked(), 0u);
+
+		test_hint("Masks stay as wide as the remaining children need");
+		auto first  = panel->add<TextSink>();
+		auto second = panel->add<TextSink>();
+		first->remove();
+		expect(root.subtreeHandles() & TextInput::handlerBit);
+		second->remove();
+		expect(!(root.subtreeHandles() & TextInput::handlerBit));
+	}
+
+	// Widgets which pass events on to Widget::on() keep getting them
+	{
+		Widget root;
+		auto focusOnly = root.add<FocusedText>();
+		expect(!root.send(character('a')));
+		expect(!root.send(character('b')));
+		expect_eq(focusOnly->texts, 2u);
+	}
+
+	// Hovering: Enter and Leave are sent when the path under the pointer changes
+	{
+		BasicContext context;
+		context.headless({200, 100});
+		std::string log;
+		auto list = context.rootWidget()->add<List>();
+		auto a = list->add<HoverLog>(log, 'a');
+		auto b = list->add<HoverLog>(log, 'b');
+		auto c = list->add<HoverLog>(log, 'c');
+		context.update();
+		context.draw();
+
+		auto& input = context.input();
+		auto  moveTo = [&](float y) {
+			Moved m = motion(10, 10);
+			m.position.y = y;
+			input.push(m);
+			context.update();
+		};
+
+		moveTo(5);
+		expect_eq(log, "+a");
+		expect(a->hovered() && list->hovered() && context.rootWidget()->hovered());
+		expect_eq(input.hoverPath().size(), 3u);
+		expect(input.hoverPath().back() == a.get());
+
+		context.draw();
+		input.resetCounters();
+		moveTo(8);
+		test_hint("Moving inside a hovered leaf mustn't hit test anything");
+		expect_eq(input.counters().hitTests, 0u);
+		expect_eq(log, "+a");
+
+		moveTo(25);
+		expect_eq(log, "+a-a+b");
+		expect(!a->hovered() && b->hovered());
+		expect(input.counters().hitTests <= 3u); // Only the children of the list
+		test_hint("Only the widgets whose hover state changed request a redraw");
+		expect(a->needsRedraw() && b->needsRedraw() && !c->needsRedraw());
+
+		b->remove();
+		expect(!b->hovered());
+		expect_eq(input.hoverPath().size(), 2u);
+		expect_eq(log, "+a-a+b"); // Removed widgets aren't left
+
+		moveTo(90);
+		expect_eq(log, "+a-a+b");
+		expect_eq(input.hoverPath().size(), 2u);
+		moveTo(25);
+		expect_eq(log, "+a-a+b+c");
+	}
+
+	// Input queued by handlers is dispatched with the next update
+	{
+		BasicContext context;
+		context.headless({200, 100});
+		auto& input    = context.input();
+		auto  repeater = context.rootWidget()->add<KeyRepeater>(input);
+
+		KeyEvent key;
+		key.key = 1;
+		input.push(key);
+		input.push(key);
+		expect_eq(input.dispatch(*context.rootWidget()), 2u);
+		expect_eq(input.size(), 200u);
+		expect(repeater->text.empty());
+
+		context.update();
+		expect(input.empty());
+		expect_eq(repeater->text, std::string(200, 'b'));
+	}
+
+	// A hovered root which outlives its context
+	{
+		std::string log;
+		HoverLog    root(log, 'r');
+		{
+			BasicContext context;
+			context.rootWidget(&root);
+			context.update();
+			context.input().push(motion(10, 10));
+			context.update();
+			expect(root.hovered());
+		}
+		test_hint("Destroying the context detaches its root");
+		expect(root.context() == nullptr);
+		expect(!root.hovered());
+	}
+}
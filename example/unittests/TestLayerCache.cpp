@@ -0,0 +1,185 @@
+#include <wwidget/BasicContext.hpp>
+#include <wwidget/CanvasRecorder.hpp>
+#include <wwidget/CanvasSoftware.hpp>
+#include <wwidget/LayerCache.hpp>
+#include <wwidget/widget/List.hpp>
+
+#include "Test.hpp"
+
+#include <cstring>
+
+using namespace wwidget;
+
+namespace {
+
+/// A filled rect with a fixed size
+class Swatch : public Widget {
+	Color mColor;
+	Size  mSize;
+protected:
+	PreferredSize onCalcPreferredSize(PreferredSize const& constraint) override {
+		return { mSize, mSize, mSize };
+	}
+	void onDrawBackground(Canvas& canvas) override {
+		canvas.fillColor(mColor).rect(Rect(size())).fill();
+	}
+public:
+	Swatch(Color c, Size s) : mColor(c), mSize(s) {}
+
+	void color(Color c) {
+		mColor = c;
+		requestRedraw();
+	}
+};
+
+/// A cacheable subtree: a background with two smaller swatches on it
+shared<Swatch> addPanel(Widget& parent) {
+	auto panel = parent.add<Swatch>(rgba(0, 0, 255, .5f), Size(40, 20));
+	panel->align(AlignNone);
+	panel->offset(3, 5);
+	auto a = panel->add<Swatch>(rgb(255, 0, 0), Size(10, 10));
+	a->align(AlignNone);
+	a->offset(2, 2);
+	auto b = panel->add<Swatch>(rgb(0, 255, 0), Size(12, 8));
+	b->align(AlignNone);
+	b->offset(20.5f, 4);
+	return panel;
+}
+
+/// A list of 100 rows with differently colored, partially covered swatches in them
+shared<List> addList(Widget& parent) {
+	auto list = parent.add<List>();
+	list->scrollable(true);
+	for(int i = 0; i < 100; i++) {
+		auto row = list->add<Swatch>(rgb(i * 40, 255 - i * 2, i * 7), Size(50, 7));
+		auto dot = row->add<Swatch>(rgba(255, 255, 255, .5f), Size(3.5f, 3.5f));
+		dot->align(AlignNone);
+		dot->offset(10.25f + i % 7, 1.5f);
+	}
+	return list;
+}
+
+} // namespace
+
+void testLayerCache() {
+	// A cached subtree looks the same as one which is drawn directly
+	{
+		BasicContext context;
+		context.headless({64, 32});
+		auto canvas = make_shared<CanvasSoftware>();
+		context.canvas(canvas);
+
+		auto frame = context.rootWidget()->add<Widget>();
+		auto panel = addPanel(*frame);
+		context.update();
+		context.draw();
+		Bitmap const expected = canvas->bitmap().toRGBA();
+		expect_eq(context.layers().size(), 0u);
+
+		panel->cacheAsLayer(true);
+		expect_eq(context.layers().size(), 1u);
+		context.update();
+		context.draw();
+		test_hint("A layer has to be drawn 1:1");
+		expect(memcmp(canvas->bitmap().data(), expected.data(), 64 * 32 * 4) == 0);
+		expect_eq(context.layers().counters().renders, 1u);
+		expect_eq(context.layers().counters().composites, 1u);
+		expect_eq(context.layers().memoryUsage(), 40u * 20 * 4);
+
+		// Unchanged: only composited
+		context.draw();
+		expect_eq(context.layers().counters().renders, 1u);
+		expect_eq(context.layers().counters().composites, 2u);
+
+		// A redraw in the subtree draws the layer again
+		static_cast<Swatch*>(panel->children().get())->color(rgb(255, 255, 0));
+		context.draw();
+		expect_eq(context.layers().counters().renders, 2u);
+		expect_eq(canvas->bitmap().data()[(7 * 64 + 5) * 4 + 1], 255); // Inside of the yellow swatch
+
+		// Too large for the budget: drawn directly, nothing is kept
+		context.layers().budget(1000);
+		panel->cacheAsLayer(false);
+		panel->cacheAsLayer(true);
+		context.draw();
+		expect_eq(context.layers().memoryUsage(), 0u);
+		expect_eq(context.layers().counters().renders, 2u);
+		expect_eq(canvas->bitmap().data()[(7 * 64 + 5) * 4 + 1], 255);
+
+		// Removed widgets don't keep their layer
+		context.layers().budget(1 << 20);
+		context.draw();
+		expect_eq(context.layers().memoryUsage(), 40u * 20 * 4);
+		panel->remove();
+		context.draw();
+		expect_eq(context.layers().memoryUsage(), 0u);
+	}
+
+	// Widgets unregister when they are destroyed
+	{
+		BasicContext context;
+		auto recorder = context.headless({64, 32});
+		auto frame    = context.rootWidget()->add<Widget>();
+		{
+			auto panel = addPanel(*frame);
+			panel->cacheAsLayer(true);
+			context.update();
+			context.draw();
+			expect_eq(recorder->frameStats().fills, 1u);
+			expect(recorder->log().find("drawLayer 1 0 0 40 20\n") != std::string::npos);
+			panel->remove();
+		}
+		expect_eq(context.layers().size(), 0u);
+	}
+
+	// Scrolling a cached list moves its layer and draws only what scrolled into view
+	{
+		BasicContext context, reference;
+		context.headless({64, 32});
+		reference.headless({64, 32});
+		auto canvas    = make_shared<CanvasSoftware>();
+		auto expected  = make_shared<CanvasSoftware>();
+		context.canvas(canvas);
+		reference.canvas(expected);
+
+		auto list = addList(*context.rootWidget());
+		auto same = addList(*reference.rootWidget());
+		list->cacheAsLayer(true);
+		context.update();
+		context.draw();
+		reference.update();
+		reference.draw();
+
+		float offsets[] = { 3, 10, 9, 40, 38, 600, 20, 20.5f };
+		for(float offset : offsets) {
+			list->scrollOffset(offset);
+			same->scrollOffset(offset);
+			context.update();
+			context.draw();
+			reference.update();
+			reference.draw();
+			test_hint("A moved layer has to look like a redrawn one");
+			expect(memcmp(canvas->bitmap().data(), expected->bitmap().data(), 64 * 32 * 4) == 0);
+		}
+		test_hint("Scrolling further than the list is high and by half pixels redraws everything");
+		expect_eq(context.layers().counters().blits, 5u);
+		expect_eq(context.layers().counters().renders, 1u + 8u);
+		expect_eq(context.layers().memoryUsage(), 2u * 64 * 32 * 4);
+	}
+
+	// A cached root which outlives its context
+	{
+		Swatch root(rgb(255, 0, 0), Size(64, 32));
+		root.cacheAsLayer(true);
+		{
+			BasicContext context;
+			context.canvas(make_shared<CanvasSoftware>());
+			context.rootWidget(&root);
+			context.update();
+			context.draw();
+			expect_eq(context.layers().size(), 1u);
+		}
+		test_hint("Destroying the context unregisters the root's layer");
+		expect(root.context() == nullptr);
+	}
+}
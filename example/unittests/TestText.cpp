@@ -0,0 +1,210 @@
+#include <wwidget/AttributeCollector.hpp>
+#include <wwidget/BasicContext.hpp>
+#include <wwidget/TextBuffer.hpp>
+#include <wwidget/TextMetricsCache.hpp>
+#include <wwidget/widget/TextField.hpp>
+#include <wwidget/widget/TextView.hpp>
+
+#include "Test.hpp"
+#include "TestCanvas.hpp"
+
+#include <string>
+
+using namespace wwidget;
+
+namespace {
+
+/// A TextView which behaves like the root of a window with a fixed size
+struct FixedTextView : public TextView {
+	Size fixed;
+	PreferredSize onCalcPreferredSize(PreferredSize const&) override { return { fixed, fixed, fixed }; }
+	void resize(float w, float h) { fixed = { w, h }; preferredSizeChanged(); requestRelayout(); }
+	using TextView::totalLength;
+};
+
+} // namespace
+
+void testText() {
+	// TextMetricsCache: hits, misses, bounded size
+	{
+		TestCanvas canvas;
+		TextMetricsCache cache(2);
+
+		Rect a = cache.bounds(canvas, "sans", 12, 0, TextMetricsCache::NoWrap, "hello");
+		Rect b = cache.bounds(canvas, "sans", 12, 0, TextMetricsCache::NoWrap, "hello");
+		expect_eq(canvas.measurements, 1u);
+		expect(a.width() == 40 && b.width() == 40);
+		expect_eq(cache.counters().hits, 1u);
+
+		cache.bounds(canvas, "sans", 12, 0, 16, "hello"); // Different wrap width
+		cache.bounds(canvas, "sans", 14, 0, TextMetricsCache::NoWrap, "hello"); // Different size, evicts the first
+		expect_eq(canvas.measurements, 3u);
+		expect_eq(cache.size(), 2u);
+		expect_eq(cache.counters().evictions, 1u);
+
+		cache.bounds(canvas, "sans", 12, 0, TextMetricsCache::NoWrap, "hello");
+		expect_eq(canvas.measurements, 4u);
+	}
+
+	// TextMetricsCache: equal hashes and lengths don't make different strings equal
+	{
+		TestCanvas canvas;
+		TextMetricsCache cache;
+
+		cache.bounds(canvas, "sans", 12, 0, TextMetricsCache::NoWrap, std::string("hello"), 42);
+		cache.bounds(canvas, "sans", 12, 0, TextMetricsCache::NoWrap, std::string("world"), 42);
+		expect_eq(canvas.measurements, 2u);
+		expect_eq(cache.counters().hits, 0u);
+
+		cache.bounds(canvas, "sans", 12, 0, TextMetricsCache::NoWrap, std::string("hello"), 42);
+		expect_eq(canvas.measurements, 2u);
+		expect_eq(cache.counters().hits, 1u);
+	}
+
+	// TextView: only visible paragraphs are wrapped and drawn
+	{
+		BasicContext context;
+		auto canvas = make_shared<TestCanvas>();
+		context.canvas(canvas);
+
+		FixedTextView view;
+		view.resize(400, 160); // 50 characters, 10 lines
+		context.rootWidget(&view);
+
+		std::string document;
+		for(int i = 0; i < 10000; i++) {
+			if(i > 0) document += '\n';
+			for(int word = 0; word < 10; word++)
+				document += std::string(9, 'a' + i % 26) + ' '; // Two lines of 50 characters per paragraph
+		}
+		view.content(document);
+		expect_eq(view.paragraphs(), 10000u);
+		expect_eq(view.wrapCount(), 0u);
+
+		context.update();
+		context.draw();
+		expect_eq(canvas->textDraws, 10u);
+		expect_eq(view.wrapCount(), 5u);
+
+		// Edits only re-wrap the edited paragraph
+		size_t lines = view.lineCount();
+		view.replace(1, 1, std::string(10, 'x'));
+		expect_eq(view.lineCount(), lines - 1);
+		canvas->textDraws = 0;
+		context.draw();
+		expect_eq(view.wrapCount(), 7u); // The edited paragraph, and one more line of the next paragraph is visible now
+		expect_eq(canvas->textDraws, 10u);
+
+		// Scrolling to the end only wraps what becomes visible
+		view.scrollState(1);
+		context.update();
+		context.draw();
+		expect(view.wrapCount() <= 7u + 10u);
+
+		// Width changes: stale paragraphs are estimated until they're visible
+		size_t before = view.wrapCount();
+		view.resize(800, 160);
+		context.update();
+		context.draw();
+		expect(view.wrapCount() - before <= 10u);
+		expect_eq(view.content().size(), document.size() - 90);
+	}
+	// TextView: appending to the last paragraph updates the line count and the scrollable length
+	{
+		BasicContext context;
+		auto canvas = make_shared<TestCanvas>();
+		context.canvas(canvas);
+
+		FixedTextView view;
+		view.resize(400, 160);
+		context.rootWidget(&view);
+		view.content("first\n");
+		context.update();
+		context.draw();
+		expect_eq(view.lineCount(), 2u);
+
+		view.append(std::string(200, 'a')); // Estimated at more than one line
+		size_t lines = view.lineCount();
+		expect(lines > 2u);
+		expect(view.totalLength() == lines * view.lineHeight());
+
+		context.update();
+		context.draw();
+		expect(view.totalLength() == view.lineCount() * view.lineHeight());
+		view.append("\nlast");
+		expect(view.totalLength() == view.lineCount() * view.lineHeight());
+		expect_eq(view.paragraphs(), 3u);
+	}
+	// TextBuffer: editing at the cursor, UTF-8, selection, cached advances
+	{
+		size_t measured = 0;
+		TextBuffer::Measure measure = [&](std::string_view ch) { measured++; return ch.size() == 1 ? 8.f : 16.f; };
+
+		TextBuffer buffer;
+		buffer.assign("hello", measure);
+		expect_eq(buffer.str(), std::string("hello"));
+		expect_eq(buffer.cursor(), 5u);
+		expect(buffer.width() == 40 && buffer.cursorX() == 40);
+
+		buffer.moveLeft();
+		buffer.moveLeft();
+		buffer.insert("\xC3\xA4", measure); // ä, one character of two bytes
+		expect_eq(buffer.str(), std::string("hel\xC3\xA4lo"));
+		expect_eq(buffer.cursor(), 5u);
+		expect(buffer.cursorX() == 40 && buffer.width() == 56);
+		expect_eq(measured, 6u);
+
+		buffer.moveLeft();
+		expect_eq(buffer.cursor(), 3u);
+		buffer.moveRight();
+		buffer.eraseBackward();
+		expect_eq(buffer.str(), std::string("hello"));
+		expect(buffer.width() == 40 && buffer.cursorX() == 24);
+
+		// Moving the cursor doesn't measure anything
+		buffer.moveHome();
+		buffer.moveEnd();
+		expect_eq(measured, 6u);
+		expect(buffer.xAt(2) == 16);
+		expect_eq(buffer.positionAt(19), 2u);
+		expect_eq(buffer.positionAt(21), 3u);
+
+		// Typing replaces the selection
+		buffer.select(1, 4);
+		expect_eq(buffer.selection(), std::string("ell"));
+		buffer.insert("a", measure);
+		expect_eq(buffer.str(), std::string("hao"));
+		expect(!buffer.hasSelection());
+		buffer.eraseForward();
+		expect_eq(buffer.str(), std::string("ha"));
+
+		// Many inserts grow the gap, not the number of measurements
+		measured = 0;
+		for(int i = 0; i < 1000; i++) buffer.insert("x", measure);
+		expect_eq(buffer.size(), 1002u);
+		expect_eq(measured, 1000u);
+		expect(buffer.width() == 1002 * 8);
+	}
+
+	// TextField keeps its text in a TextBuffer, it's seen through Text as well
+	{
+		auto field = make_shared<TextField>();
+		Text& text = *field;
+		text.content("ab");
+		expect_eq(field->buffer().str(), std::string("ab"));
+
+		TextInput input;
+		input.utf32 = 'c';
+		input.calcUtf8();
+		field->send(input);
+		expect_eq(field->buffer().str(), std::string("abc"));
+		expect_eq(text.content(), std::string("abc"));
+
+		std::string collected;
+		auto collector = MakeStringAttributeCollector([&](std::string_view name, std::string_view value, std::string_view) {
+			if(name == "content") collected = value;
+		});
+		field->getAttributes(collector);
+		expect_eq(collected, std::string("abc"));
+	}
+}
@@ -0,0 +1,76 @@
+#include <wwidget/TextureAtlas.hpp>
+#include <wwidget/Bitmap.hpp>
+
+#include "Test.hpp"
+
+#include <cstring>
+#include <vector>
+
+using namespace wwidget;
+
+static bool overlaps(TextureAtlas::Region const& a, TextureAtlas::Region const& b, unsigned pad) {
+	return a.page == b.page &&
+		a.x < b.x + b.width  + 2 * pad && b.x < a.x + a.width  + 2 * pad &&
+		a.y < b.y + b.height + 2 * pad && b.y < a.y + a.height + 2 * pad;
+}
+
+void testTextureAtlas() {
+	// Packing: no overlaps, padding stays inside the page
+	{
+		TextureAtlas atlas(256, 64, 1);
+		expect(!atlas.fits(65, 10));
+		expect(!atlas.allocate(65, 10));
+
+		std::vector<TextureAtlas::Region> regions;
+		for(unsigned i = 0; i < 200; i++) {
+			regions.push_back(atlas.allocate(8 + i % 24, 8 + (i * 7) % 24));
+		}
+
+		bool valid = true;
+		for(size_t i = 0; i < regions.size(); i++) {
+			auto& r = regions[i];
+			valid = valid && r && r.x >= 1 && r.y >= 1 && r.x + r.width + 1 <= 256 && r.y + r.height + 1 <= 256;
+			for(size_t j = i + 1; j < regions.size(); j++)
+				valid = valid && !overlaps(r, regions[j], 0);
+		}
+		expect(valid);
+		expect(atlas.pageCount() >= 1);
+
+		// Releasing everything evicts all pages
+		size_t evicted = 0;
+		for(auto& r : regions) evicted += atlas.release(r);
+		expect_eq(atlas.pageCount(), 0u);
+		expect(evicted >= 1);
+		expect(atlas.pixels(0) == nullptr);
+	}
+
+	// Released shelves are reused instead of growing the page
+	{
+		TextureAtlas atlas(64, 16, 0);
+		std::vector<TextureAtlas::Region> regions;
+		for(int i = 0; i < 16; i++) regions.push_back(atlas.allocate(16, 16));
+		expect_eq(atlas.pageCount(), 1u);
+		for(int i = 0; i < 4; i++) atlas.release(regions[i]); // The first shelf
+		auto r = atlas.allocate(16, 16);
+		expect_eq(r.page, 0u);
+		expect_eq(r.y, regions[0].y);
+		expect_eq(atlas.pageCount(), 1u);
+	}
+
+	// Pixels are converted to RGBA and the edges repeated into the padding
+	{
+		TextureAtlas atlas(32, 16, 1);
+		Bitmap bm;
+		bm.init(2, 2, Bitmap::ALPHA);
+		memset(bm.data(), 200, 4);
+		auto r = atlas.add(bm);
+		expect(bool(r));
+
+		uint8_t const* page = atlas.pixels(r.page);
+		auto alpha = [&](unsigned x, unsigned y) { return page[(y * 32 + x) * 4 + 3]; };
+		expect_eq(alpha(r.x, r.y), 200);
+		expect_eq(alpha(r.x - 1, r.y - 1), 200);
+		expect_eq(alpha(r.x + 2, r.y + 2), 200);
+		expect_eq(page[(r.y * 32 + r.x) * 4], 255);
+	}
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "Attributes.hpp"
+
+#include <string>
+#include <string_view>
+
+namespace wwidget {
+
+class Widget;
+
+/// The types attributes are set as: name in AttributeType, C++ type, conversion from an Attribute
+#define WWIDGET_ATTRIBUTE_TYPES(X) \
+	X(Bool,          bool,          toBool)          \
+	X(Float,         float,         toFloat)         \
+	X(Int,           int64_t,       toInt)           \
+	X(String,        std::string,   toString)        \
+	X(Flow,          Flow,          toFlow)          \
+	X(HalfAlignment, HalfAlignment, toHalfAlignment) \
+	X(Alignment,     Alignment,     toAlignment)     \
+	X(Padding,       Padding,       toPadding)       \
+	X(Point,         Point,         toPoint)         \
+	X(Offset,        Offset,        toOffset)        \
+	X(Size,          Size,          toSize)          \
+	X(Rect,          Rect,          toRect)          \
+	X(Color,         Color,         toColor)
+
+enum class AttributeType : unsigned char {
+	#define WWIDGET_X(NAME, TYPE, TO) NAME,
+	WWIDGET_ATTRIBUTE_TYPES(WWIDGET_X)
+	#undef WWIDGET_X
+};
+
+/// One attribute of a widget class: its name, the type it is set as, a setter and optionally a getter and the setter as C++ code.
+///  They are usually captureless lambdas, which cast the widget to the class, e.g.
+///  `{ "fontSize", [](Widget& w, float f) { static_cast<Text&>(w).fontSize(f); }, [](Widget const& w) { return static_cast<Text const&>(w).fontSize(); }, "$.fontSize(%);" }`.
+///  Find them with Widget::attributeTable() once, then they can be set without looking them up or parsing anything.
+class AttributeInfo {
+	union Setter {
+		#define WWIDGET_X(NAME, TYPE, TO) \
+			void (*set##NAME)(Widget&, TYPE); \
+			constexpr Setter(void (*fn)(Widget&, TYPE)) : set##NAME(fn) {}
+		WWIDGET_ATTRIBUTE_TYPES(WWIDGET_X)
+		#undef WWIDGET_X
+	};
+	union Getter {
+		#define WWIDGET_X(NAME, TYPE, TO) \
+			TYPE (*get##NAME)(Widget const&); \
+			constexpr Getter(TYPE (*fn)(Widget const&)) : get##NAME(fn) {}
+		WWIDGET_ATTRIBUTE_TYPES(WWIDGET_X)
+		#undef WWIDGET_X
+	};
+
+	std::string_view mName;
+	AttributeType    mType;
+	Setter           mSetter;
+	Getter           mGetter; //!< Can be nullptr
+	const char*      mCode;   //!< Can be nullptr
+
+public:
+	#define WWIDGET_X(NAME, TYPE, TO) \
+		constexpr AttributeInfo(std::string_view name, void (*set)(Widget&, TYPE), TYPE (*get)(Widget const&) = nullptr, const char* code = nullptr) : \
+			mName(name), mType(AttributeType::NAME), mSetter(set), mGetter(get), mCode(code) {}
+	WWIDGET_ATTRIBUTE_TYPES(WWIDGET_X)
+	#undef WWIDGET_X
+
+	constexpr std::string_view name() const noexcept { return mName; }
+	constexpr AttributeType    type() const noexcept { return mType; }
+	/// What the setter does as a C++ statement, for Form::generateCpp(): $ is the widget, % the value as a literal of type(). Can be nullptr.
+	constexpr const char*      code() const noexcept { return mCode; }
+	bool                       readable() const noexcept;
+
+	/// Converts the value to type() and sets it. Throws like the conversion does.
+	void set(Widget& w, Attribute const& value) const;
+	/// Sets the value if it has the type() of the attribute, returns false otherwise
+	#define WWIDGET_X(NAME, TYPE, TO) bool set(Widget& w, TYPE value) const;
+	WWIDGET_ATTRIBUTE_TYPES(WWIDGET_X)
+	#undef WWIDGET_X
+	bool set(Widget& w, const char* value) const { return set(w, std::string(value)); }
+	bool set(Widget& w, std::string_view value) const { return set(w, std::string(value)); }
+
+	/// Reads the value if it has the type() of the attribute and readable(), returns false otherwise
+	#define WWIDGET_X(NAME, TYPE, TO) bool get(Widget const& w, TYPE& value) const;
+	WWIDGET_ATTRIBUTE_TYPES(WWIDGET_X)
+	#undef WWIDGET_X
+};
+
+/// The attributes of a widget class, see Widget::attributeTable().
+///  Lookups search the class first and then its base classes, so classes can replace attributes of their bases.
+class AttributeTable {
+	static constexpr size_t IndexSize = 64;
+
+	std::string_view      mClassName;
+	AttributeInfo const*  mBegin;
+	AttributeInfo const*  mEnd;
+	AttributeTable const& (*mBase)(); //!< Can be nullptr
+	unsigned char         mIndex[IndexSize] {}; //!< Open addressing by slot(), position in the table + 1, 0 is empty
+
+	/// Cheaper than hashing the whole name, attribute names rarely share their length and both ends
+	static constexpr size_t slot(std::string_view name) noexcept {
+		return (name.size() * 7 + size_t((unsigned char)name.front()) * 3 + size_t((unsigned char)name.back())) % IndexSize;
+	}
+
+public:
+	template<size_t N>
+	constexpr AttributeTable(std::string_view className, AttributeInfo const (&attributes)[N], AttributeTable const& (*base)() = nullptr) :
+		mClassName(className), mBegin(attributes), mEnd(attributes + N), mBase(base)
+	{
+		static_assert(N < IndexSize / 2, "Too many attributes for the index");
+		for(size_t i = 0; i < N; i++) {
+			size_t s = slot(attributes[i].name());
+			while(mIndex[s]) s = (s + 1) % IndexSize;
+			mIndex[s] = (unsigned char)(i + 1);
+		}
+	}
+
+	constexpr std::string_view     className() const noexcept { return mClassName; }
+	constexpr AttributeInfo const* begin() const noexcept { return mBegin; }
+	constexpr AttributeInfo const* end() const noexcept { return mEnd; }
+	AttributeTable const*          base() const noexcept { return mBase ? &mBase() : nullptr; }
+
+	/// The attribute of this class or the nearest base class with the name, nullptr if there is none
+	AttributeInfo const* find(std::string_view name) const noexcept;
+};
+
+} // namespace wwidget
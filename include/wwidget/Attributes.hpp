@@ -466,10 +466,11 @@ public:
 	virtual int64_t     toInt() const;
 };
 
+/// Parses the text when it's converted. Doesn't copy it, it has to outlive the attribute.
 struct StringAttribute : public Attribute {
-	std::string const& value;
+	std::string_view value;
 
-	StringAttribute(std::string const& s) : value(s) {}
+	StringAttribute(std::string_view s) : value(s) {}
 
 	Color         toColor() const override;
 	Point         toPoint() const override;
@@ -2,8 +2,11 @@
 
 #include "Context.hpp"
 
+#include <chrono>
+
 namespace wwidget {
 
+class CanvasRecorder;
 class Font;
 
 class BasicContext : public Context {
@@ -17,6 +20,7 @@ public:
 	void cleanCache();
 
 	void defer(std::function<void()>) override;
+	void defer(TaskPriority, std::function<void()>) override;
 
 	void loadImage(std::function<void(shared<Bitmap>)>, std::string const& url) override;
 
@@ -25,14 +29,58 @@ public:
 	void execute(Widget* from, std::string_view cmd) override;
 	void execute(Widget* from, std::string_view const* cmds, size_t count) override;
 
+	/// Deferred tasks executed and carried over to the next frame by the last update(), by priority
+	struct TaskStats {
+		size_t executed[TaskPriorityCount]    = {};
+		size_t carriedOver[TaskPriorityCount] = {};
+	};
+
+	/// Dispatches the queued input() to the root widget, executes deferred tasks and updates the layout.
+	///  Input tasks are always executed, layout and background tasks only until the task budget is used up.
+	///  Whatever doesn't fit is carried over to the next update().
 	bool update() override;
+	TaskStats const& taskStats() const noexcept;
+
+	void                      taskBudget(std::chrono::microseconds budget) noexcept;
+	std::chrono::microseconds taskBudget() const noexcept;
+
+	/// Draws the root widget. With renderOnDemand() it does nothing unless needsDraw().
 	void draw(float dpi = 92) override;
 
+	/// Render on demand: draw() only draws when something changed since the last frame,
+	///  i.e. a widget requested a redraw or relayout, update() executed tasks, the frame size or canvas changed,
+	///  redraw() was called or a frame requested with requestFrame() is due.
+	///  Widgets which change how they look outside of tasks and input have to call requestRedraw().
+	void renderOnDemand(bool b) noexcept;
+	bool renderOnDemand() const noexcept;
+	bool needsDraw() const noexcept; //!< Whether the next draw() draws something with renderOnDemand()
+	void redraw() noexcept; //!< Makes the next draw() draw, e.g. after input
+
+	void              requestFrame(Clock::time_point when = Clock::now()) override;
+	Clock::time_point frameDeadline() const noexcept; //!< The earliest requested frame which wasn't drawn yet, Clock::time_point::max() if there is none
+
+	/// Blocks until wakeup() is called or frameDeadline() has passed. Returns right away while needsDraw().
+	///  Windows wait for events of the window system instead.
+	virtual void waitEvents();
+	void wakeup() override;
+
+	/// Sets the widget which is drawn and receives input, nullptr detaches the current one
 	void rootWidget(Widget* w);
 	Widget* rootWidget();
 
 	void canvas(shared<Canvas> c) noexcept;
 	Canvas& canvas() const noexcept override;
+
+	/// Runs update() and draw() without a window, e.g. for tests on machines without a display.
+	///  Sets the root widget to one with a fixed size of frameSize and the canvas to a CanvasRecorder, which is returned.
+	///  Widgets added to rootWidget() fill the frame. Calling it again only changes the frame size.
+	shared<CanvasRecorder> headless(Size const& frameSize);
+	bool                   headless() const noexcept;
+
+	/// Windows push the events of the window system here
+	InputQueue&       input() noexcept override;
+	TextMetricsCache& textMetrics() noexcept override;
+	LayerCache&       layers() noexcept override;
 };
 
 } // namespace wwidget
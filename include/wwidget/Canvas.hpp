@@ -4,6 +4,7 @@
 #include <memory>
 #include <deque>
 #include <functional>
+#include <vector>
 
 #include "Attributes.hpp"
 
@@ -22,6 +23,14 @@ struct FontMetrics {
 	float line_height;
 };
 
+/// An offscreen render target, created and drawn by a Canvas. See LayerCache.
+struct Layer {
+	shared<void> handle; //!< Owned by the canvas which created it
+	unsigned     width = 0, height = 0; //!< In pixels
+
+	size_t memoryUsage() const noexcept { return size_t(width) * height * 4; } //!< RGBA
+};
+
 class Canvas {
 public:
 	// Frame
@@ -78,12 +87,51 @@ public:
 	virtual Rect        textBounds(Point const& position, std::string_view txt) = 0;
 	virtual Rect        textBoxBounds(Point const& position, float maxWidth, std::string_view txt) = 0;
 	virtual FontMetrics fontMetrics() = 0;
+	/// Appends the byte offsets of the lines when txt is wrapped at maxWidth. The first line always starts at 0.
+	/// The default implementation breaks between words and measures them with textBounds().
+	virtual void        textBreakLines(std::string_view txt, float maxWidth, std::vector<uint32_t>& lineStarts);
 
 	// Commit
 	virtual Canvas& fill() = 0;
 	virtual Canvas& fillPreserve() = 0; //!< Fill, but don't reset path
 	virtual Canvas& stroke() = 0;
 	virtual Canvas& strokePreserve() = 0; //!< Stroke, but don't reset path
+
+	// Batches: many primitives in one call, so backends can merge them.
+	// The default implementations call the methods above, the path should be empty before calling them.
+	struct TexturedQuad {
+		Rect to;   //!< Where it's drawn
+		Rect from; //!< The area of the bitmap, in pixels
+
+		/// Where the whole bitmap has to be mapped to, so that `from` ends up on `to`
+		Rect mapping(float bitmapWidth, float bitmapHeight) const noexcept {
+			float sx = to.width() / from.width(), sy = to.height() / from.height();
+			return { to.min.x - from.min.x * sx, to.min.y - from.min.y * sy, bitmapWidth * sx, bitmapHeight * sy };
+		}
+	};
+	struct GlyphRun {
+		Point            position;
+		std::string_view text;
+	};
+
+	/// Fills every area with its color, like fillColor(colors[i]).rect(areas[i]).fill(). Leaves the fill color at the last one.
+	/// Without colors all areas are filled with the current fill paint at once.
+	virtual Canvas& rects(Rect const* areas, Color const* colors, size_t count);
+	/// Strokes a line through the points with the current stroke paint, like moveTo(), lineTo()..., stroke()
+	virtual Canvas& polyline(Point const* points, size_t count);
+	/// Draws areas of a bitmap, e.g. the icons of a sprite sheet. Leaves the fill paint at the last quad.
+	virtual Canvas& texturedQuads(shared<Bitmap> const& bm, TexturedQuad const* quads, size_t count, Color const& tint = Color::white());
+	/// Draws every run with the current font and fill paint, like text()
+	virtual Canvas& glyphRuns(GlyphRun const* runs, size_t count);
+
+	// Layers
+	/// Redirects drawing into layer, which is (re)allocated to width x height pixels and cleared.
+	/// Called outside of beginFrame()/endFrame(), layers are drawn before the frame.
+	/// Returns false if the canvas can't draw offscreen, the default. Then nothing has to be drawn and endLayer() isn't called.
+	virtual bool    beginLayer(Layer& layer, unsigned width, unsigned height);
+	virtual Canvas& endLayer();
+	/// Draws the layer onto the area `to`, using the current transform and scissor
+	virtual Canvas& drawLayer(Layer const& layer, Rect const& to);
 };
 
 } // namespace wwidget
@@ -2,13 +2,18 @@
 
 #include "Bitmap.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <cstdio>
+#include <cstring>
 
 namespace wwidget {
 
 CanvasNVG::CanvasNVG(NVGcontext* ctxt, PFNContextClose close_ctxt) :
 	m_context(ctxt),
-	m_close_ctxt(close_ctxt)
+	m_close_ctxt(close_ctxt),
+	m_state(defaultState()),
+	m_applied(defaultState())
 {
 	for(auto [name, path] : std::initializer_list<std::pair<const char*, const char*>>{
 		{"serif", "/usr/share/fonts/TTF/DejaVuSerif.ttf"},
@@ -16,8 +21,9 @@ CanvasNVG::CanvasNVG(NVGcontext* ctxt, PFNContextClose close_ctxt) :
 		{"sans", "/usr/share/fonts/TTF/DejaVuSans.ttf" },
 		{"icon", "/usr/share/fonts/noto/NotoSansSymbols2-Regular.ttf"}
 	}) {
-		int createFontResult = nvgCreateFont(m_context, name, path);
-		assert(0 <= createFontResult);
+		if(nvgCreateFont(m_context, name, path) < 0) {
+			fprintf(stderr, "Failed loading font '%s' from %s\n", name, path);
+		}
 	}
 	nvgAddFallbackFont(m_context, "mono",  "icon");
 	nvgAddFallbackFont(m_context, "sans",  "icon");
@@ -29,11 +35,14 @@ CanvasNVG::~CanvasNVG() {
 	}
 }
 
-int CanvasNVG::getHandle(shared<Bitmap> const& bm) {
+CanvasNVG::Texture const& CanvasNVG::getHandle(shared<Bitmap> const& bm) {
 	if(bm->mRendererProxy) {
-		return (int)(size_t)bm->mRendererProxy.get();
+		return *(Texture*) bm->mRendererProxy.get();
 	}
-	else {
+
+	TextureAtlas::Region region;
+	if(m_use_atlas) region = m_atlas.add(*bm);
+	if(!region) {
 		int texture = nvgCreateImageRGBA(
 			m_context,
 			bm->width(), bm->height(),
@@ -42,125 +51,304 @@ int CanvasNVG::getHandle(shared<Bitmap> const& bm) {
 		);
 		assert(texture >= 0);
 		bm->mRendererProxy = {
-			(void*)(size_t)texture,
+			(void*) new Texture { texture, {} },
 			[this](void* vp) {
-				nvgDeleteImage(m_context, (int)(size_t)vp);
+				auto* t = (Texture*) vp;
+				nvgDeleteImage(m_context, t->image);
+				delete t;
 			}
 		};
-		return texture;
+		return *(Texture*) bm->mRendererProxy.get();
+	}
+
+	if(m_atlas_pages.size() <= region.page)
+		m_atlas_pages.resize(region.page + 1);
+
+	AtlasPage& page = m_atlas_pages[region.page];
+	if(page.image == 0) {
+		page.image = nvgCreateImageRGBA(m_context, m_atlas.pageSize(), m_atlas.pageSize(), 0, m_atlas.pixels(region.page));
+		assert(page.image > 0);
+	}
+	else {
+		// Uploaded once per frame, nanovg only renders in endFrame()
+		unsigned pad = m_atlas.padding();
+		unsigned x0 = region.x - pad, x1 = region.x + region.width + pad;
+		unsigned y0 = region.y - pad, y1 = region.y + region.height + pad;
+		if(!page.dirty) {
+			page.dirty = true;
+			page.dirty_min_x = x0; page.dirty_min_y = y0;
+			page.dirty_max_x = x1; page.dirty_max_y = y1;
+		}
+		else {
+			page.dirty_min_x = std::min(page.dirty_min_x, x0); page.dirty_min_y = std::min(page.dirty_min_y, y0);
+			page.dirty_max_x = std::max(page.dirty_max_x, x1); page.dirty_max_y = std::max(page.dirty_max_y, y1);
+		}
+	}
+
+	bm->mRendererProxy = {
+		(void*) new Texture { page.image, region },
+		[this](void* vp) {
+			auto* t = (Texture*) vp;
+			if(m_atlas.release(t->region)) {
+				AtlasPage& page = m_atlas_pages[t->region.page];
+				nvgDeleteImage(m_context, page.image);
+				page.image = 0;
+				page.dirty = false;
+			}
+			delete t;
+		}
+	};
+	return *(Texture*) bm->mRendererProxy.get();
+}
+
+void CanvasNVG::uploadAtlas() {
+	NVGparams* params = nvgInternalParams(m_context);
+	for(unsigned i = 0; i < m_atlas_pages.size(); i++) {
+		AtlasPage& page = m_atlas_pages[i];
+		if(!page.dirty) continue;
+		// The renderer reads the rect from the full page
+		params->renderUpdateTexture(params->userPtr, page.image,
+			page.dirty_min_x, page.dirty_min_y,
+			page.dirty_max_x - page.dirty_min_x, page.dirty_max_y - page.dirty_min_y,
+			m_atlas.pixels(i));
+		page.dirty = false;
+	}
+}
+
+NVGpaint CanvasNVG::texturePaint(Rect const& to, shared<Bitmap> const& bm) {
+	Texture const& tex = getHandle(bm);
+	if(!tex.region) {
+		return nvgImagePattern(m_context,
+			to.min.x, to.min.y, // Translation
+			to.width(), to.height(), // Scale
+			0, // rotation
+			tex.image, // image
+			1 // alpha
+		);
+	}
+
+	// Map the whole page so that the bitmap's region ends up on `to`
+	float sx = to.width()  / tex.region.width;
+	float sy = to.height() / tex.region.height;
+	return nvgImagePattern(m_context,
+		to.min.x - tex.region.x * sx, to.min.y - tex.region.y * sy,
+		m_atlas.pageSize() * sx, m_atlas.pageSize() * sy,
+		0,
+		tex.image,
+		1
+	);
+}
+
+static NVGpaint colorPaint(Color const& color) noexcept {
+	NVGpaint paint;
+	memset(&paint, 0, sizeof(paint));
+	nvgTransformIdentity(paint.xform);
+	paint.feather    = 1;
+	paint.innerColor = paint.outerColor = nvgRGBAf(color.r, color.g, color.b, color.a);
+	return paint;
+}
+static bool sameColor(Color const& a, Color const& b) noexcept {
+	return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+}
+static bool sameRect(Rect const& a, Rect const& b) noexcept {
+	return a.min == b.min && a.max == b.max;
+}
+static bool samePaint(NVGpaint const& a, NVGpaint const& b) noexcept {
+	return memcmp(&a, &b, sizeof(NVGpaint)) == 0;
+}
+
+// State tracking
+CanvasNVG::State CanvasNVG::defaultState() const noexcept {
+	State s;
+	s.fill   = colorPaint(Color::white());
+	s.stroke = colorPaint(Color::black());
+	return s;
+}
+
+Rect CanvasNVG::toPixels(Rect const& r) const noexcept {
+	float x0 = r.min.x * m_state.sx + m_state.tx, x1 = r.max.x * m_state.sx + m_state.tx;
+	float y0 = r.min.y * m_state.sy + m_state.ty, y1 = r.max.y * m_state.sy + m_state.ty;
+	return Rect::absolute(std::min(x0, x1), std::min(y0, y1), std::max(x0, x1), std::max(y0, y1));
+}
+NVGpaint CanvasNVG::toPixels(NVGpaint paint) const noexcept {
+	float xform[6] = { m_state.sx, 0, 0, m_state.sy, m_state.tx, m_state.ty };
+	nvgTransformMultiply(paint.xform, xform);
+	return paint;
+}
+
+void CanvasNVG::sync(unsigned flags) {
+	State const& s = m_state;
+	State&       a = m_applied;
+
+	bool scissor = (flags & SyncScissor) &&
+		(s.scissored != a.scissored || (s.scissored && !sameRect(s.scissor, a.scissor)));
+	bool fill    = (flags & SyncFill)   && !samePaint(s.fill, a.fill);
+	bool stroke  = (flags & SyncStroke) && !samePaint(s.stroke, a.stroke);
+
+	// nanovg transforms scissors and paints by the current transform, ours are in pixels already
+	if(scissor || fill || stroke) {
+		nvgResetTransform(m_context);
+		a.sx = a.sy = 1;
+		a.tx = a.ty = 0;
+	}
+	if(scissor) {
+		if(s.scissored)
+			nvgScissor(m_context, s.scissor.min.x, s.scissor.min.y, s.scissor.width(), s.scissor.height());
+		else
+			nvgResetScissor(m_context);
+		a.scissored = s.scissored;
+		a.scissor   = s.scissor;
+	}
+	if(fill) {
+		nvgFillPaint(m_context, s.fill);
+		a.fill = s.fill;
+	}
+	if(stroke) {
+		nvgStrokePaint(m_context, s.stroke);
+		a.stroke = s.stroke;
+	}
+
+	if(s.sx != a.sx || s.sy != a.sy || s.tx != a.tx || s.ty != a.ty) {
+		nvgResetTransform(m_context);
+		nvgTransform(m_context, s.sx, 0, 0, s.sy, s.tx, s.ty);
+		a.sx = s.sx; a.sy = s.sy;
+		a.tx = s.tx; a.ty = s.ty;
+	}
+
+	if((flags & SyncStroke) && s.line_width != a.line_width) {
+		nvgStrokeWidth(m_context, s.line_width);
+		a.line_width = s.line_width;
+	}
+	if(flags & SyncFont) {
+		if(s.font != a.font)                     nvgFontFaceId(m_context, a.font = s.font);
+		if(s.font_size != a.font_size)           nvgFontSize(m_context, a.font_size = s.font_size);
+		if(s.font_blur != a.font_blur)           nvgFontBlur(m_context, a.font_blur = s.font_blur);
+		if(s.letter_spacing != a.letter_spacing) nvgTextLetterSpacing(m_context, a.letter_spacing = s.letter_spacing);
+		if(s.line_height != a.line_height)       nvgTextLineHeight(m_context, a.line_height = s.line_height);
 	}
 }
 
 // Frame
 Canvas& CanvasNVG::beginFrame(Size const& frame_size, float dpi) {
 	nvgBeginFrame(m_context, frame_size.x, frame_size.y, dpi / 25.4f);
+	m_state = m_applied = defaultState();
+	m_states.clear();
 	return *this;
 }
 Canvas& CanvasNVG::endFrame() {
+	uploadAtlas();
 	nvgEndFrame(m_context);
 	return *this;
 }
 Canvas& CanvasNVG::cancelFrame() {
+	uploadAtlas();
 	nvgCancelFrame(m_context);
 	return *this;
 }
 
 // State
 Canvas& CanvasNVG::pushState() {
-	nvgSave(m_context);
+	m_states.push_back(m_state);
 	return *this;
 }
 Canvas& CanvasNVG::popState() {
-	nvgRestore(m_context);
+	if(!m_states.empty()) {
+		m_state = m_states.back();
+		m_states.pop_back();
+	}
 	return *this;
 }
 Canvas& CanvasNVG::resetState() {
-	nvgReset(m_context);
+	m_state = defaultState();
 	return *this;
 }
 
 // Scissor
 Canvas& CanvasNVG::scissor(Rect const& area) {
-	nvgScissor(m_context, area.min.x, area.min.y, area.width(), area.height());
+	m_state.scissor   = toPixels(area);
+	m_state.scissored = true;
 	return *this;
 }
 Canvas& CanvasNVG::scissorIntersect(Rect const& area) {
-	nvgIntersectScissor(m_context, area.min.x, area.min.y, area.width(), area.height());
+	Rect r = toPixels(area);
+	if(m_state.scissored) {
+		// Children which fill their parent leave the scissor as it is
+		r = m_state.scissor.clip(r);
+		r.max.x = std::max(r.max.x, r.min.x);
+		r.max.y = std::max(r.max.y, r.min.y);
+	}
+	m_state.scissor   = r;
+	m_state.scissored = true;
 	return *this;
 }
 Canvas& CanvasNVG::resetScissor() {
-	nvgResetScissor(m_context);
+	m_state.scissored = false;
 	return *this;
 }
 
 // Transform
 Canvas& CanvasNVG::resetTransform() {
-	nvgResetTransform(m_context);
+	m_state.sx = m_state.sy = 1;
+	m_state.tx = m_state.ty = 0;
 	return *this;
 }
 Canvas& CanvasNVG::translate(float x, float y) {
-	nvgTranslate(m_context, x, y);
+	m_state.tx += x * m_state.sx;
+	m_state.ty += y * m_state.sy;
 	return *this;
 }
 Canvas& CanvasNVG::scale    (float x, float y) {
-	nvgScale(m_context, x, y);
+	m_state.sx *= x;
+	m_state.sy *= y;
 	return *this;
 }
 
 // Properties
 Canvas& CanvasNVG::lineWidth(float f) {
-	nvgStrokeWidth(m_context, f);
+	m_state.line_width = f;
 	return *this;
 }
 Canvas& CanvasNVG::fillColor(Color const& color) {
-	nvgFillColor(m_context, nvgRGBAf(color.r, color.g, color.b, color.a));
+	m_state.fill = colorPaint(color);
 	return *this;
 }
 Canvas& CanvasNVG::fillTexture(Rect const& to, shared<Bitmap> const& bm, Color const& tint) {
-	NVGpaint paint = nvgImagePattern(m_context,
-		to.min.x, to.min.y, // Translation
-		to.width(), to.height(), // Scale
-		0, // rotation
-		getHandle(bm), // image
-		1 // alpha
-	);
-
+	NVGpaint paint = texturePaint(to, bm);
 	paint.innerColor = nvgRGBAf(tint.r, tint.g, tint.b, tint.a);
 
-	nvgFillPaint(m_context, paint);
+	m_state.fill = toPixels(paint);
 	return *this;
 }
 Canvas& CanvasNVG::strokeColor(Color const& color) {
-	nvgStrokeColor(m_context, nvgRGBAf(color.r, color.g, color.b, color.a));
+	m_state.stroke = colorPaint(color);
 	return *this;
 }
 Canvas& CanvasNVG::strokeTexture(Rect const& to, shared<Bitmap> const& bm, Color const& tint) {
-	nvgStrokePaint(m_context,
-		nvgImagePattern(m_context,
-			to.min.x, to.min.y, // Translation
-			to.width() / bm->width(), to.height() / bm->height(), // Scale
-			0, // rotation
-			getHandle(bm), // image
-			1 // alpha
-		)
-	);
+	NVGpaint paint = texturePaint(to, bm);
+	paint.innerColor = nvgRGBAf(tint.r, tint.g, tint.b, tint.a);
+
+	m_state.stroke = toPixels(paint);
 	return *this;
 }
 
 // Shapes
 Canvas& CanvasNVG::rect(Rect const& area) {
+	sync(0);
 	nvgRect(m_context, area.min.x, area.min.y, area.width(), area.height());
 	return *this;
 }
 Canvas& CanvasNVG::rect(Rect const& area, float radius) {
+	sync(0);
 	nvgRoundedRect(m_context, area.min.x, area.min.y, area.width(), area.height(), radius);
 	return *this;
 }
 Canvas& CanvasNVG::circle(Point const& center, float r) {
+	sync(0);
 	nvgCircle(m_context, center.x, center.y, r);
 	return *this;
 }
 Canvas& CanvasNVG::elipse(Point const& center, float rx, float ry) {
+	sync(0);
 	nvgEllipse(m_context, center.x, center.y, rx, ry);
 	return *this;
 }
@@ -169,6 +357,7 @@ Canvas& CanvasNVG::arc(
 	float from_angle, float to_angle,
 	bool counter_clockwise)
 {
+	sync(0);
 	nvgArc(m_context,
 		center.x, center.y, radius,
 		from_angle, to_angle,
@@ -179,10 +368,12 @@ Canvas& CanvasNVG::arc(
 
 // Path
 Canvas& CanvasNVG::moveTo(Point const& p) {
+	sync(0);
 	nvgMoveTo(m_context, p.x, p.y);
 	return *this;
 }
 Canvas& CanvasNVG::lineTo(Point const& p) {
+	sync(0);
 	nvgLineTo(m_context, p.x, p.y);
 	return *this;
 }
@@ -194,38 +385,41 @@ Canvas& CanvasNVG::registerFont(const char* name, const char* path) {
 }
 
 Canvas& CanvasNVG::font(const char* name) {
-	nvgFontFace(m_context, *name ? name : "sans");
+	m_state.font = nvgFindFont(m_context, *name ? name : "sans");
 	return *this;
 }
 Canvas& CanvasNVG::fontSize(float f) {
-	nvgFontSize(m_context, f != 0 ? f : 18);
+	m_state.font_size = f != 0 ? f : 18;
 	return *this;
 }
 Canvas& CanvasNVG::fontBlur(float f) {
-	nvgFontBlur(m_context, f);
+	m_state.font_blur = f;
 	return *this;
 }
 Canvas& CanvasNVG::fontLetterSpacing(float f) {
-	nvgTextLetterSpacing(m_context, f);
+	m_state.letter_spacing = f;
 	return *this;
 }
 Canvas& CanvasNVG::fontLineHeight(float f) {
-	nvgTextLineHeight(m_context, f);
+	m_state.line_height = f;
 	return *this;
 }
 
 Canvas& CanvasNVG::text(Point const& position, std::string_view txt) {
+	sync(SyncScissor | SyncFill | SyncFont);
 	nvgTextAlign(m_context, NVG_ALIGN_LEFT);
 	nvgText(m_context, position.x, position.y, txt.data(), txt.data() + txt.size());
 	return *this;
 }
 Canvas& CanvasNVG::textBox(Point const& position, float maxWidth, std::string_view txt) {
+	sync(SyncScissor | SyncFill | SyncFont);
 	nvgTextAlign(m_context, NVG_ALIGN_LEFT);
 	nvgTextBox(m_context, position.x, position.y, maxWidth, txt.data(), txt.data() + txt.size());
 	return *this;
 }
 
 Rect CanvasNVG::textBounds(Point const& position, std::string_view txt) {
+	sync(SyncFont);
 	float bounds[4];
 	nvgTextBounds(m_context, position.x, position.y, txt.data(), txt.data() + txt.size(), bounds);
 	return Rect::absolute(
@@ -234,6 +428,7 @@ Rect CanvasNVG::textBounds(Point const& position, std::string_view txt) {
 	);
 }
 Rect CanvasNVG::textBoxBounds(Point const& position, float maxWidth, std::string_view txt) {
+	sync(SyncFont);
 	float bounds[4];
 	nvgTextBoxBounds(m_context, position.x, position.y, maxWidth, txt.data(), txt.data() + txt.size(), bounds);
 	return Rect::absolute(
@@ -242,29 +437,166 @@ Rect CanvasNVG::textBoxBounds(Point const& position, float maxWidth, std::string
 	);
 }
 FontMetrics CanvasNVG::fontMetrics() {
+	sync(SyncFont);
 	FontMetrics metrics;
 	nvgTextMetrics(m_context, &metrics.ascend, &metrics.descend, &metrics.line_height);
 	return metrics;
 }
 
+void CanvasNVG::textBreakLines(std::string_view txt, float maxWidth, std::vector<uint32_t>& lineStarts) {
+	sync(SyncFont);
+	size_t first = lineStarts.size();
+
+	NVGtextRow  rows[64];
+	const char* start = txt.data();
+	const char* end   = txt.data() + txt.size();
+	while(start < end) {
+		int n = nvgTextBreakLines(m_context, start, end, maxWidth, rows, 64);
+		if(n <= 0) break;
+		for(int i = 0; i < n; i++)
+			lineStarts.push_back((uint32_t)(rows[i].start - txt.data()));
+		start = rows[n - 1].next;
+	}
+
+	// Leading whitespace belongs to the first line, nanovg skips it
+	if(lineStarts.size() == first) lineStarts.push_back(0);
+	lineStarts[first] = 0;
+}
+
 // Commit
 Canvas& CanvasNVG::fill() {
+	sync(SyncScissor | SyncFill);
 	nvgFill(m_context);
 	nvgBeginPath(m_context);
 	return *this;
 }
 Canvas& CanvasNVG::fillPreserve() {
+	sync(SyncScissor | SyncFill);
 	nvgFill(m_context);
 	return *this;
 }
 Canvas& CanvasNVG::stroke() {
+	sync(SyncScissor | SyncStroke);
 	nvgStroke(m_context);
 	nvgBeginPath(m_context);
 	return *this;
 }
 Canvas& CanvasNVG::strokePreserve() {
+	sync(SyncScissor | SyncStroke);
 	nvgStroke(m_context);
 	return *this;
 }
 
+// Batches
+Canvas& CanvasNVG::rects(Rect const* areas, Color const* colors, size_t count) {
+	size_t i = 0;
+	while(i < count) {
+		// Each run of the same color is one path, and so one draw call
+		size_t end = i + 1;
+		if(colors) {
+			while(end < count && sameColor(colors[end], colors[i])) end++;
+			m_state.fill = colorPaint(colors[i]);
+		}
+		else {
+			end = count;
+		}
+
+		sync(SyncScissor | SyncFill);
+		for(; i < end; i++)
+			nvgRect(m_context, areas[i].min.x, areas[i].min.y, areas[i].width(), areas[i].height());
+		nvgFill(m_context);
+		nvgBeginPath(m_context);
+	}
+	return *this;
+}
+Canvas& CanvasNVG::polyline(Point const* points, size_t count) {
+	if(count < 2) return *this;
+
+	sync(SyncScissor | SyncStroke);
+	nvgMoveTo(m_context, points[0].x, points[0].y);
+	for(size_t i = 1; i < count; i++)
+		nvgLineTo(m_context, points[i].x, points[i].y);
+	nvgStroke(m_context);
+	nvgBeginPath(m_context);
+	return *this;
+}
+Canvas& CanvasNVG::texturedQuads(shared<Bitmap> const& bm, TexturedQuad const* quads, size_t count, Color const& tint) {
+	float w = bm->width(), h = bm->height();
+
+	size_t i = 0;
+	while(i < count) {
+		// Quads which map the bitmap the same way, like the tiles of a nine-patch, share one paint
+		Rect   mapping = quads[i].mapping(w, h);
+		size_t end     = i + 1;
+		while(end < count && sameRect(quads[end].mapping(w, h), mapping)) end++;
+
+		NVGpaint paint = texturePaint(mapping, bm);
+		paint.innerColor = nvgRGBAf(tint.r, tint.g, tint.b, tint.a);
+		m_state.fill = toPixels(paint);
+		sync(SyncScissor | SyncFill);
+
+		for(; i < end; i++)
+			nvgRect(m_context, quads[i].to.min.x, quads[i].to.min.y, quads[i].to.width(), quads[i].to.height());
+		nvgFill(m_context);
+		nvgBeginPath(m_context);
+	}
+	return *this;
+}
+Canvas& CanvasNVG::glyphRuns(GlyphRun const* runs, size_t count) {
+	sync(SyncScissor | SyncFill | SyncFont);
+	nvgTextAlign(m_context, NVG_ALIGN_LEFT);
+	for(size_t i = 0; i < count; i++) {
+		auto& txt = runs[i].text;
+		nvgText(m_context, runs[i].position.x, runs[i].position.y, txt.data(), txt.data() + txt.size());
+	}
+	return *this;
+}
+
+// Layers
+bool CanvasNVG::beginLayer(Layer& layer, unsigned width, unsigned height) {
+	if(!m_offscreen.create || m_layer || width == 0 || height == 0) return false;
+
+	shared<LayerTarget> target = layer.handle.cast_static<LayerTarget>();
+	if(!target || layer.width != width || layer.height != height) {
+		layer = {}; // Free the old target first
+		target = make_shared<LayerTarget>();
+		target->target = m_offscreen.create(m_context, width, height, &target->image);
+		if(!target->target) return false;
+		target->destroy = m_offscreen.destroy;
+
+		layer.handle = target.cast_static<void>();
+		layer.width  = width;
+		layer.height = height;
+	}
+
+	m_layer = target.get();
+	m_offscreen.begin(m_layer->target, width, height);
+	nvgBeginFrame(m_context, width, height, 1);
+	m_state = m_applied = defaultState();
+	m_states.clear();
+	return true;
+}
+Canvas& CanvasNVG::endLayer() {
+	if(!m_layer) return *this;
+	uploadAtlas();
+	nvgEndFrame(m_context);
+	m_offscreen.end(m_layer->target);
+	m_layer = nullptr;
+	return *this;
+}
+Canvas& CanvasNVG::drawLayer(Layer const& layer, Rect const& to) {
+	auto* target = (LayerTarget const*) layer.handle.get();
+	if(!target) return *this;
+
+	NVGpaint fill = m_state.fill;
+	m_state.fill = toPixels(nvgImagePattern(m_context, to.min.x, to.min.y, to.width(), to.height(), 0, target->image, 1));
+	sync(SyncScissor | SyncFill);
+	nvgBeginPath(m_context);
+	nvgRect(m_context, to.min.x, to.min.y, to.width(), to.height());
+	nvgFill(m_context);
+	nvgBeginPath(m_context);
+	m_state.fill = fill;
+	return *this;
+}
+
 } // namespace wwidget
@@ -2,8 +2,10 @@
 
 #include "Attributes.hpp"
 #include "Canvas.hpp"
+#include "TextureAtlas.hpp"
 
 #include <memory>
+#include <vector>
 
 extern "C" {
 	#include <nanovg.h>
@@ -14,16 +16,94 @@ namespace wwidget {
 class Bitmap;
 
 class CanvasNVG final : public Canvas {
+public:
+	/// Offscreen render targets, which nanovg leaves to its backends (see nanovg_gl_utils.h). Without them there are no layers.
+	struct Offscreen {
+		void* (*create)(NVGcontext* ctx, unsigned width, unsigned height, int* image) = nullptr; //!< nullptr on failure, image is the nanovg image which is rendered into
+		void  (*begin)(void* target, unsigned width, unsigned height) = nullptr; //!< Binds and clears the target
+		void  (*end)(void* target) = nullptr; //!< Binds whatever was bound before begin()
+		void  (*destroy)(void* target) = nullptr;
+	};
+
+private:
 	using PFNContextClose = void(*)(NVGcontext*);
 
 	NVGcontext* m_context;
 	PFNContextClose m_close_ctxt;
 
-	int getHandle(shared<Bitmap> const& bm);
+	/// A bitmap's texture: either its own nanovg image or a region of an atlas page. Stored in Bitmap::mRendererProxy.
+	struct Texture {
+		int                  image;
+		TextureAtlas::Region region; //!< Empty if the bitmap has its own image
+	};
+
+	struct AtlasPage {
+		int      image = 0; //!< 0 if the page was evicted
+		unsigned dirty_min_x, dirty_min_y, dirty_max_x, dirty_max_y; //!< Area which has to be uploaded in endFrame()
+		bool     dirty = false;
+	};
+
+	/// The state is tracked here and only applied to nanovg right before something is drawn or measured,
+	///  so pushState()/popState() never reach nanovg and can be nested as deep as the widget tree is.
+	///  The transform can only translate and scale, which keeps scissors axis aligned and in pixels.
+	struct State {
+		float    sx = 1, sy = 1, tx = 0, ty = 0;
+		Rect     scissor;        //!< In pixels, only used if scissored
+		bool     scissored = false;
+		NVGpaint fill, stroke;   //!< In pixels, like nanovg stores them
+		float    line_width     = 1;
+		int      font           = 0;
+		float    font_size      = 16;
+		float    font_blur      = 0;
+		float    letter_spacing = 0;
+		float    line_height    = 1;
+	};
+	enum SyncFlags {
+		SyncScissor = 1,
+		SyncFill    = 2,
+		SyncStroke  = 4, //!< Paint and line width
+		SyncFont    = 8
+	};
+
+	State              m_state;
+	State              m_applied; //!< What nanovg uses right now
+	std::vector<State> m_states;
+
+	State    defaultState() const noexcept; //!< Same as nvgReset()
+	void     sync(unsigned flags); //!< Applies the transform and the flagged parts of m_state
+	Rect     toPixels(Rect const& r) const noexcept;
+	NVGpaint toPixels(NVGpaint paint) const noexcept;
+
+	TextureAtlas           m_atlas;
+	std::vector<AtlasPage> m_atlas_pages;
+	bool                   m_use_atlas = true;
+
+	/// The handle of a Layer
+	struct LayerTarget {
+		void* target  = nullptr;
+		int   image   = 0;
+		void  (*destroy)(void* target) = nullptr;
+
+		~LayerTarget() { if(target) destroy(target); }
+	};
+	Offscreen    m_offscreen;
+	LayerTarget* m_layer = nullptr; //!< Drawn into right now
+
+	void uploadAtlas();
+
+	Texture const& getHandle(shared<Bitmap> const& bm);
+	NVGpaint       texturePaint(Rect const& to, shared<Bitmap> const& bm);
 public:
 	CanvasNVG(NVGcontext* ctxt, PFNContextClose close_ctxt = nullptr);
 	~CanvasNVG();
 
+	/// Whether small bitmaps are packed into shared atlas pages (the default). Affects bitmaps drawn for the first time.
+	void useAtlas(bool b) noexcept { m_use_atlas = b; }
+	bool useAtlas() const noexcept { return m_use_atlas; }
+
+	void             offscreen(Offscreen const& o) noexcept { m_offscreen = o; }
+	Offscreen const& offscreen() const noexcept { return m_offscreen; }
+
 	// Frame
 	Canvas& beginFrame(Size const& frame_size, float dpi) override;
 	Canvas& endFrame() override;
@@ -84,12 +164,24 @@ public:
 	Rect textBounds(Point const& position, std::string_view txt) override;
 	Rect textBoxBounds(Point const& position, float maxWidth, std::string_view txt) override;
 	FontMetrics fontMetrics() override;
+	void        textBreakLines(std::string_view txt, float maxWidth, std::vector<uint32_t>& lineStarts) override;
 
 	// Commit
 	Canvas& fill() override;
 	Canvas& fillPreserve() override; //!< Fill, but don't reset path
 	Canvas& stroke() override;
 	Canvas& strokePreserve() override; //!< Stroke, but don't reset path
+
+	// Batches: consecutive rects of the same color and quads with the same mapping are filled at once
+	Canvas& rects(Rect const* areas, Color const* colors, size_t count) override;
+	Canvas& polyline(Point const* points, size_t count) override;
+	Canvas& texturedQuads(shared<Bitmap> const& bm, TexturedQuad const* quads, size_t count, Color const& tint = Color::white()) override;
+	Canvas& glyphRuns(GlyphRun const* runs, size_t count) override;
+
+	// Layers: only if offscreen() targets are set. Each layer is its own nanovg frame.
+	bool    beginLayer(Layer& layer, unsigned width, unsigned height) override;
+	Canvas& endLayer() override;
+	Canvas& drawLayer(Layer const& layer, Rect const& to) override;
 };
 
 } // namespace wwidget
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "Attributes.hpp"
+#include "Canvas.hpp"
+
+#include <string>
+#include <unordered_map>
+
+namespace wwidget {
+
+/// A canvas which draws nothing, but records what was drawn. For tests and benchmarks without a window.
+///  Every call is appended to log() as one line of text, so frames can be compared with golden files and diffed.
+///  The calls of each frame are also counted, see FrameStats.
+///  Text is measured as if every character was fontSize/2 wide, with an ascend of 3/4 and a descend of 1/4 of the font size,
+///  so layouts don't depend on the fonts which are installed.
+class CanvasRecorder final : public Canvas {
+public:
+	struct FrameStats {
+		size_t commands     = 0; //!< All calls, including the ones below
+		size_t statePushes  = 0;
+		size_t scissors     = 0; //!< scissor and scissorIntersect
+		size_t fills        = 0; //!< fill, fillPreserve, rects, texturedQuads and drawLayer
+		size_t strokes      = 0; //!< stroke, strokePreserve and polyline
+		size_t textRuns     = 0; //!< text, textBox and glyphRuns
+		size_t textureBinds = 0; //!< Fills and strokes which use a different texture than the one before
+	};
+
+private:
+	std::string mLog;
+	bool        mRecordLog;
+
+	FrameStats  mCurrent;
+	FrameStats  mLast;
+	size_t      mFrames;
+	size_t      mMeasurements;
+
+	Bitmap const* mFillTexture;
+	Bitmap const* mStrokeTexture;
+	void const*   mBoundTexture; //!< A Bitmap or the handle of a Layer
+	std::unordered_map<Bitmap const*, size_t> mTextureIds; //!< Textures are logged by the order they were first used in
+
+	float mFontSize;
+	float mLetterSpacing;
+	float mLineHeight;
+
+	size_t mLayers; //!< Layers are logged by the order they were created in
+
+	bool   begin(const char* cmd, std::initializer_list<float> args); //!< Counts the command, starts its line if the log is recorded
+	void   append(std::initializer_list<float> args);
+	void   append(std::string_view txt); //!< Quoted and escaped
+	void   append(Color const& color);
+	void   append(Bitmap const* bm);
+	void   record(const char* cmd, std::initializer_list<float> args = {});
+	void   record(const char* cmd, std::initializer_list<float> args, std::string_view txt);
+	void   record(const char* cmd, Color const& color);
+	void   record(const char* cmd, Rect const& to, Bitmap const* bm, Color const& tint);
+	void   bind(void const* texture);
+	float  advance(std::string_view txt) const noexcept;
+public:
+	CanvasRecorder();
+	~CanvasRecorder();
+
+	/// Whether calls are written to log(), true by default. Counting works either way.
+	void recordLog(bool b) noexcept { mRecordLog = b; }
+	bool recordLog() const noexcept { return mRecordLog; }
+
+	/// The calls since the last beginFrame(), one per line
+	std::string const& log() const noexcept { return mLog; }
+
+	FrameStats const& frameStats() const noexcept { return mLast; }    //!< Of the last frame which ended
+	FrameStats const& currentStats() const noexcept { return mCurrent; } //!< Since the last beginFrame()
+	size_t            frames() const noexcept { return mFrames; }       //!< Frames which ended
+	size_t            measurements() const noexcept { return mMeasurements; } //!< Text and font queries, in and outside of frames
+
+	// Frame
+	Canvas& beginFrame(Size const& frame_size, float dpi) override;
+	Canvas& endFrame() override;
+	Canvas& cancelFrame() override;
+
+	// State
+	Canvas& pushState() override;
+	Canvas& popState() override;
+	Canvas& resetState() override;
+
+	// Scissor
+	Canvas& scissor(Rect const& area) override;
+	Canvas& scissorIntersect(Rect const& area) override;
+	Canvas& resetScissor() override;
+
+	// Transform
+	Canvas& resetTransform() override;
+	Canvas& translate(float x, float y) override;
+	Canvas& scale    (float x, float y) override;
+
+	// Properties
+	Canvas& lineWidth(float f) override;
+	Canvas& fillColor(Color const& color) override;
+	Canvas& fillTexture(
+		Rect const& to,
+		shared<Bitmap> const& bm,
+		Color const& tint = Color::white()) override;
+	Canvas& strokeColor(Color const& color) override;
+	Canvas& strokeTexture(
+		Rect const& to,
+		shared<Bitmap> const& bm,
+		Color const& tint = Color::white()) override;
+
+	// Shapes
+	Canvas& rect(Rect const& area) override;
+	Canvas& rect(Rect const& area, float radius) override;
+	Canvas& circle(Point const& center, float f) override;
+	Canvas& elipse(Point const& center, float rx, float ry) override;
+	Canvas& arc(Point const& center, float radius, float from_angle, float to_angle, bool counter_clockwise = false) override;
+
+	// Path
+	Canvas& moveTo(Point const& p) override;
+	Canvas& lineTo(Point const& p) override;
+
+	// Text
+	Canvas& registerFont(const char* name, const char* path) override;
+
+	Canvas& font(const char* name) override;
+	Canvas& fontSize(float f) override;
+	Canvas& fontBlur(float f) override;
+	Canvas& fontLetterSpacing(float f) override;
+	Canvas& fontLineHeight(float f) override;
+
+	Canvas& text(Point const& position, std::string_view txt) override;
+	Canvas& textBox(Point const& position, float maxWidth, std::string_view txt) override;
+
+	// Text & Font queries
+	Rect textBounds(Point const& position, std::string_view txt) override;
+	Rect textBoxBounds(Point const& position, float maxWidth, std::string_view txt) override;
+	FontMetrics fontMetrics() override;
+
+	// Commit
+	Canvas& fill() override;
+	Canvas& fillPreserve() override; //!< Fill, but don't reset path
+	Canvas& stroke() override;
+	Canvas& strokePreserve() override; //!< Stroke, but don't reset path
+
+	// Batches: count as one fill, stroke or text run. Every primitive is logged on an indented line after the call.
+	Canvas& rects(Rect const* areas, Color const* colors, size_t count) override;
+	Canvas& polyline(Point const* points, size_t count) override;
+	Canvas& texturedQuads(shared<Bitmap> const& bm, TexturedQuad const* quads, size_t count, Color const& tint = Color::white()) override;
+	Canvas& glyphRuns(GlyphRun const* runs, size_t count) override;
+
+	// Layers: nothing is stored, layers are drawn before the frame so they aren't part of its log and counts
+	bool    beginLayer(Layer& layer, unsigned width, unsigned height) override;
+	Canvas& endLayer() override;
+	Canvas& drawLayer(Layer const& layer, Rect const& to) override;
+};
+
+} // namespace wwidget
@@ -0,0 +1,180 @@
+#pragma once
+
+#include "Attributes.hpp"
+#include "Bitmap.hpp"
+#include "Canvas.hpp"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace wwidget {
+
+class Font;
+
+/// Renders into a Bitmap on the CPU, for machines without a GPU and for rendering on other threads.
+///  Paths are flattened to polygons and rasterized with exact area coverage (anti-aliased, nonzero winding),
+///  rows are blended with SSE2 where it's available. Text is drawn from the signed distance field atlas of wwidget::Font.
+///  The bitmap is RGBA with premultiplied alpha. Frame sizes are in pixels, dpi and fontBlur are ignored.
+class CanvasSoftware final : public Canvas {
+public:
+	struct Counters {
+		size_t primitives = 0; //!< Fills, strokes and texts
+		size_t pixels     = 0; //!< Pixels blended, including partially covered ones
+	};
+
+private:
+	struct Transform {
+		float sx = 1, sy = 1, tx = 0, ty = 0;
+
+		Point apply(Point const& p) const noexcept { return { p.x * sx + tx, p.y * sy + ty }; }
+	};
+	struct Paint {
+		Color          color = Color::black(); //!< The tint if there's a texture
+		shared<Bitmap> texture;
+		Rect           to; //!< Where the texture is mapped to, in pixels
+		bool           premultiplied = false; //!< Layers are, other textures aren't
+	};
+	struct State {
+		Transform   transform;
+		Rect        scissor; //!< In pixels
+		Paint       fill, stroke;
+		float       lineWidth     = 1;
+		std::string font          = "sans";
+		float       fontSize      = 18;
+		float       letterSpacing = 0;
+		float       lineHeight    = 1;
+	};
+	struct SubPath {
+		size_t first, count;
+		bool   closed;
+	};
+
+	Bitmap             mTarget;
+	shared<Bitmap>     mLayerTarget; //!< Holds the frame while a layer is drawn into mTarget
+	State              mState;
+	std::vector<State> mStates;
+
+	std::vector<Point>   mPoints; //!< Flattened path in pixels
+	std::vector<SubPath> mSubPaths;
+
+	std::unordered_map<std::string, shared<Font>> mFonts; //!< nullptr if loading the font failed
+	std::unordered_map<std::string, std::string>  mFontFiles; //!< Fonts are loaded when they're first used
+
+	// Scratch buffers of the rasterizer
+	std::vector<Point>   mPolygons;
+	std::vector<SubPath> mPolygonParts;
+	std::vector<float>   mAccumulation;
+	std::vector<uint8_t> mCoverage;
+
+	Counters mCounters;
+
+	Rect  frameRect() const noexcept;
+	Rect  transformed(Rect const& r) const noexcept; //!< Bounding box of r in pixels
+	Font* currentFont();
+	void  addPoint(Point const& devicePoint, bool newSubPath);
+	void  addEllipse(Point const& center, float rx, float ry, float from, float to, bool ccw, bool connect);
+	void  closeSubPath();
+	void  clearPath();
+
+	void  strokeToPolygons(float width);
+	void  rasterize(std::vector<Point> const& points, std::vector<SubPath> const& parts, Paint const& paint);
+	void  fillAligned(Rect const& area, Paint const& paint); //!< Same as rasterizing a rect, but without the accumulation buffer
+	void  accumulateLine(Point p0, Point p1, int width, int height);
+	void  blendRow(uint32_t* dst, uint8_t const* coverage, int x, int y, int n, Paint const& paint);
+	void  drawText(Point const& pen, std::string_view txt);
+	float advanceOf(std::string_view txt);
+
+public:
+	CanvasSoftware();
+	~CanvasSoftware();
+
+	/// The rendered frame, valid after endFrame() and until the next beginFrame()
+	Bitmap const& bitmap() const noexcept { return mTarget; }
+	Bitmap&       bitmap() noexcept { return mTarget; }
+
+	Counters const& counters() const noexcept { return mCounters; }
+	void            resetCounters() noexcept { mCounters = {}; }
+
+	// Frame
+	Canvas& beginFrame(Size const& frame_size, float dpi) override;
+	Canvas& endFrame() override;
+	Canvas& cancelFrame() override;
+
+	// State
+	Canvas& pushState() override;
+	Canvas& popState() override;
+	Canvas& resetState() override;
+
+	// Scissor
+	Canvas& scissor(Rect const& area) override;
+	Canvas& scissorIntersect(Rect const& area) override;
+	Canvas& resetScissor() override;
+
+	// Transform
+	Canvas& resetTransform() override;
+	Canvas& translate(float x, float y) override;
+	Canvas& scale    (float x, float y) override;
+
+	// Properties
+	Canvas& lineWidth(float f) override;
+	Canvas& fillColor(Color const& color) override;
+	Canvas& fillTexture(
+		Rect const& to,
+		shared<Bitmap> const& bm,
+		Color const& tint = Color::white()) override;
+	Canvas& strokeColor(Color const& color) override;
+	Canvas& strokeTexture(
+		Rect const& to,
+		shared<Bitmap> const& bm,
+		Color const& tint = Color::white()) override;
+
+	// Shapes
+	Canvas& rect(Rect const& area) override;
+	Canvas& rect(Rect const& area, float radius) override;
+	Canvas& circle(Point const& center, float f) override;
+	Canvas& elipse(Point const& center, float rx, float ry) override;
+	Canvas& arc(Point const& center, float radius, float from_angle, float to_angle, bool counter_clockwise = false) override;
+
+	// Path
+	Canvas& moveTo(Point const& p) override;
+	Canvas& lineTo(Point const& p) override;
+
+	// Text
+	Canvas& registerFont(const char* name, const char* path) override;
+	/// Uses an already loaded font, e.g. one which is shared with other canvases
+	Canvas& registerFont(const char* name, shared<Font> font);
+
+	Canvas& font(const char* name) override;
+	Canvas& fontSize(float f) override;
+	Canvas& fontBlur(float f) override;
+	Canvas& fontLetterSpacing(float f) override;
+	Canvas& fontLineHeight(float f) override;
+
+	Canvas& text(Point const& position, std::string_view txt) override;
+	Canvas& textBox(Point const& position, float maxWidth, std::string_view txt) override;
+
+	// Text & Font queries
+	Rect textBounds(Point const& position, std::string_view txt) override;
+	Rect textBoxBounds(Point const& position, float maxWidth, std::string_view txt) override;
+	FontMetrics fontMetrics() override;
+
+	// Commit
+	Canvas& fill() override;
+	Canvas& fillPreserve() override; //!< Fill, but don't reset path
+	Canvas& stroke() override;
+	Canvas& strokePreserve() override; //!< Stroke, but don't reset path
+
+	// Batches: rects stay axis aligned, so they are blended directly with their exact coverage
+	Canvas& rects(Rect const* areas, Color const* colors, size_t count) override;
+	Canvas& polyline(Point const* points, size_t count) override;
+	Canvas& texturedQuads(shared<Bitmap> const& bm, TexturedQuad const* quads, size_t count, Color const& tint = Color::white()) override;
+	Canvas& glyphRuns(GlyphRun const* runs, size_t count) override;
+
+	// Layers: Bitmaps with premultiplied alpha
+	bool    beginLayer(Layer& layer, unsigned width, unsigned height) override;
+	Canvas& endLayer() override;
+	Canvas& drawLayer(Layer const& layer, Rect const& to) override;
+};
+
+} // namespace wwidget
@@ -2,9 +2,14 @@
 
 #include "Widget.hpp"
 
+#include <chrono>
+
 namespace wwidget {
 
 class Font;
+class TextMetricsCache;
+class LayerCache;
+class InputQueue;
 
 enum RessourceId {
 	URL_ROOT,
@@ -19,16 +24,32 @@ enum RessourceId {
 	URL_CONFIG_DIR,
 };
 
+/// Order in which deferred tasks are executed by Context::update()
+enum class TaskPriority {
+	Input,      //!< Reactions to user input (click callbacks, text edits). Always executed in the same frame.
+	Layout,     //!< Tasks that change the widget tree or its layout. The default.
+	Background, //!< Completions of background work, e.g. loaded images. Spread over several frames when there are many.
+};
+constexpr size_t TaskPriorityCount = 3;
+
 class Context {
 public:
+	using Clock = std::chrono::steady_clock;
+
 	Context();
 	virtual ~Context();
 
 	virtual void defer(std::function<void()>) = 0;
+	virtual void defer(TaskPriority, std::function<void()>); //<! Defaults to defer(fn), i.e. ignores the priority
+	virtual void wakeup(); //<! Interrupts a blocking wait for events, e.g. when work was deferred from another thread. Thread safe.
+	virtual void requestFrame(Clock::time_point when = Clock::now()); //<! Makes sure a frame is drawn at `when` at the latest, e.g. for the next step of an animation. Ignored by default.
 
 	virtual std::string getRessource(RessourceId res);
 
 	virtual Canvas& canvas() const noexcept = 0;
+	virtual TextMetricsCache& textMetrics() noexcept = 0; //<! Measurements of text drawn on canvas()
+	virtual LayerCache&       layers() noexcept = 0; //<! Layers of the widgets which are cached as one, drawn on canvas()
+	virtual InputQueue&       input() noexcept = 0; //<! Input which is dispatched by the next update(), and the hover path
 
 	virtual shared<Bitmap> loadImage(std::string const& url) = 0;
 	virtual void           loadImage(
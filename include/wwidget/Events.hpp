@@ -13,6 +13,8 @@ struct Mouse {
 };
 
 struct Event {
+	constexpr static inline unsigned AllHandlerBits = (1 << 6) - 1; //!< The handlerBit of every event type, see Widget::handles()
+
 	enum State {
 		UP,
 		DOWN,
@@ -27,7 +29,8 @@ struct Event {
 
 	mutable Point          position;
 	mutable bool           handled = false;
-	mutable PropagationDir direction;
+	mutable PropagationDir direction = DIR_UP_AND_DOWN;
+	double                 time = 0; //!< When it happened in seconds, e.g. glfwGetTime(). 0 if unknown.
 
 	bool downwards() const noexcept { return direction >= 0; }
 	bool upwards()   const noexcept { return direction <= 0; }
@@ -35,9 +38,10 @@ struct Event {
 
 struct Click : public Event {
 	constexpr static inline bool positional = true;
+	constexpr static inline unsigned handlerBit = 1 << 0;
 
-	int   button;
-	State state;
+	int   button = 0;
+	State state  = UP;
 
 	bool down() const noexcept { return state != UP; }
 	bool up() const noexcept { return state == UP; }
@@ -46,34 +50,54 @@ struct Click : public Event {
 
 struct Scroll : public Event {
 	constexpr static inline bool positional = true;
+	constexpr static inline unsigned handlerBit = 1 << 1;
 
-	float pixels_x, pixels_y;
-	float clicks_x, clicks_y;
+	float pixels_x = 0, pixels_y = 0;
+	float clicks_x = 0, clicks_y = 0;
 };
 
 struct Moved : public Event {
 	constexpr static inline bool positional = true;
+	constexpr static inline unsigned handlerBit = 1 << 2;
 
-	float old_x;
-	float old_y;
-	float moved_x;
-	float moved_y;
+	float old_x   = 0;
+	float old_y   = 0;
+	float moved_x = 0;
+	float moved_y = 0;
 	std::bitset<5> buttons;
+
+	/// With InputQueue::keepPaths(): every position the pointer passed since the last motion event, oldest first, ending with position.
+	///  In the coordinates of the widget the event was sent to first, i.e. usually the window. Only valid while the event is dispatched.
+	Point const* path       = nullptr;
+	size_t       pathLength = 0;
+};
+
+struct Dragged : public Moved {
+	constexpr static inline unsigned handlerBit = 1 << 3;
 };
 
-struct Dragged : public Moved {};
+/// Sent to a widget when the pointer moves onto it (Enter) or off it (Leave), @see Widget::hovered().
+///  Sent to every widget on the hover path whose state changes, they're not propagated.
+struct Enter : public Event {
+	constexpr static inline bool positional = false;
+};
+struct Leave : public Event {
+	constexpr static inline bool positional = false;
+};
 
 struct KeyEvent : public Event {
 	constexpr static inline bool positional = false;
+	constexpr static inline unsigned handlerBit = 1 << 4;
 
-	int   mods;
-	int   key;
-	int   scancode;
-	State state;
+	int   mods     = 0;
+	int   key      = 0;
+	int   scancode = 0;
+	State state    = UP;
 };
 
 struct TextInput : public Event {
 	constexpr static inline bool positional = false;
+	constexpr static inline unsigned handlerBit = 1 << 5;
 
 	int      mods    = 0;
 	uint32_t utf32   = 0;
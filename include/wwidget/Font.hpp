@@ -1,53 +1,97 @@
 #pragma once
 
-#include <memory.h>
+#include "Bitmap.hpp"
+
+#include <cstdint>
 #include <memory>
+#include <string>
 #include <unordered_map>
+#include <vector>
 
 namespace wwidget {
 
-class Bitmap;
-class BitmapFont;
-class FontDescription;
-
-/// A font which can generate and cache bitmap fonts
+/// A TrueType font face which renders its glyphs as signed distance fields into one atlas.
+///  Every glyph is rasterized once at sdfSize() pixels, no matter at how many sizes it's drawn:
+///  quads are scaled to the font size and the renderer thresholds the distance at edge().
+///  Glyphs are added to the atlas when they're first requested. The atlas grows up to maxAtlasSize(),
+///  when that is full it's cleared and generation() changes, so glyphs have to be requested again.
 class Font {
-	template<typename... ARGS>
-	using umap = std::unordered_map<ARGS...>;
-
-	template<typename T>
-	using wptr = weak<T>;
-
-	struct FontInfo {
-		float size, dpix, dpiy;
+public:
+	struct Glyph {
+		float    advance = 0;              //!< Multiply with the font size
+		float    x0 = 0, y0 = 0;           //!< Quad relative to the pen position on the baseline (y down), multiply with the font size
+		float    x1 = 0, y1 = 0;
+		unsigned x = 0, y = 0;             //!< Position of the distance field on atlas()
+		unsigned width = 0, height = 0;    //!< 0 for glyphs without outline, e.g. spaces
 
-		bool operator==(FontInfo const& other) const noexcept {
-			return memcmp(this, &other, sizeof(FontInfo)) == 0;
-		}
+		explicit operator bool() const noexcept { return width > 0 && height > 0; }
+	};
 
-		struct hash {
-			size_t operator()(FontInfo const& info) const noexcept;
-		};
+	struct Stats {
+		size_t glyphs     = 0; //!< Glyphs in the atlas
+		size_t rasterized = 0; //!< Distance fields which were generated
+		size_t resets     = 0; //!< How often the atlas was full and had to be cleared
 	};
 
-	struct Entry {
-		shared<BitmapFont> mFont;
-		shared<Bitmap>     mFontBitmap;
+private:
+	struct Face;
+	struct Shelf {
+		unsigned y, height, used;
 	};
 
-	shared<FontDescription> mFontDescription;
-	umap<FontInfo, wptr<BitmapFont>, FontInfo::hash> mCache;
+	std::vector<uint8_t>                  mData; //!< The font file, stb_truetype reads from it directly
+	std::unique_ptr<Face>                 mFace;
+	unsigned                              mSdfSize;
+	unsigned                              mSpread;
+	unsigned                              mMaxAtlasSize;
+
+	Bitmap                                mAtlas;
+	std::vector<Shelf>                    mShelves;
+	std::unordered_map<uint32_t, Glyph>   mGlyphs;
+	unsigned                              mGeneration;
+	Stats                                 mStats;
+
+	bool allocate(unsigned w, unsigned h, unsigned& x, unsigned& y);
+	void growAtlas(unsigned size);
+	void rasterize(uint32_t codepoint, Glyph& g);
 public:
-	Font();
+	/// @param sdfSize Pixel height glyphs are rasterized with
+	/// @param spread Distance in pixels from the outline at which the field reaches 0 or 255
+	Font(unsigned sdfSize = 48, unsigned spread = 6, unsigned maxAtlasSize = 1024);
 	Font(std::string const& path);
-	Font(shared<FontDescription> const& fnt);
+	~Font();
+
+	Font(Font const&) = delete;
+	Font& operator=(Font const&) = delete;
 
+	/// Throws exceptions::FailedLoadingFile
 	void load(std::string const& path);
-	void init(shared<FontDescription> const& fnt);
+	void load(std::vector<uint8_t> data);
+	bool loaded() const noexcept { return (bool) mFace; }
+
+	/// Returns the glyph, rasterizing it into the atlas if it isn't in there yet.
+	/// The reference is invalidated by the next call to glyph().
+	Glyph const& glyph(uint32_t codepoint);
+	float        kerning(uint32_t left, uint32_t right) const; //!< Multiply with the font size
+
+	float ascent() const noexcept;  //!< Multiply with the font size
+	float descent() const noexcept; //!< Negative, multiply with the font size
+	float lineGap() const noexcept; //!< Multiply with the font size
+
+	/// An ALPHA bitmap, 255 is inside the glyph, edge() is on the outline.
+	/// Its mRendererProxy is reset whenever glyphs are added.
+	Bitmap const& atlas() const noexcept { return mAtlas; }
+	unsigned      generation() const noexcept { return mGeneration; } //!< Changes when the atlas is cleared
+	static constexpr float edge() noexcept { return .5f; }
 
-	shared<BitmapFont> get(float size, float dpix = 0, float dpiy = 0);
+	unsigned sdfSize() const noexcept { return mSdfSize; }
+	unsigned spread() const noexcept { return mSpread; }
+	unsigned maxAtlasSize() const noexcept { return mMaxAtlasSize; }
+	size_t   memoryUsage() const noexcept; //!< Bytes used by the atlas and the glyph table
+	Stats const& stats() const noexcept { return mStats; }
 
-	shared<FontDescription> const& fontDescription() const noexcept { return mFontDescription; }
+	/// Drops all glyphs, they are rasterized again when requested
+	void clear();
 };
 
 } // namespace wwidget
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Events.hpp"
+
+#include <variant>
+#include <vector>
+
+namespace wwidget {
+
+class Widget;
+
+/// Collects input as it arrives and dispatches it once per frame, see BasicContext::update().
+///  Consecutive motion events (Moved, or Dragged with the same buttons) are coalesced into one,
+///  so a 1000Hz mouse doesn't dispatch through the widget tree more than once per frame.
+///  Clicks, scrolls, keys and text input are never coalesced and keep their order relative to motion.
+///  Motion also updates the hover path: the widgets under the pointer, see Widget::hovered(), Enter and Leave.
+///  Not thread safe: filled by the window's callbacks on the thread which updates the widgets.
+class InputQueue {
+public:
+	struct Counters {
+		size_t received   = 0; //!< Events pushed
+		size_t coalesced  = 0; //!< Motion events which were merged into the one before
+		size_t dispatched = 0; //!< Events sent to widgets
+		size_t hitTests   = 0; //!< Children tested for whether they're under the pointer, below the part of the hover path which was kept
+	};
+
+private:
+	using AnyEvent = std::variant<Click, Scroll, Moved, Dragged, KeyEvent, TextInput>;
+
+	struct Entry {
+		AnyEvent event;
+		size_t   pathBegin; //!< Into mPaths, for motion events with keepPaths()
+	};
+
+	std::vector<Entry> mEntries;
+	std::vector<Point> mPaths;
+	bool               mKeepPaths;
+	Counters           mCounters;
+
+	std::vector<Widget*> mHoverPath; //!< From the root to the widget under the pointer
+
+	template<class T> void pushMotion(T const& motion);
+	void hover(Widget& root, Point const& position);
+public:
+	InputQueue();
+	~InputQueue();
+
+	void push(Click     const& e);
+	void push(Scroll    const& e);
+	void push(Moved     const& e);
+	void push(Dragged   const& e);
+	void push(KeyEvent  const& e);
+	void push(TextInput const& e);
+
+	/// Sends the queued events to root in the order they arrived and clears the queue. Returns how many were sent.
+	///  Events pushed by the handlers stay queued for the next dispatch().
+	size_t dispatch(Widget& root);
+	void   clear() noexcept;
+
+	size_t size() const noexcept { return mEntries.size(); }
+	bool   empty() const noexcept { return mEntries.empty(); }
+
+	/// Whether coalesced motion events keep the positions they were merged from, e.g. for drawing apps. Off by default.
+	/// @see Moved::path
+	void keepPaths(bool b) noexcept { mKeepPaths = b; }
+	bool keepPaths() const noexcept { return mKeepPaths; }
+
+	/// The hovered widgets, from the root to the one under the pointer.
+	///  Motion keeps the part of it which is still under the pointer and only hit tests the children below that.
+	std::vector<Widget*> const& hoverPath() const noexcept { return mHoverPath; }
+	/// Removes w and its descendants from the hover path without sending Leave, e.g. when w is removed from the tree
+	void unhover(Widget& w) noexcept;
+
+	Counters const& counters() const noexcept { return mCounters; }
+	void            resetCounters() noexcept { mCounters = {}; }
+};
+
+} // namespace wwidget
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Canvas.hpp"
+
+#include <unordered_map>
+
+namespace wwidget {
+
+class Widget;
+
+/// The offscreen layers of the widgets which are cached as a layer, see Widget::cacheAsLayer().
+///  render() redraws the layers of widgets which requested a redraw, were resized or relayouted, before the frame.
+///  In the frame these widgets are drawn as a single textured quad.
+///  Widgets which scroll their content can move their layer with scroll(), then only what was exposed is drawn again.
+///  Layers take 4 bytes per pixel, scrolled ones twice that. Widgets whose layer doesn't fit into the budget are drawn directly, like
+///  when the canvas can't draw offscreen. Not thread safe: used from the thread which does layout and drawing.
+class LayerCache {
+public:
+	struct Counters {
+		size_t renders    = 0; //!< Layers drawn by render()
+		size_t composites = 0; //!< Layers drawn instead of their widget
+		size_t blits      = 0; //!< Layers moved by render(), counted in renders as well
+	};
+
+private:
+	struct Entry {
+		Layer layer;
+		Layer spare;      //!< The layer is moved into it by blit()
+		Point scrolled;   //!< Since the last render()
+		Rect  repaint;    //!< Has to be drawn again after moving, empty if nothing has to
+		bool  valid = false; //!< Last, Point and Rect are packed and would be misaligned behind it
+	};
+
+	std::unordered_map<Widget const*, Entry> mEntries;
+	size_t                                   mBudget;
+	size_t                                   mMemoryUsage;
+	Counters                                 mCounters;
+
+	void free(Entry& e);
+	bool blit(Canvas& c, Widget& w, Entry& e);
+	static bool dirty(Widget const& w) noexcept; //!< Whether something in the subtree requested a redraw
+public:
+	LayerCache(size_t budget = 64 << 20);
+	~LayerCache();
+
+	/// Called by Widget when it's cached as a layer and has a context, and when it's destroyed
+	void add(Widget const* w);
+	void remove(Widget const* w);
+
+	/// Redraws the layers which changed. Has to be called after the layout was updated, outside of a frame.
+	///  Layers of widgets which aren't in the tree of root are freed.
+	void render(Canvas& c, Widget const* root);
+	/// Moves the content of w's layer by delta, e.g. when w scrolled its children.
+	///  The next render() draws only the exposed part and repaint (e.g. a scroll bar) instead of the whole layer.
+	///  Returns false if w has no layer which can be moved, then w has to requestRedraw() as usual.
+	bool scroll(Widget const* w, Point const& delta, Rect const& repaint = {});
+
+	/// The layer to draw instead of w, nullptr if w has to be drawn directly
+	Layer const* find(Widget const* w);
+
+	/// Frees all layers, e.g. when a different canvas is used. They are drawn again by the next render().
+	void clear();
+
+	void   budget(size_t bytes) noexcept { mBudget = bytes; }
+	size_t budget() const noexcept { return mBudget; }
+	size_t memoryUsage() const noexcept { return mMemoryUsage; } //!< Bytes used by all layers
+	size_t size() const noexcept { return mEntries.size(); }
+
+	Counters const& counters() const noexcept { return mCounters; }
+	void            resetCounters() noexcept { mCounters = {}; }
+};
+
+} // namespace wwidget
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace wwidget {
+
+/// Editable UTF-8 text with a cursor and a selection.
+///  The text is stored in a gap buffer whose gap is always at the cursor, so typing and deleting at the cursor
+///  is O(1) amortized and moving the cursor costs O(distance).
+///  Next to every byte the buffer stores the advance of its character (on the first byte, 0 on continuation bytes),
+///  so the cursor position and the width of the text are known without measuring the text again.
+///  Only inserted characters are measured, through the Measure function.
+class TextBuffer {
+public:
+	using Measure = std::function<float(std::string_view character)>;
+
+private:
+	std::vector<char>  mText;     //!< [0, mGapBegin) and [mGapEnd, size()) hold text
+	std::vector<float> mAdvances; //!< Same layout as mText
+	size_t mGapBegin;
+	size_t mGapEnd;
+	size_t mAnchor;   //!< The other end of the selection, == cursor() if nothing is selected
+	float  mCursorX;  //!< Sum of the advances before the gap
+	float  mWidth;    //!< Sum of all advances
+
+	void moveGap(size_t pos);
+	void growGap(size_t n);
+	void eraseRange(size_t begin, size_t end);
+
+	size_t toIndex(size_t pos) const noexcept { return pos < mGapBegin ? pos : pos + (mGapEnd - mGapBegin); }
+public:
+	TextBuffer();
+
+	size_t size() const noexcept { return mText.size() - (mGapEnd - mGapBegin); }
+	bool   empty() const noexcept { return size() == 0; }
+	char   operator[](size_t pos) const noexcept { return mText[toIndex(pos)]; }
+
+	std::string_view beforeCursor() const noexcept { return { mText.data(), mGapBegin }; }
+	std::string_view afterCursor() const noexcept { return { mText.data() + mGapEnd, mText.size() - mGapEnd }; }
+	std::string      str() const;
+	std::string      substr(size_t begin, size_t end) const;
+
+	/// Replaces the whole text, the cursor is moved to the end
+	void assign(std::string_view utf8, Measure const& measure);
+	/// Inserts at the cursor, replacing the selection
+	void insert(std::string_view utf8, Measure const& measure);
+	/// Erases the selection, or the character before the cursor (Backspace)
+	void eraseBackward();
+	/// Erases the selection, or the character after the cursor (Delete)
+	void eraseForward();
+	/// Measures all characters again, e.g. after the font changed
+	void remeasure(Measure const& measure);
+
+	// Cursor
+	size_t cursor() const noexcept { return mGapBegin; }
+	float  cursorX() const noexcept { return mCursorX; }
+	float  width() const noexcept { return mWidth; }
+	float  xAt(size_t pos) const noexcept; //!< O(|pos - cursor()|)
+	size_t positionAt(float x) const noexcept; //!< The character boundary closest to x
+
+	void moveCursor(size_t pos, bool select = false);
+	void moveLeft(bool select = false);  //!< By one character
+	void moveRight(bool select = false); //!< By one character
+	void moveHome(bool select = false) { moveCursor(0, select); }
+	void moveEnd(bool select = false) { moveCursor(size(), select); }
+
+	// Selection
+	bool        hasSelection() const noexcept { return mAnchor != mGapBegin; }
+	size_t      selectionBegin() const noexcept { return std::min(mAnchor, mGapBegin); }
+	size_t      selectionEnd() const noexcept { return std::max(mAnchor, mGapBegin); }
+	std::string selection() const { return substr(selectionBegin(), selectionEnd()); }
+	void        select(size_t anchor, size_t cursor);
+	void        selectAll() { select(0, size()); }
+	void        clearSelection() noexcept { mAnchor = mGapBegin; }
+
+	size_t prevCharacter(size_t pos) const noexcept; //!< Start of the character before pos
+	size_t nextCharacter(size_t pos) const noexcept; //!< Start of the character after the one at pos
+};
+
+} // namespace wwidget
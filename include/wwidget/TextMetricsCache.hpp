@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Attributes.hpp"
+#include "Canvas.hpp"
+
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace wwidget {
+
+/// Caches text measurements, so layouts don't have to iterate over the glyphs of unchanged strings again.
+///  Entries are keyed by font, font size, letter spacing, wrap width and the string, of which the cache keeps a copy.
+///  The cache holds at most capacity() measurements and drops the least recently used one when it's full.
+///  Not thread safe: used from the thread which does layout and drawing.
+class TextMetricsCache {
+public:
+	static constexpr float NoWrap = -1; //!< Pass as wrapWidth to measure with Canvas::textBounds instead of textBoxBounds
+
+	struct Counters {
+		size_t hits      = 0;
+		size_t misses    = 0;
+		size_t evictions = 0;
+	};
+
+private:
+	struct Key {
+		size_t font;
+		float  size, letterSpacing, wrapWidth;
+		std::string_view text; //!< Points into Entry::text for stored keys
+		size_t           textHash;
+
+		bool operator==(Key const& other) const noexcept;
+	};
+	struct KeyHash {
+		size_t operator()(Key const& k) const noexcept;
+	};
+	struct Entry {
+		std::string text;
+		Key  key;
+		Rect bounds;
+	};
+
+	size_t                                                          mCapacity;
+	std::list<Entry>                                                mEntries; //!< Most recently used first
+	std::unordered_map<Key, std::list<Entry>::iterator, KeyHash>    mIndex;
+	std::unordered_map<Key, FontMetrics, KeyHash>                   mFontMetrics;
+	Counters                                                        mCounters;
+
+public:
+	TextMetricsCache(size_t capacity = 4096);
+
+	/// Same as c.textBounds({}, txt), or c.textBoxBounds({}, wrapWidth, txt).
+	/// On a miss the font, font size and letter spacing of the canvas are set before measuring.
+	Rect bounds(Canvas& c, std::string_view font, float size, float letterSpacing, float wrapWidth, std::string_view txt, size_t txtHash);
+	Rect bounds(Canvas& c, std::string_view font, float size, float letterSpacing, float wrapWidth, std::string_view txt) {
+		return bounds(c, font, size, letterSpacing, wrapWidth, txt, fnv1a(txt));
+	}
+
+	/// Same as c.fontMetrics() with that font and size
+	FontMetrics fontMetrics(Canvas& c, std::string_view font, float size);
+
+	/// Has to be called when fonts change, e.g. when a different canvas is used
+	void clear();
+
+	void   capacity(size_t n);
+	size_t capacity() const noexcept { return mCapacity; }
+	size_t size() const noexcept { return mEntries.size(); }
+
+	Counters const& counters() const noexcept { return mCounters; }
+	void            resetCounters() noexcept { mCounters = {}; }
+};
+
+} // namespace wwidget
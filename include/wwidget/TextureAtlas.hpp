@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace wwidget {
+
+class Bitmap;
+
+/// Packs small bitmaps into shared RGBA pages, so a renderer can draw all of them from a few textures.
+///  Pages are filled with shelves (rows as tall as their tallest bitmap). A shelf becomes reusable
+///  once all of its bitmaps were released, a page is evicted once all bitmaps on it were released.
+class TextureAtlas {
+public:
+	struct Region {
+		unsigned page   = 0;
+		unsigned x      = 0, y = 0; //!< Position of the bitmap on the page, the padding is around it
+		unsigned width  = 0, height = 0;
+
+		explicit operator bool() const noexcept { return width > 0 && height > 0; }
+	};
+
+private:
+	struct Shelf {
+		unsigned y, height;
+		unsigned used; //!< Width allocated from the left
+		unsigned live; //!< Regions on this shelf which weren't released yet
+	};
+	struct Page {
+		std::vector<Shelf>         shelves;
+		unsigned                   live = 0;
+		std::unique_ptr<uint8_t[]> pixels; //!< nullptr if the page was evicted or never used
+	};
+
+	unsigned          mPageSize;
+	unsigned          mMaxItemSize;
+	unsigned          mPadding;
+	std::vector<Page> mPages;
+
+	bool allocateOnPage(Page& page, unsigned w, unsigned h, Region& result);
+public:
+	TextureAtlas(unsigned pageSize = 1024, unsigned maxItemSize = 128, unsigned padding = 1);
+
+	/// Whether a bitmap of that size is small enough for the atlas
+	bool fits(unsigned w, unsigned h) const noexcept;
+
+	/// Reserves space on a page, creating a new page if needed. Returns an empty region if !fits(w, h).
+	Region allocate(unsigned w, unsigned h);
+	/// Allocates space for the bitmap and copies it to the page. The padding is filled with the bitmap's edge pixels.
+	Region add(Bitmap const& bm);
+	/// Returns true if this was the last region on the page and the page was evicted
+	bool release(Region const& region);
+
+	/// RGBA pixels of the page, pageSize() * pageSize() * 4 bytes. nullptr if the page isn't in use.
+	uint8_t const* pixels(unsigned page) const noexcept;
+
+	unsigned pageSize() const noexcept { return mPageSize; }
+	unsigned padding() const noexcept { return mPadding; }
+	size_t   pageCount() const noexcept; //!< Pages which currently hold bitmaps
+};
+
+} // namespace wwidget
@@ -8,6 +8,7 @@
 
 #include "Events.hpp"
 #include "Attributes.hpp"
+#include "AttributeTable.hpp"
 #include "thirdparty/stx/shared_ptr.hpp"
 
 #define WWIDGET_DECLARE_VARIADIC_SET_FUNCTION() \
@@ -27,6 +28,7 @@ class Bitmap;
 class Font;
 class Image;
 class Context;
+enum class TaskPriority;
 
 using namespace stx;
 
@@ -64,13 +66,18 @@ private:
 			childFocused : 1,
 			needsRedraw : 1,
 			childNeedsRedraw : 1,
-			recalcPrefSize : 1;
+			recalcPrefSize : 1,
+			cacheAsLayer : 1,
+			hovered : 1,
+			handlers : 6,
+			subtreeHandlers : 6;
 	} mFlags;
 
 	void notifyChildAdded(Widget& newChild);
 	void notifyChildRemoved(Widget& noLongerChild);
 
 	void drawRecursive(Canvas& canvas, bool minimal);
+	void drawRecursive(Canvas& canvas, bool minimal, Rect const& area); //<! Only draws the children which overlap area
 
 	template<typename T>
 	bool sendEvent(T const& t, bool skip_focused);
@@ -79,6 +86,8 @@ private:
 protected:
 	// ** Overidable event receivers *******************************************************
 	friend class Context;
+	friend class LayerCache;
+	friend class InputQueue;
 	virtual void onContextChanged();
 
 	virtual void onAddTo(Widget& w); //<! Called when this is added to w
@@ -95,10 +104,15 @@ protected:
 	virtual void onLayout(); //<! The widget updates the child's positions and size in here
 
 	// Input events
+	/// Declares which on() the class overrides, as Event::handlerBit of the event types. Only those are called.
+	///  Classes call it in their constructors, e.g. handles(handles() | Scroll::handlerBit).
+	Widget& handles(unsigned eventBits) noexcept;
 	virtual void on(Click     const& c);
 	virtual void on(Scroll    const& s);
 	virtual void on(Moved     const& c);
 	virtual void on(Dragged   const& s);
+	virtual void on(Enter     const& e);
+	virtual void on(Leave     const& e);
 	virtual void on(KeyEvent  const& k);
 	virtual void on(TextInput const& t);
 
@@ -109,6 +123,9 @@ protected:
 	// Drawing events
 	virtual void onDrawBackground(Canvas& graphics); //<! Draw background (From root to leafs)
 	virtual void onDraw(Canvas& graphics); //<! Draw foreground (from root to leafs)
+	/// The children which have to be drawn to cover area (in local coordinates), as [first, end) in child order.
+	/// All of them by default, widgets which know their layout can skip the ones which can't be visible.
+	virtual std::pair<Widget*, Widget*> visibleChildren(Rect const& area);
 
 	// ** Layout utilities *******************************************************
 	PreferredSize calcBoxAroundChildren(
@@ -124,8 +141,14 @@ protected:
 
 public:
 	// Attributes
+	/// Sets the attribute with the name from attributeTable(), returns false if there is none.
+	///  Widgets with attributes which can't be set by a single setter (e.g. Form's 'src') override it.
 	virtual bool setAttribute(std::string_view name, Attribute const& value);
 	virtual void getAttributes(AttributeCollectorInterface& collector);
+	/// The attributes of the widget's class, and through AttributeTable::base() of its base classes.
+	///  Classes with attributes define a static classAttributes() and override this to return it.
+	virtual AttributeTable const& attributeTable() const noexcept;
+	static  AttributeTable const& classAttributes() noexcept;
 
 public:
 	Widget() noexcept;
@@ -140,6 +163,19 @@ protected:
 	Widget(Widget const& other) noexcept;
 	Widget& operator=(Widget const& other) noexcept;
 
+	// ** Clone *******************************************************
+	/// Creates a widget of the same class with the same attributes (what setAttribute() sets), but without children, for clone().
+	///  Widgets with attributes override it like: `auto copy = make_shared<T>(); cloneAttributes(*copy); return copy;`
+	///  Widgets which create their own children can't be cloned and don't override it.
+	virtual shared<Widget> onClone() const;
+	/// Copies name, classes, size, offset, alignment, padding and cacheAsLayer. Widgets with attributes add an overload for their class.
+	void cloneAttributes(Widget& to) const;
+
+public:
+	/// A deep copy: the widget and all its descendants, without parent or context. Nothing is parsed or loaded again.
+	///  Throws an InvalidOperation if a widget in the tree doesn't implement onClone().
+	shared<Widget> clone() const;
+
 public:
 	// ** Tree operations *******************************************************
 
@@ -259,6 +295,12 @@ public:
 	Context* context() const noexcept { return mContext; }
 	Widget&  context(Context* ctxt);
 
+	/// Draw this widget and its children into an offscreen layer, which is drawn as one textured quad.
+	///  The layer is only drawn again when something in the subtree calls requestRedraw(), is relayouted or resized.
+	///  For subtrees which are expensive to draw but rarely change. @see LayerCache
+	inline bool cacheAsLayer() const noexcept { return mFlags.cacheAsLayer; }
+	Widget&     cacheAsLayer(bool b);
+
 	inline const char* name() const noexcept { return mName.c_str(); }
 	inline Widget& name(std::string const& n) noexcept { mName.reset(n.data(), n.length()); return *this; }
 
@@ -333,7 +375,14 @@ public:
 
 	inline bool needsRelayout() const noexcept { return mFlags.needsRelayout; }
 	inline bool childNeedsRelayout() const noexcept { return mFlags.childNeedsRelayout; }
+	/// The event types (Event::handlerBit) this widget handles, clicks and keys unless its class declares others.
+	///  Events are only dispatched to widgets and into subtrees which handle them.
+	inline unsigned handles() const noexcept { return mFlags.handlers; }
+	inline unsigned subtreeHandles() const noexcept { return mFlags.subtreeHandlers; } //!< handles() of this widget and every descendant
+	inline bool needsRedraw() const noexcept { return mFlags.needsRedraw; }
+	inline bool childNeedsRedraw() const noexcept { return mFlags.childNeedsRedraw; }
 	inline bool focused() const noexcept { return mFlags.focused; }
+	inline bool hovered() const noexcept { return mFlags.hovered; } //!< Whether the pointer is over this widget or one of its descendants
 	inline bool childFocused() const noexcept { return mFlags.childFocused; }
 
 	shared<Widget> findFocused() noexcept;
@@ -343,6 +392,7 @@ public:
 
 	// ** Backend shortcuts *******************************************************
 	void defer(std::function<void()> fn);
+	void defer(TaskPriority priority, std::function<void()> fn);
 	// void deferDraw(std::function<void()> fn);
 
 	shared<Bitmap> loadImage(std::string const& url);
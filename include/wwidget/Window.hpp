@@ -35,7 +35,8 @@ public:
 		FlagRelative       = 8,
 		FlagUpdateOnEvent  = 16,
 		FlagDrawDebug      = 32,
-		FlagShrinkFit      = 64
+		FlagShrinkFit      = 64,
+		FlagRenderOnDemand = 128 //!< Only draws and swaps when something changed, sleeps until then. @see BasicContext::renderOnDemand()
 	};
 
 	Window();
@@ -48,6 +49,8 @@ public:
 	void requestClose();
 
 	bool update() override;
+	void waitEvents() override;
+	void wakeup() override;
 
 	/// Blocks and updates the window until it is closed
 	void keepOpen();
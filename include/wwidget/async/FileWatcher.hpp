@@ -0,0 +1,48 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace wwidget {
+
+/// Watches files for changes and calls back from its own thread.
+///  On Linux it uses inotify on the directories of the files, so files which are replaced by renaming another file over them
+///  (like many editors save) are still noticed. Elsewhere the modification times are polled every pollInterval.
+///  Changes reported by the system at once are reported once per file, with the path as it was passed to add().
+class FileWatcher {
+public:
+	using Callback = std::function<void(std::string const& path)>;
+
+	static constexpr unsigned pollInterval = 250; //!< Milliseconds, without inotify
+
+private:
+	struct Implementation;
+
+	Callback                      mCallback;
+	std::mutex                    mMutex;
+	std::map<std::string, size_t> mPaths; //!< How often each path was added
+	Implementation*               mImpl;
+	std::thread                   mThread;
+
+	void threadMain();
+	void changed(std::string const& path); //!< Calls back if the path is still watched
+
+public:
+	FileWatcher(Callback callback);
+	~FileWatcher();
+
+	FileWatcher(FileWatcher const&) = delete;
+	FileWatcher& operator=(FileWatcher const&) = delete;
+
+	/// Starts watching the file at path. Paths can be added more than once, then they have to be removed as often. Thread safe.
+	///  Throws exceptions::FailedLoadingFile if the directory of path can't be watched.
+	void add(std::string const& path);
+	/// Stops watching the file at path once it was removed as often as it was added. Thread safe.
+	void remove(std::string const& path);
+	size_t size(); //!< The number of different paths watched
+};
+
+} // namespace wwidget
@@ -1,23 +1,64 @@
 #pragma once
 
+#include "Task.hpp"
+
+#include <atomic>
+#include <chrono>
 #include <deque>
-#include <mutex>
 #include <functional>
+#include <memory>
+#include <mutex>
 
 namespace wwidget {
 
-/// A single consumer multiple provider task-queue.
-///  It's still threadsafe for multiple consumers, just not optimized
+/// A multiple producer, single consumer task-queue.
+///  Tasks are stored in a lock-free bounded ring, producers only fall back to a locked overflow list
+///  while the ring is full. Tasks added by the same thread are executed in the order they were added.
+///  add() may be called from any thread, executeSingleConsumer() only from one thread at a time.
 class TaskQueue {
-	std::mutex mMutex;
-	std::deque<std::function<void()>> mTasks;
+	struct Slot {
+		std::atomic<size_t> sequence;
+		Task                task;
+	};
+
+	std::unique_ptr<Slot[]> mSlots;
+	size_t                  mMask;
+
+	alignas(64) std::atomic<size_t> mEnqueuePos;
+	alignas(64) size_t              mDequeuePos;
+	std::deque<Task>                mCarried; //!< Drained from the overflow list but not executed before the deadline. Consumer only.
+
+	alignas(64) std::atomic<bool> mHasOverflow;
+	std::mutex                    mOverflowMutex;
+	std::deque<Task>              mOverflow;
+
+	std::atomic<bool>     mSignaled;
+	std::function<void()> mWakeup;
+
+	bool tryPush(Task& t);
+	Task tryPop();
 public:
-	TaskQueue();
+	TaskQueue(size_t capacity = 1024);
 	~TaskQueue();
 
-	void add(std::function<void()> fn);
+	void add(Task t);
+
+	using Clock = std::chrono::steady_clock;
 
+	/// Executes tasks until the queue is empty (including tasks added by the executed tasks). Returns the number of executed tasks.
 	size_t executeSingleConsumer();
+	/// Like executeSingleConsumer(), but stops once the deadline passed. The clock is checked after every task,
+	/// so at least one task is executed if there is any. Tasks which weren't executed stay queued in order.
+	size_t executeSingleConsumer(Clock::time_point deadline);
+
+	/// Called by add() (on the producing thread) when the first task arrives after the consumer emptied the queue.
+	/// Use it to wake up a consumer thread which is blocking on something else, e.g. window events.
+	void wakeup(std::function<void()> fn) { mWakeup = std::move(fn); }
+
+	/// Only reliable on the consumer thread
+	bool empty() const noexcept;
+	/// Number of queued tasks. Only reliable on the consumer thread, tasks which are currently being added might not be counted.
+	size_t size();
 };
 
 } // namespace wwidget
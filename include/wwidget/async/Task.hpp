@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace wwidget {
+
+/// A move-only, type-erased `void()` callable.
+///  Callables up to BufferSize bytes are stored inline (no allocation),
+///  larger ones are moved to the heap. Unlike std::function it never copies.
+class Task {
+public:
+	constexpr static inline size_t BufferSize = sizeof(void*) * 6;
+
+private:
+	struct Operations {
+		void (*invoke)(void* storage);
+		void (*move)(void* from, void* to) noexcept; //!< Move-constructs into to and destroys from
+		void (*destroy)(void* storage) noexcept;
+	};
+
+	template<class Fn>
+	constexpr static inline bool StoredInline =
+		sizeof(Fn) <= BufferSize &&
+		alignof(Fn) <= alignof(std::max_align_t) &&
+		std::is_nothrow_move_constructible_v<Fn>;
+
+	template<class Fn>
+	struct InlineOperations {
+		static void invoke(void* s) { (*static_cast<Fn*>(s))(); }
+		static void move(void* from, void* to) noexcept {
+			new(to) Fn(std::move(*static_cast<Fn*>(from)));
+			static_cast<Fn*>(from)->~Fn();
+		}
+		static void destroy(void* s) noexcept { static_cast<Fn*>(s)->~Fn(); }
+
+		constexpr static inline Operations table = { &invoke, &move, &destroy };
+	};
+
+	template<class Fn>
+	struct HeapOperations {
+		static void invoke(void* s) { (**static_cast<Fn**>(s))(); }
+		static void move(void* from, void* to) noexcept {
+			*static_cast<Fn**>(to) = *static_cast<Fn**>(from);
+		}
+		static void destroy(void* s) noexcept { delete *static_cast<Fn**>(s); }
+
+		constexpr static inline Operations table = { &invoke, &move, &destroy };
+	};
+
+	Operations const* mOperations;
+	alignas(std::max_align_t) unsigned char mStorage[BufferSize];
+
+public:
+	Task() noexcept : mOperations(nullptr) {}
+	Task(std::nullptr_t) noexcept : Task() {}
+
+	template<class Fn, class = std::enable_if_t<
+		!std::is_same_v<std::decay_t<Fn>, Task> &&
+		std::is_invocable_v<std::decay_t<Fn>&>>>
+	Task(Fn&& fn) : Task() {
+		using F = std::decay_t<Fn>;
+		if constexpr(StoredInline<F>) {
+			new(mStorage) F(std::forward<Fn>(fn));
+			mOperations = &InlineOperations<F>::table;
+		}
+		else {
+			*reinterpret_cast<F**>(mStorage) = new F(std::forward<Fn>(fn));
+			mOperations = &HeapOperations<F>::table;
+		}
+	}
+
+	~Task() { reset(); }
+
+	Task(Task&& other) noexcept : mOperations(other.mOperations) {
+		if(mOperations) {
+			mOperations->move(other.mStorage, mStorage);
+			other.mOperations = nullptr;
+		}
+	}
+	Task& operator=(Task&& other) noexcept {
+		if(this != &other) {
+			reset();
+			if(other.mOperations) {
+				other.mOperations->move(other.mStorage, mStorage);
+				mOperations = std::exchange(other.mOperations, nullptr);
+			}
+		}
+		return *this;
+	}
+
+	Task(Task const&) = delete;
+	Task& operator=(Task const&) = delete;
+
+	void reset() noexcept {
+		if(mOperations) {
+			mOperations->destroy(mStorage);
+			mOperations = nullptr;
+		}
+	}
+
+	void operator()() { mOperations->invoke(mStorage); }
+
+	explicit operator bool() const noexcept { return mOperations != nullptr; }
+};
+
+} // namespace wwidget
@@ -1,22 +1,51 @@
 #pragma once
 
+#include "Task.hpp"
+
+#include <algorithm>
 #include <functional>
 
 #include <deque>
+#include <memory>
 #include <vector>
 
+#include <atomic>
+#include <chrono>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 
 namespace wwidget {
 
+/// A work-stealing thread pool.
+///  Every worker owns a deque: tasks added from a worker go to the back of its own deque and are
+///  popped LIFO by it, idle workers steal FIFO from the front of the others.
+///  Tasks added from outside the pool are distributed round-robin over the workers.
 class Threadpool {
-	volatile bool            mRunning;
-	std::mutex               mMutex;
-	std::condition_variable  mWaiting;
-	std::vector<std::thread> mThreads;
-	std::deque<std::function<void()>> mTasks;
+	struct alignas(64) WorkQueue {
+		std::mutex       mutex;
+		std::deque<Task> tasks;
+
+		void push(Task&& t);
+		Task popBack();
+		Task popFront();
+	};
+
+	std::atomic<bool>                       mRunning;
+	std::vector<std::unique_ptr<WorkQueue>> mQueues;
+	std::vector<std::thread>                mThreads;
+	WorkQueue                               mInjected; //!< Tasks added while no workers were running
+
+	std::atomic<size_t>   mPending;  //!< Tasks queued but not yet popped
+	std::atomic<size_t>   mNextQueue;
+	std::atomic<unsigned> mSleeping;
+	std::mutex              mSleepMutex;
+	std::condition_variable mWaiting;
+
+	void workerMain(size_t index);
+	WorkQueue* ownQueue() const noexcept; //!< The calling thread's queue, nullptr if it isn't a worker of this pool
+	Task steal(size_t first);
+	void wakeOne();
 
 public:
 	Threadpool();
@@ -26,11 +55,105 @@ public:
 	void start(size_t size);
 	void stop();
 
+	void add(Task&& task);
 	void add(std::function<void()>&& fn);
-	std::function<void()> await_pop();
-	std::function<void()> try_pop();
+	template<class Fn, class = std::enable_if_t<!std::is_same_v<std::decay_t<Fn>, Task>>>
+	void add(Fn&& fn) { add(Task(std::forward<Fn>(fn))); }
+
+	Task await_pop();
+	Task try_pop();
 
-	bool running() const noexcept { return mRunning; }
+	/// Pops and executes a single task. Returns false if there was nothing to do.
+	/// Used while waiting on a TaskGroup, so that waiting threads help instead of blocking.
+	bool runOne();
+
+	size_t size() const noexcept { return mThreads.size(); }
+	size_t pending() const noexcept { return mPending.load(std::memory_order_relaxed); }
+	bool running() const noexcept { return mRunning.load(std::memory_order_relaxed); }
 };
 
-} // namespace wwidget
\ No newline at end of file
+/// A set of tasks that can be waited on.
+///  join() (also called by the destructor) executes other tasks of the pool while waiting,
+///  and sleeps once there are none left while the group's last tasks run on other threads.
+class TaskGroup {
+	Threadpool&             mPool;
+	std::atomic<size_t>     mOutstanding;
+	std::mutex              mMutex; //!< Held while finishing a task, so join() can't return while it's notified
+	std::condition_variable mFinished;
+
+	void finished();
+
+public:
+	TaskGroup(Threadpool& pool) : mPool(pool), mOutstanding(0) {}
+	~TaskGroup() { join(); }
+
+	TaskGroup(TaskGroup const&) = delete;
+	TaskGroup& operator=(TaskGroup const&) = delete;
+
+	template<class Fn>
+	void run(Fn&& fn);
+
+	void join();
+
+	bool done() const noexcept { return mOutstanding.load(std::memory_order_acquire) == 0; }
+};
+
+/// Calls fn(i) for every i in [begin, end) in chunks of grain, the calling thread executes a share of the chunks itself.
+template<class Fn>
+void parallel_for(Threadpool& pool, size_t begin, size_t end, Fn&& fn, size_t grain = 1);
+
+// =============================================================
+// == Inline implementation =============================================
+// =============================================================
+
+template<class Fn>
+void TaskGroup::run(Fn&& fn) {
+	mOutstanding.fetch_add(1, std::memory_order_relaxed);
+	mPool.add(Task([this, fn = std::forward<Fn>(fn)]() mutable {
+		struct Done {
+			TaskGroup& group;
+			~Done() { group.finished(); }
+		} done { *this };
+		fn();
+	}));
+}
+
+inline
+void TaskGroup::finished() {
+	std::lock_guard<std::mutex> lock(mMutex);
+	if(mOutstanding.fetch_sub(1, std::memory_order_release) == 1)
+		mFinished.notify_all();
+}
+
+inline
+void TaskGroup::join() {
+	while(!done()) {
+		if(mPool.runOne()) continue;
+		// Nothing to help with: the remaining tasks run on other threads.
+		// Wakes up now and then, in case they add tasks this thread could help with.
+		std::unique_lock<std::mutex> lock(mMutex);
+		mFinished.wait_for(lock, std::chrono::milliseconds(1), [this]() { return done(); });
+	}
+	// The task which finished last might still be notifying
+	std::lock_guard<std::mutex> lock(mMutex);
+}
+
+template<class Fn>
+void parallel_for(Threadpool& pool, size_t begin, size_t end, Fn&& fn, size_t grain) {
+	if(begin >= end) return;
+	grain = std::max<size_t>(1, grain);
+
+	TaskGroup group(pool);
+	size_t chunk_begin = begin;
+	while(end - chunk_begin > grain) {
+		size_t chunk_end = chunk_begin + grain;
+		group.run([&fn, chunk_begin, chunk_end]() {
+			for(size_t i = chunk_begin; i < chunk_end; i++) fn(i);
+		});
+		chunk_begin = chunk_end;
+	}
+	for(size_t i = chunk_begin; i < end; i++) fn(i);
+	group.join();
+}
+
+} // namespace wwidget
@@ -77,7 +77,7 @@ public:
 	void remove_weak_ref() noexcept {
 		refcount weak_refs = --m_weak_refs;
 		if(weak_refs == 0) {
-			if(m_strong_refs == 0 && !_destruction_in_progress()) {
+			if(m_strong_refs.load() < 0) { // Already destroyed, while it is (0) remove_strong_ref() frees it afterwards
 				m_weak_refs = -1;
 				shared_block_free();
 			}
@@ -98,10 +98,6 @@ private:
 		while(!v.compare_exchange_weak(val, val+1));
 		return true;
 	}
-
-	bool _destruction_in_progress() const noexcept {
-		return m_strong_refs.load() == 0;
-	}
 };
 
 // ** Dummy shared_block *******************************************************
@@ -12,9 +12,13 @@ protected:
 	std::function<void()> mOnClick;
 
 	void on(Click const& click) override;
+	void on(Enter const& e) override;
+	void on(Leave const& e) override;
 	PreferredSize onCalcPreferredSize(PreferredSize const& constraints) override;
 	void onDrawBackground(Canvas& canvas) override;
 	void onDraw(Canvas& canvas) override;
+	shared<Widget> onClone() const override;
+	void cloneAttributes(Button& to) const;
 public:
 	Button();
 	Button(std::string txt);
@@ -33,7 +37,8 @@ public:
 
 	inline bool pressed() const noexcept { return mPressed; }
 
-	bool setAttribute(std::string_view name, Attribute const& value) override;
+	AttributeTable const& attributeTable() const noexcept override;
+	static AttributeTable const& classAttributes() noexcept;
 	void getAttributes(AttributeCollectorInterface& collector) override;
 };
 
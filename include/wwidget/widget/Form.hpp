@@ -4,25 +4,89 @@
 
 #include <functional>
 #include <memory>
+#include <string_view>
 #include <typeinfo>
 #include <unordered_map>
+#include <unordered_set>
 
 #include "../Error.hpp"
 
 namespace wwidget {
 
+/// Maps element names to the functions creating the widgets, see Form::factory.
+///  The names are interned, so they can be looked up with a string_view without building a std::string.
+///  Forms share it with the forms nested in them and copy it before they change a shared one, see Form::factory.
+class FormFactories {
+public:
+	using FactoryFn = std::function<shared<Widget>()>;
+
+private:
+	std::unordered_set<std::string>                 mNames; //!< The keys of mFactories point into these
+	std::unordered_map<std::string_view, FactoryFn> mFactories;
+
+public:
+	FormFactories() {}
+	FormFactories(FormFactories const& other);
+	FormFactories& operator=(FormFactories const& other) = delete;
+
+	FactoryFn const* find(std::string_view name) const noexcept;
+	void             set(std::string_view name, FactoryFn&& fn);
+
+	bool   empty() const noexcept { return mFactories.empty(); }
+	size_t size() const noexcept { return mFactories.size(); }
+};
+
 /// A widget which can load its children from a xml file.
 ///  You can register your own widgets by using the Form::factory functions, but
 ///  you have to call Form::addDefaultFactories if you want to add the default widgets then.
 class Form : public Widget {
 public:
-	using FactoryFn = std::function<shared<Widget>()>;
+	using FactoryFn = FormFactories::FactoryFn;
 
 private:
-	std::unordered_map<std::string, FactoryFn> mFactories;
+	shared<FormFactories> mFactories; //!< Possibly shared with other forms, don't change it without factories()
+
+	FormFactories& factories(); //!< Copies mFactories first if it is shared
+	bool           hasFactories() const noexcept { return mFactories && !mFactories->empty(); }
+	shared<Widget> create(FactoryFn const& factory) const; //!< Nested forms get this form's factories
+	void           registerDefaultFactories();
+
+	/// Is told what parse() does, to record it
+	struct ParseListener {
+		virtual bool attribute(Widget& to, std::string_view name, std::string_view value) = 0; //!< Sets the attribute instead of parse(), value points into the parsed text
+		virtual void begin(std::string_view element, Widget& created) = 0; //!< Before the attributes of a new child
+		virtual void end() = 0;
+	};
+	class Compiler;
+	class CodeGenerator;
+
+	struct Prototype;
+	class PrototypeRecorder;
+	/// The prototype of the file at path for this form's factories. Parses the file if it wasn't yet, or changed since
+	shared<Prototype> prototype(std::string const& path);
+	void              instantiate(Prototype const& prototype);
+
+	struct SourceElement;
+	std::string           mPath;    //!< The file last load()ed
+	shared<SourceElement> mSource;  //!< What was load()ed from mPath while watching, with the widgets created for it
+	bool                  mWatching = false;
+
+	static shared<SourceElement> readSource(const char* text);
+	void           loadSource(std::string const& path);
+	void           checkSource(SourceElement const& element, const char* text) const; //!< Throws if an element has no factory
+	shared<Widget> create(SourceElement& element, const char* text);
+	void           build(Widget& widget, SourceElement& element, const char* text); //!< Sets the attributes of element on the widget and builds its children
+	void           patch(Widget& widget, SourceElement& from, SourceElement& to, const char* text); //!< The widget was built from the element from
+
+	/// The demangled name of a type, e.g. "wwidget::Button"
+	static std::string typeName(std::type_info const& type);
+
+	void parse(const char* text, ParseListener* listener);
 
 protected:
 	void onDraw(Canvas&) override;
+	void onContextChanged() override;
+	shared<Widget> onClone() const override;
 public:
 	Form();
 	Form(std::string const& path);
@@ -43,11 +107,47 @@ public:
 
 	Form& addDefaultFactories();
 
+	/// Loads the form at path. The first time a file is loaded it is parsed into a prototype, which is cloned (see Widget::clone())
+	///  when the same file is loaded again with the same factories, until its modification time changes.
+	///  Forms nested with 'src' are part of the prototype, changing them alone isn't noticed.
+	///  Files with widgets which can't be cloned are parsed every time, from memory.
 	Form& load(std::string const& path);
 	Form& load(std::istream& stream);
+	/// Forgets the prototypes of all files load()ed so far, e.g. to free their memory
+	static void clearPrototypes();
 	Form& parse(const char* text);
 
-	bool setAttribute(std::string_view name, Attribute const& value) override;
+	/// Reloads the form when the file it was load()ed from changes, see reload(). The reload is deferred to the form's context,
+	///  forms without a context aren't reloaded. Forms nested with 'src' are watched as well.
+	///  Watch before loading: what a watching form loads is recorded, to know which widgets were created for which element.
+	///  Files loaded before are rebuilt completely when they change for the first time.
+	Form& watch(bool b = true);
+	bool  watching() const noexcept { return mWatching; }
+	/// Parses the file last load()ed again and changes the widgets to match it, instead of creating them again.
+	///  Elements are matched by their position, type and name. Changed attributes are set again, elements which were
+	///  added or removed are inserted or removed. Elements which lost an attribute are created again, as there is no
+	///  way to unset it. Everything else keeps its state, e.g. scroll positions and loaded images.
+	///  Nothing is changed if the file can't be parsed.
+	Form& reload();
+	std::function<void()> onReloaded; //!< Called after reload()
+
+	/// Loads a form in the compiled format, see compile(). Nothing is parsed:
+	///  element names were resolved to factory indices, attribute values were parsed into the type the widget reads them as and strings are pooled.
+	///  Attributes which are read as a different type than when they were compiled are parsed from their text, like in parse().
+	Form& loadCompiled(std::string const& path);
+	Form& parseCompiled(const void* data, size_t size);
+	/// Translates a xml form (see parse()) to the compiled format, which can be stored and loaded with loadCompiled().
+	///  The widgets are created with this form's factories to find out which types they read their attributes as.
+	///  The format depends on the endianness of the machine, and nested forms loaded with 'src' are still loaded from xml.
+	std::string compile(const char* text);
+	/// Translates a xml form to C++ which builds the same tree without parsing anything, see example/formcpp and the FormCpp rule in premake5.lua.
+	///  The generated function is `wwidget::Form& function(wwidget::Form& form)` and adds the children to form.
+	///  Attributes become the AttributeInfo::code() of the widgets' attributes with typed values, values which don't parse are left to setAttribute() at runtime.
+	///  Only the default widgets (see addDefaultFactories()) are supported, and nested forms loaded with 'src' are still loaded from xml.
+	std::string generateCpp(const char* text, std::string const& function);
+
+	AttributeTable const& attributeTable() const noexcept override;
+	static AttributeTable const& classAttributes() noexcept;
 };
 
 // =============================================================
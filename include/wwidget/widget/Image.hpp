@@ -21,6 +21,8 @@ protected:
 	void onDrawBackground(Canvas& canvas) override;
 	void onDraw(Canvas& canvas) override;
 	void onContextChanged() override;
+	shared<Widget> onClone() const override;
+	void cloneAttributes(Image& to) const;
 public:
 	Image();
 	Image(std::string source);
@@ -49,7 +51,8 @@ public:
 	Color const& tint() const noexcept { return mTint; }
 	Image& tint(Color const& color) noexcept { mTint = color; return *this; }
 
-	bool setAttribute(std::string_view name, Attribute const& value) override;
+	AttributeTable const& attributeTable() const noexcept override;
+	static AttributeTable const& classAttributes() noexcept;
 	void getAttributes(AttributeCollectorInterface& collector) override;
 };
 
@@ -5,6 +5,8 @@
 namespace wwidget {
 
 class Knob : public Slider {
+protected:
+	shared<Widget> onClone() const override;
 public:
 	Knob();
 	~Knob();
@@ -4,6 +4,9 @@
 
 namespace wwidget {
 
+/// Lays out its children in a row or column, which can be scrolled.
+///  Scrolling only moves the children. If the list is cached as a layer (see Widget::cacheAsLayer()),
+///  the last frame is moved as well and only what scrolled into view is drawn.
 class List : public Widget {
 private:
 	Flow  mFlow;
@@ -11,6 +14,8 @@ private:
 
 	float mScrollOffset;
 	float mTotalLength;
+
+	std::vector<Widget*> mLaidOut; //!< The children in the order of the last onLayout(), empty if they changed since
 protected:
 	float maxScrollOffset() const;
 	float totalLength() const;
@@ -21,6 +26,7 @@ protected:
 	PreferredSize onCalcPreferredSize(PreferredSize const& constraints) override;
 	void onLayout() override;
 	void onDraw(Canvas& c) override;
+	std::pair<Widget*, Widget*> visibleChildren(Rect const& area) override;
 
 	void on(Scroll const& scroll) override;
 
@@ -31,6 +37,8 @@ protected:
 	bool onFocus(bool b, FocusType type) override;
 	void on(Click const& click) override;
 	void on(Dragged const& drag) override;
+	shared<Widget> onClone() const override;
+	void cloneAttributes(List& to) const;
 public:
 	List();
 	List(Widget* addTo);
@@ -38,7 +46,8 @@ public:
 
 	void onDescendendFocused(Rect const& area, Widget& w) override;
 
-	bool setAttribute(std::string_view name, Attribute const& value) override;
+	AttributeTable const& attributeTable() const noexcept override;
+	static AttributeTable const& classAttributes() noexcept;
 	void getAttributes(AttributeCollectorInterface& collector) override;
 
 	bool flowsRight() const noexcept { return mFlow == FlowRight; }
@@ -13,6 +13,8 @@ class ProgressBar : public Widget {
 protected:
 	void onDrawBackground(Canvas& canvas) override;
 	void onDraw(Canvas& canvas) override;
+	shared<Widget> onClone() const override;
+	void cloneAttributes(ProgressBar& to) const;
 
 public:
 	ProgressBar();
@@ -25,6 +27,8 @@ public:
 	ProgressBar* scale(float f);
 
 	bool setAttribute(std::string_view name, Attribute const& value) override;
+	AttributeTable const& attributeTable() const noexcept override;
+	static AttributeTable const& classAttributes() noexcept;
 	void getAttributes(AttributeCollectorInterface& collector) override;
 };
 
@@ -20,7 +20,6 @@ protected:
 	double fractionToValue(double x) const noexcept;
 	double valueToFraction(double x) const noexcept;
 
-	bool setAttribute(std::string_view name, Attribute const& value) override;
 	void getAttributes(AttributeCollectorInterface&) override;
 
 	bool onFocus(bool b, FocusType type) override;
@@ -29,6 +28,8 @@ protected:
 	void on(Scroll  const& scroll) override;
 	void on(Click   const& click) override;
 	void on(Dragged const& click) override;
+	shared<Widget> onClone() const override;
+	void cloneAttributes(Slider& to) const;
 
 public:
 	Slider();
@@ -37,6 +38,9 @@ public:
 
 	Slider(Slider&&) = delete; // TODO: Make slider movable
 
+	AttributeTable const& attributeTable() const noexcept override;
+	static AttributeTable const& classAttributes() noexcept;
+
 	inline double scale()    const noexcept { return mScale; }
 	inline double start()    const noexcept { return mStart; }
 	inline double value()    const noexcept { return mValue; }
@@ -12,13 +12,17 @@ protected:
 	float       mFontSize;
 	std::string mFont;
 	std::string mText;
+	size_t      mTextHash; //!< fnv1a(mText), for the context's TextMetricsCache
 	bool        mWrap;
 
 protected:
 	void onContextChanged() override;
+	virtual void setContent(std::string s); //!< Behind content(s), so subclasses keeping the text elsewhere see every change
 
 	PreferredSize onCalcPreferredSize(PreferredSize const& constraints) override;
 	void onDraw(Canvas& canvas) override;
+	shared<Widget> onClone() const override;
+	void cloneAttributes(Text& to) const;
 public:
 	Text();
 	Text(std::string content);
@@ -30,7 +34,7 @@ public:
 	Text& operator=(Text&& other) noexcept;
 
 	Text& content(std::string s);
-	auto& content() const noexcept { return mText; }
+	virtual std::string const& content() const { return mText; }
 	Text& font   (std::string const& name);
 	auto& font() const noexcept { return mFont; }
 	Text& fontColor(Color const& c);
@@ -40,7 +44,8 @@ public:
 	Text& wrap(bool b);
 	bool  wrap() const noexcept { return mWrap; }
 
-	bool setAttribute(std::string_view name, Attribute const& value) override;
+	AttributeTable const& attributeTable() const noexcept override;
+	static AttributeTable const& classAttributes() noexcept;
 	void getAttributes(AttributeCollectorInterface& collector) override;
 };
 
@@ -2,29 +2,57 @@
 
 #include "Text.hpp"
 
+#include "../TextBuffer.hpp"
+
 #include <functional>
 
 namespace wwidget {
 
-// TODO: add cursor
+/// A single line text input with a cursor and a selection.
+///  Edits only touch the TextBuffer: content() is rebuilt when it's asked for, only new characters are measured,
+///  and onUpdate is called once per batch of edits instead of once per key.
 class TextField : public Text {
 private:
 	std::function<void()> mOnReturn;
 	std::function<void()> mOnUpdate;
+
+	TextBuffer          mBuffer;
+	mutable std::string mContent; //!< mBuffer.str(), rebuilt by content() after edits
+	mutable bool        mContentValid;
+	bool                mUpdatePending; //!< mOnUpdate was deferred and didn't run yet
+
+	std::string mMeasuredFont; //!< Font and size the advances in mBuffer were measured with
+	float       mMeasuredSize;
+	bool        mMeasured;
+	float       mScrollX; //!< Keeps the cursor visible when the text is wider than the field
+	float       mPreferredWidth; //!< Text width the last preferred size was calculated with
+
+	TextBuffer::Measure measure();
+	void ensureMeasured();
+	void edited();
 protected:
+	void setContent(std::string c) override;
+
 	void on(TextInput const& t) override;
 	void on(KeyEvent const& k) override;
+	void on(Click const& click) override;
 
+	PreferredSize onCalcPreferredSize(PreferredSize const& constraints) override;
+	void onContextChanged() override;
 	void onDraw(Canvas& canvas) override;
 	bool onFocus(bool b, FocusType type) override;
+	shared<Widget> onClone() const override;
+	void cloneAttributes(TextField& to) const;
 public:
 	TextField();
 	TextField(Widget* addTo);
 	~TextField();
 
-	std::string const& content() const noexcept { return Text::content(); }
+	std::string const& content() const override;
 	TextField* content(std::string c);
 
+	TextBuffer const& buffer() const noexcept { return mBuffer; }
+
 	TextField* onReturn(std::function<void()> ret);
 	TextField* onUpdate(std::function<void()> update);
 
@@ -38,6 +66,9 @@ public:
 		onUpdate(std::function<void()>([this, cc = std::forward<C>(c)]() { cc(this); }));
 		return this;
 	}
+
+	AttributeTable const& attributeTable() const noexcept override;
+	static AttributeTable const& classAttributes() noexcept;
 };
 
 } // namespace wwidget
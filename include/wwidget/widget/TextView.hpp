@@ -0,0 +1,90 @@
+#pragma once
+
+#include "List.hpp"
+#include "../Canvas.hpp"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace wwidget {
+
+/// Shows large texts like logs or documents, scrolls like a List.
+///  The text is stored as paragraphs which remember where they were broken into lines. Edits only re-wrap the
+///  paragraphs they touch. After a width change paragraphs use an estimated line count until they become visible.
+///  Only the lines inside the visible area are drawn.
+///  The preferred size doesn't depend on the content, use AlignFill or a fixed size.
+class TextView : public List {
+	struct Paragraph {
+		std::string           text;
+		std::vector<uint32_t> lines;           //!< Byte offsets where the lines start
+		float                 wrappedFor = -1; //!< Width the lines were broken for, < 0 if lines.size() is an estimate
+	};
+
+	static constexpr size_t BlockSize = 64; //!< Paragraphs per entry of mBlockLines
+
+	std::vector<Paragraph> mParagraphs;
+	std::vector<size_t>    mBlockLines; //!< Number of lines in each block of BlockSize paragraphs
+	std::vector<Canvas::GlyphRun> mVisibleLines; //!< Drawn with one glyphRuns() call
+	size_t                 mTotalLines;
+	size_t                 mWrapCount; //!< Number of times a paragraph was broken into lines
+
+	Color       mFontColor;
+	float       mFontSize;
+	std::string mFont;
+	bool        mWrap;
+
+	float mWrapWidth;  //!< Width paragraphs are currently wrapped for
+	float mLineHeight;
+	float mAscend;
+	bool  mMetricsChanged;
+
+	void   updateMetrics(Canvas& c);
+	void   invalidate();
+	bool   stale(Paragraph const& p) const noexcept { return p.wrappedFor != mWrapWidth || p.lines.empty(); }
+	size_t lineCountOf(Paragraph const& p) const noexcept; //!< Exact if the paragraph isn't stale(), an estimate otherwise
+	void   wrap(Canvas& c, size_t paragraph);
+	void   rebuildBlocks(size_t firstParagraph, size_t endParagraph); //!< Recounts the blocks of these paragraphs, then sums up all blocks
+	size_t paragraphAt(size_t line, size_t& lineInParagraph) const noexcept;
+
+protected:
+	void onContextChanged() override;
+	void onAdd(Widget& child) override;
+	PreferredSize onCalcPreferredSize(PreferredSize const& constraints) override;
+	void onLayout() override;
+	void onDraw(Canvas& c) override;
+	shared<Widget> onClone() const override;
+	void cloneAttributes(TextView& to) const;
+public:
+	TextView();
+	TextView(Widget* addTo);
+	~TextView();
+
+	TextView& content(std::string_view text);
+	std::string content() const;
+	/// Appends text to the last paragraph, every newline starts a new paragraph
+	TextView& append(std::string_view text);
+	/// Replaces count paragraphs starting at first with the paragraphs in text
+	TextView& replace(size_t first, size_t count, std::string_view text);
+
+	size_t             paragraphs() const noexcept { return mParagraphs.size(); }
+	std::string const& paragraph(size_t i) const { return mParagraphs.at(i).text; }
+	size_t             lineCount() const noexcept { return mTotalLines; } //!< Includes estimates for paragraphs which weren't wrapped yet
+	size_t             wrapCount() const noexcept { return mWrapCount; } //!< For profiling: how often paragraphs were broken into lines
+	float              lineHeight() const noexcept { return mLineHeight; }
+
+	TextView& font(std::string const& name);
+	auto&     font() const noexcept { return mFont; }
+	TextView& fontColor(Color const& c);
+	auto&     fontColor() const noexcept { return mFontColor; }
+	TextView& fontSize(float f);
+	auto      fontSize() const noexcept { return mFontSize; }
+	TextView& wrap(bool b);
+	bool      wrap() const noexcept { return mWrap; }
+
+	AttributeTable const& attributeTable() const noexcept override;
+	static AttributeTable const& classAttributes() noexcept;
+	void getAttributes(AttributeCollectorInterface& collector) override;
+};
+
+} // namespace wwidget
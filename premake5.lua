@@ -46,8 +46,25 @@ function widgetApp(name)
 		includedirs "include"
 end
 
+-- Generates C++ from forms with formcpp, see Form::generateCpp.
+--  Name.form.xml becomes `wwidget::Form& form_Name(wwidget::Form& form)`
+rule "FormCpp"
+	display "Form to C++"
+	fileextension ".xml"
+	buildmessage "Generating C++ from %{file.relpath}"
+	buildcommands '"%{cfg.buildtarget.directory}/formcpp" "%{file.abspath}" "%{cfg.objdir}/%{file.basename}.cpp"'
+	buildinputs "%{cfg.buildtarget.directory}/formcpp"
+	buildoutputs "%{cfg.objdir}/%{file.basename}.cpp"
+
 widgetApp "unittests"
-	files "example/unittests/**.cpp"
+	files { "example/unittests/**.cpp", "example/unittests/**.form.xml" }
+	rules "FormCpp"
+	dependson "formcpp"
+
+widgetApp "benchmarks"
+	files { "example/benchmarks/**.cpp", "example/benchmarks/**.form.xml" }
+	rules "FormCpp"
+	dependson "formcpp"
 
 widgetApp "example1"
 	files "example/1-SimpleUi/**.cpp"
@@ -58,6 +75,10 @@ widgetApp "editor"
 	files "example/editor/**.cpp"
 widgetApp "show"
 	files "example/show/**.cpp"
+widgetApp "formc"
+	files "example/formc/**.cpp"
+widgetApp "formcpp"
+	files "example/formcpp/**.cpp"
 
 widgetApp "piano"
 	files "example/piano/**.cpp"
@@ -0,0 +1,57 @@
+#include "../include/wwidget/AttributeTable.hpp"
+
+namespace wwidget {
+
+// =============================================================
+// == AttributeInfo =============================================
+// =============================================================
+
+bool AttributeInfo::readable() const noexcept {
+	switch(mType) {
+		#define WWIDGET_X(NAME, TYPE, TO) case AttributeType::NAME: return mGetter.get##NAME != nullptr;
+		WWIDGET_ATTRIBUTE_TYPES(WWIDGET_X)
+		#undef WWIDGET_X
+	}
+	return false;
+}
+
+void AttributeInfo::set(Widget& w, Attribute const& value) const {
+	switch(mType) {
+		#define WWIDGET_X(NAME, TYPE, TO) case AttributeType::NAME: mSetter.set##NAME(w, value.TO()); return;
+		WWIDGET_ATTRIBUTE_TYPES(WWIDGET_X)
+		#undef WWIDGET_X
+	}
+}
+
+#define WWIDGET_X(NAME, TYPE, TO) \
+	bool AttributeInfo::set(Widget& w, TYPE value) const { \
+		if(mType != AttributeType::NAME) return false; \
+		mSetter.set##NAME(w, std::move(value)); \
+		return true; \
+	} \
+	bool AttributeInfo::get(Widget const& w, TYPE& value) const { \
+		if(mType != AttributeType::NAME || !mGetter.get##NAME) return false; \
+		value = mGetter.get##NAME(w); \
+		return true; \
+	}
+WWIDGET_ATTRIBUTE_TYPES(WWIDGET_X)
+#undef WWIDGET_X
+
+// =============================================================
+// == AttributeTable =============================================
+// =============================================================
+
+AttributeInfo const* AttributeTable::find(std::string_view name) const noexcept {
+	if(name.empty()) return nullptr;
+	size_t first = slot(name);
+	for(AttributeTable const* table = this; table; table = table->base()) {
+		for(size_t s = first; table->mIndex[s]; s = (s + 1) % IndexSize) {
+			AttributeInfo const& attribute = table->mBegin[table->mIndex[s] - 1];
+			if(attribute.name() == name)
+				return &attribute;
+		}
+	}
+	return nullptr;
+}
+
+} // namespace wwidget
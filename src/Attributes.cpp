@@ -5,6 +5,8 @@ extern "C" {
 	#include <memory.h>
 }
 #include <cctype>
+#include <charconv>
+#include <stdexcept>
 
 namespace wwidget {
 
@@ -15,21 +17,41 @@ std::string to_string(float f) {
 	return result;
 }
 
-size_t parse_float_vector(std::string_view s, std::string_view* end, size_t max_count, float* to) {
+// =============================================================
+// == Numbers =============================================
+// =============================================================
+// std::from_chars doesn't depend on the locale and doesn't allocate, unlike strtof and std::stof
 
-	char* p_end;
+static
+std::string_view skip_spaces(std::string_view s) noexcept {
+	while(!s.empty() && std::isspace((unsigned char) s.front())) s.remove_prefix(1);
+	return s;
+}
+
+/// Reads a number after optional spaces and a '+', which from_chars doesn't accept. Leaves s unchanged if there is none.
+template<class T> static
+std::errc parse_number(std::string_view& s, T& to) noexcept {
+	std::string_view rest = skip_spaces(s);
+	if(!rest.empty() && rest.front() == '+') rest.remove_prefix(1);
+	auto [p_end, error] = std::from_chars(rest.data(), rest.data() + rest.size(), to);
+	if(error == std::errc()) s.remove_prefix(p_end - s.data());
+	return error;
+}
+
+template<class T> static
+T parse_single_number(std::string_view s, const char* type) {
+	T result;
+	std::errc error = parse_number(s, result);
+	if(error == std::errc::result_out_of_range) throw std::out_of_range(std::string("Attribute is out of range for ") + type);
+	if(error != std::errc())                    throw std::invalid_argument(std::string("Attribute isn't a valid ") + type);
+	return result;
+}
 
+/// Reads up to max_count numbers separated by spaces, stops at the first thing which isn't one
+size_t parse_float_vector(std::string_view s, std::string_view* end, size_t max_count, float* to) {
 	size_t i = 0;
-
-	while(!s.empty() && i < max_count) {
-		while(!s.empty() && std::isspace(s.front())) s.remove_prefix(1);
-		to[i] = strtof(s.data(), &p_end);
-		s.remove_prefix(p_end - s.data());
-		++i;
-	}
-
+	while(i < max_count && parse_number(s, to[i]) == std::errc()) ++i;
 	if(end) *end = s;
-
 	return i;
 }
 
@@ -146,9 +168,91 @@ std::string to_string(Point const& p) {
 	return to_string(p.x) + " " + to_string(p.y);
 }
 
+namespace {
+
+struct NamedColor {
+	std::string_view name;
+	Color            color;
+};
+/// The basic colors of CSS
+constexpr NamedColor named_colors[] = {
+	{ "black",       rgb(0x00, 0x00, 0x00) },
+	{ "silver",      rgb(0xC0, 0xC0, 0xC0) },
+	{ "gray",        rgb(0x80, 0x80, 0x80) },
+	{ "grey",        rgb(0x80, 0x80, 0x80) },
+	{ "white",       rgb(0xFF, 0xFF, 0xFF) },
+	{ "maroon",      rgb(0x80, 0x00, 0x00) },
+	{ "red",         rgb(0xFF, 0x00, 0x00) },
+	{ "purple",      rgb(0x80, 0x00, 0x80) },
+	{ "fuchsia",     rgb(0xFF, 0x00, 0xFF) },
+	{ "magenta",     rgb(0xFF, 0x00, 0xFF) },
+	{ "green",       rgb(0x00, 0x80, 0x00) },
+	{ "lime",        rgb(0x00, 0xFF, 0x00) },
+	{ "olive",       rgb(0x80, 0x80, 0x00) },
+	{ "yellow",      rgb(0xFF, 0xFF, 0x00) },
+	{ "navy",        rgb(0x00, 0x00, 0x80) },
+	{ "blue",        rgb(0x00, 0x00, 0xFF) },
+	{ "teal",        rgb(0x00, 0x80, 0x80) },
+	{ "aqua",        rgb(0x00, 0xFF, 0xFF) },
+	{ "cyan",        rgb(0x00, 0xFF, 0xFF) },
+	{ "orange",      rgb(0xFF, 0xA5, 0x00) },
+	{ "transparent", rgba(0x00, 0x00, 0x00, 0) },
+};
+
+int hex_digit(char c) noexcept {
+	if(c >= '0' && c <= '9') return c - '0';
+	if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+	if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+	return -1;
+}
+
+/// '#rgb', '#rgba', '#rrggbb' or '#rrggbbaa', s starts after the '#'
+Color parse_hex_color(std::string_view& s) {
+	uint8_t digits[8];
+	size_t  count = 0;
+	for(; count < s.size() && count < std::size(digits); count++) {
+		int d = hex_digit(s[count]);
+		if(d < 0) break;
+		digits[count] = (uint8_t) d;
+	}
+	s.remove_prefix(count);
+
+	uint8_t c[4] = { 0, 0, 0, 0xFF };
+	switch(count) {
+		case 3: case 4:
+			for(size_t i = 0; i < count; i++) c[i] = digits[i] * 0x11;
+			break;
+		case 6: case 8:
+			for(size_t i = 0; i < count / 2; i++) c[i] = digits[2 * i] * 16 + digits[2 * i + 1];
+			break;
+		default: throw std::runtime_error("Hexadecimal colors only allow the formats '#rgb', '#rgba', '#rrggbb' and '#rrggbbaa'");
+	}
+	return rgba(c[0], c[1], c[2], c[3] / 255.f);
+}
+
+} // namespace
+
 template<>
 Color from_string<Color>(std::string_view s, std::string_view* end) {
-	// TODO: Hexadecimal n stuff
+	s = skip_spaces(s);
+	if(!s.empty() && s.front() == '#') {
+		s.remove_prefix(1);
+		Color result = parse_hex_color(s);
+		if(end) *end = s;
+		return result;
+	}
+	if(!s.empty() && std::isalpha((unsigned char) s.front())) {
+		size_t length = 0;
+		while(length < s.size() && std::isalpha((unsigned char) s[length])) length++;
+		for(auto& named : named_colors) {
+			if(named.name == s.substr(0, length)) {
+				if(end) *end = s.substr(length);
+				return named.color;
+			}
+		}
+		throw std::runtime_error("Unknown color '" + std::string(s.substr(0, length)) + "'");
+	}
+
 	float c[4];
 	size_t count = parse_float_vector(s, end, std::size(c), c);
 	switch(count) {
@@ -156,13 +260,13 @@ Color from_string<Color>(std::string_view s, std::string_view* end) {
 		case 1: return Color(c[0]);
 		case 3: return Color(c[0], c[1], c[2]);
 		case 4: return Color(c[0], c[1], c[2], c[3]);
-		default: throw std::runtime_error("Color only allows the formats '', '<gray>', '<r> <g> <b>' and '<r> <g> <b> <a>'");
+		default: throw std::runtime_error("Color only allows the formats '', '<gray>', '<r> <g> <b>', '<r> <g> <b> <a>', '#rrggbb', '#rrggbbaa' and color names");
 	}
 }
 std::string to_string(Color const& c) {
 	std::string result = to_string(c.r) + " " + to_string(c.g) + " " + to_string(c.b);
 	if(c.a != 1)
-		result = to_string(c.a) + " " + result;
+		result += " " + to_string(c.a);
 	return result;
 }
 
@@ -292,7 +396,9 @@ TinyString::TinyString(TinyString&& s) noexcept :
 {
 	s.mData = empty_string;
 }
-TinyString::TinyString(TinyString const& s) noexcept {
+TinyString::TinyString(TinyString const& s) noexcept :
+	TinyString()
+{
 	reset(s.data(), s.length());
 }
 TinyString& TinyString::operator=(TinyString&& s) noexcept {
@@ -360,9 +466,9 @@ Alignment     StringAttribute::toAlignment() const { return from_string<Alignmen
 Padding       StringAttribute::toPadding() const { return from_string<Padding>(value); }
 Flow          StringAttribute::toFlow() const { return from_string<Flow>(value); }
 
-std::string   StringAttribute::toString() const { return value; }
-float         StringAttribute::toFloat() const { return std::stof(value); }
+std::string   StringAttribute::toString() const { return std::string(value); }
+float         StringAttribute::toFloat() const { return parse_single_number<float>(value, "Float"); }
 bool          StringAttribute::toBool() const { return value == "true" || value == "1"; }
-int64_t       StringAttribute::toInt() const { return std::stoll(value); }
+int64_t       StringAttribute::toInt() const { return parse_single_number<int64_t>(value, "Int"); }
 
 } // namespace wwidget
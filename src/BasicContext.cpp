@@ -1,19 +1,50 @@
 #include "../include/wwidget/BasicContext.hpp"
 
 #include "../include/wwidget/Canvas.hpp"
+#include "../include/wwidget/CanvasRecorder.hpp"
 
 #include "../include/wwidget/Bitmap.hpp"
 #include "../include/wwidget/Font.hpp"
+#include "../include/wwidget/InputQueue.hpp"
+#include "../include/wwidget/LayerCache.hpp"
+#include "../include/wwidget/TextMetricsCache.hpp"
 
 #include "../include/wwidget/async/Threadpool.hpp"
 #include "../include/wwidget/async/Queue.hpp"
 
 #include <GL/gl.h>
 
+#include <condition_variable>
 #include <unordered_map>
 
 namespace wwidget {
 
+namespace {
+
+/// Stands in for the window in headless mode
+class HeadlessFrame : public Widget {
+	Size mFrame;
+protected:
+	PreferredSize onCalcPreferredSize(PreferredSize const& constraint) override {
+		return { mFrame, mFrame, mFrame };
+	}
+	void onLayout() override {
+		for(Widget* child = children().get(); child; child = child->nextSibling().get()) {
+			child->preferredSize({size()}); // Like every parent does, some widgets update their state in it
+			child->offset(0, 0);
+			child->size(size());
+		}
+	}
+public:
+	void frame(Size const& s) {
+		mFrame = s;
+		preferredSizeChanged();
+		requestRelayout();
+	}
+};
+
+} // namespace
+
 struct BasicContext::Implementation {
 	struct {
 		std::mutex                                             mutex;
@@ -24,14 +55,35 @@ struct BasicContext::Implementation {
 	} cache;
 
 	Threadpool              threadpool;
-	TaskQueue               updateTasks;
+	TaskQueue               updateTasks[TaskPriorityCount];
+	TaskStats               taskStats;
+	std::chrono::microseconds taskBudget { 4000 }; // A quarter of a frame at 60Hz
+
+	InputQueue              input;
 
 	shared<Canvas> canvas;
+	TextMetricsCache        textMetrics;
+	LayerCache              layers; // Before the widgets, which unregister from it when they are destroyed
 	Widget*                 rootWidget = nullptr;
 
 
 	std::string defaultFont;
 
+	// Render on demand
+	bool              renderOnDemand = false;
+	bool              redraw         = true; // Until the first frame
+	Size              lastFrameSize;
+	Clock::time_point frameDeadline  = Clock::time_point::max();
+
+	struct {
+		std::mutex              mutex;
+		std::condition_variable condition;
+		bool                    woken = false;
+	} wait;
+
+	shared<CanvasRecorder>  headlessCanvas;
+	shared<HeadlessFrame>   headlessFrame; // Last, so it's destroyed before everything its children might use
+
 	Implementation() :
 		threadpool(std::max(1u, std::thread::hardware_concurrency() - 1))
 	{}
@@ -41,8 +93,12 @@ BasicContext::BasicContext() :
 	mImpl(new Implementation)
 {
 	mImpl->defaultFont = "/usr/share/fonts/TTF/LiberationMono-Regular.ttf"; // TODO: Font path not cross platform;
+	for(auto& tasks : mImpl->updateTasks)
+		tasks.wakeup([this]() { wakeup(); });
 }
 BasicContext::~BasicContext() {
+	// The root may outlive the context, it mustn't unregister itself from the input queue and layer cache later
+	rootWidget(nullptr);
 	delete mImpl;
 }
 
@@ -60,7 +116,10 @@ void BasicContext::cleanCache() {
 }
 
 void BasicContext::defer(std::function<void()> fn) {
-	mImpl->updateTasks.add(std::move(fn));
+	defer(TaskPriority::Layout, std::move(fn));
+}
+void BasicContext::defer(TaskPriority priority, std::function<void()> fn) {
+	mImpl->updateTasks[(size_t) priority].add(std::move(fn));
 }
 
 void BasicContext::loadImage(std::function<void(shared<Bitmap>)> fn, std::string const& url) {
@@ -87,7 +146,7 @@ void BasicContext::loadImage(std::function<void(shared<Bitmap>)> fn, std::string
 				fprintf(stderr, "%s\n", e.what());
 			}
 
-			defer([fn = std::move(fn), s = std::move(s), url = std::move(url)]() {
+			defer(TaskPriority::Background, [fn = std::move(fn), s = std::move(s), url = std::move(url)]() {
 				// printf("Invoking callback for %s\n", url.c_str());
 				fn(std::move(s));
 				// printf("Finished loading %s\n", url.c_str());
@@ -126,22 +185,117 @@ void BasicContext::execute(Widget* from, std::string_view const* cmds, size_t co
 }
 
 bool BasicContext::update() {
+	using Clock = TaskQueue::Clock;
+
+	auto& stats    = mImpl->taskStats;
+	auto  deadline = Clock::now() + mImpl->taskBudget;
+	stats = {};
+
+	// Widgets don't all request a redraw when they handle input
+	if(!mImpl->input.empty() && rootWidget() && mImpl->input.dispatch(*rootWidget()) > 0)
+		mImpl->redraw = true;
+
 	bool a, b;
+	bool executedAny = false;
 	unsigned count = 0;
 	do {
-		a = 0 < mImpl->updateTasks.executeSingleConsumer();
+		a = false;
+		for(size_t i = 0; i < TaskPriorityCount; i++) {
+			auto&  tasks    = mImpl->updateTasks[i];
+			size_t executed = i == (size_t) TaskPriority::Input ?
+				tasks.executeSingleConsumer() :
+				tasks.executeSingleConsumer(deadline);
+			stats.executed[i] += executed;
+			a = a || executed > 0;
+		}
+		executedAny = executedAny || a;
 		b = rootWidget() ? rootWidget()->updateLayout() : false;
 		++count;
-	} while((a || b) && count < 100);
+	} while((a || b) && count < 100 && Clock::now() < deadline);
 
-	return count > 1;
+	bool carriedOver = false;
+	for(size_t i = 0; i < TaskPriorityCount; i++) {
+		stats.carriedOver[i] = mImpl->updateTasks[i].size();
+		carriedOver = carriedOver || stats.carriedOver[i] > 0;
+	}
+	// The queues don't signal again until they were emptied, so make sure the next wait for events doesn't block
+	if(carriedOver) wakeup();
+	// Tasks don't have to request a redraw for what they changed
+	if(executedAny) mImpl->redraw = true;
+
+	return count > 1 || carriedOver;
+}
+BasicContext::TaskStats const& BasicContext::taskStats() const noexcept {
+	return mImpl->taskStats;
+}
+
+void BasicContext::taskBudget(std::chrono::microseconds budget) noexcept {
+	mImpl->taskBudget = budget;
+}
+std::chrono::microseconds BasicContext::taskBudget() const noexcept {
+	return mImpl->taskBudget;
 }
 void BasicContext::draw(float dpi) {
 	if(mImpl->canvas && rootWidget()) {
+		if(mImpl->renderOnDemand && !needsDraw()) return;
+		mImpl->redraw = false;
+		if(mImpl->frameDeadline <= Clock::now())
+			mImpl->frameDeadline = Clock::time_point::max();
+
+		rootWidget()->updateLayout();
+		mImpl->layers.render(*mImpl->canvas, rootWidget());
 		canvas().beginFrame(rootWidget()->size(), dpi);
 		rootWidget()->draw(*mImpl->canvas);
 		canvas().endFrame();
+		mImpl->lastFrameSize = rootWidget()->size();
+	}
+}
+
+void BasicContext::renderOnDemand(bool b) noexcept {
+	mImpl->renderOnDemand = b;
+	mImpl->redraw = true;
+}
+bool BasicContext::renderOnDemand() const noexcept {
+	return mImpl->renderOnDemand;
+}
+bool BasicContext::needsDraw() const noexcept {
+	Widget const* root = mImpl->rootWidget;
+	if(!mImpl->canvas || !root) return false;
+	return
+		mImpl->redraw ||
+		root->needsRelayout() || root->childNeedsRelayout() ||
+		root->needsRedraw() || root->childNeedsRedraw() ||
+		root->size() != mImpl->lastFrameSize ||
+		mImpl->frameDeadline <= Clock::now();
+}
+void BasicContext::redraw() noexcept {
+	mImpl->redraw = true;
+}
+
+void BasicContext::requestFrame(Clock::time_point when) {
+	mImpl->frameDeadline = std::min(mImpl->frameDeadline, when);
+}
+BasicContext::Clock::time_point BasicContext::frameDeadline() const noexcept {
+	return mImpl->frameDeadline;
+}
+
+void BasicContext::waitEvents() {
+	if(needsDraw()) return;
+
+	auto& wait  = mImpl->wait;
+	auto  lock  = std::unique_lock<std::mutex>(wait.mutex);
+	auto  woken = [&]() { return wait.woken; };
+	if(mImpl->frameDeadline == Clock::time_point::max())
+		wait.condition.wait(lock, woken);
+	else
+		wait.condition.wait_until(lock, mImpl->frameDeadline, woken);
+	wait.woken = false;
+}
+void BasicContext::wakeup() {
+	{ auto lock = std::unique_lock<std::mutex>(mImpl->wait.mutex);
+		mImpl->wait.woken = true;
 	}
+	mImpl->wait.condition.notify_one();
 }
 
 void    BasicContext::rootWidget(Widget* w) {
@@ -149,17 +303,47 @@ void    BasicContext::rootWidget(Widget* w) {
 		mImpl->rootWidget->context(nullptr);
 	}
 	mImpl->rootWidget = w;
-	w->context(this);
+	if(w) w->context(this);
 }
 Widget* BasicContext::rootWidget() {
 	return mImpl->rootWidget;
 }
 
 void BasicContext::canvas(shared<Canvas> c) noexcept {
+	if(mImpl->canvas != c) {
+		mImpl->textMetrics.clear();
+		mImpl->layers.clear();
+		mImpl->redraw = true;
+	}
 	mImpl->canvas = c;
 }
 Canvas& BasicContext::canvas() const noexcept {
 	return *mImpl->canvas;
 }
 
+shared<CanvasRecorder> BasicContext::headless(Size const& frameSize) {
+	if(!mImpl->headlessFrame) {
+		mImpl->headlessFrame = make_shared<HeadlessFrame>();
+		rootWidget(mImpl->headlessFrame.get());
+		mImpl->headlessCanvas = make_shared<CanvasRecorder>();
+		canvas(mImpl->headlessCanvas);
+	}
+	mImpl->headlessFrame->frame(frameSize);
+	return mImpl->headlessCanvas;
+}
+bool BasicContext::headless() const noexcept {
+	return mImpl->headlessFrame != nullptr;
+}
+
+InputQueue& BasicContext::input() noexcept {
+	return mImpl->input;
+}
+
+TextMetricsCache& BasicContext::textMetrics() noexcept {
+	return mImpl->textMetrics;
+}
+LayerCache& BasicContext::layers() noexcept {
+	return mImpl->layers;
+}
+
 } // namespace wwidget
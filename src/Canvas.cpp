@@ -1,4 +1,5 @@
 #include "../include/wwidget/Canvas.hpp"
+#include "../include/wwidget/Bitmap.hpp"
 #include "../include/wwidget/Error.hpp"
 #include "../include/wwidget/Font.hpp"
 
@@ -13,6 +14,70 @@
 
 namespace wwidget {
 
+void Canvas::textBreakLines(std::string_view txt, float maxWidth, std::vector<uint32_t>& lineStarts) {
+	lineStarts.push_back(0);
 
+	float  lineWidth = 0;
+	size_t pos = 0;
+	while(pos < txt.size()) {
+		// A word including the spaces after it
+		size_t end = txt.find(' ', pos);
+		end = end == std::string_view::npos ? txt.size() : txt.find_first_not_of(' ', end);
+		if(end == std::string_view::npos) end = txt.size();
+
+		float w = textBounds({}, txt.substr(pos, end - pos)).width();
+		if(lineWidth > 0 && lineWidth + w > maxWidth) {
+			lineStarts.push_back((uint32_t) pos);
+			lineWidth = 0;
+		}
+		lineWidth += w;
+		pos = end;
+	}
+}
+
+Canvas& Canvas::rects(Rect const* areas, Color const* colors, size_t count) {
+	if(count == 0) return *this;
+
+	if(!colors) {
+		for(size_t i = 0; i < count; i++)
+			rect(areas[i]);
+		return fill();
+	}
+
+	for(size_t i = 0; i < count; i++)
+		fillColor(colors[i]).rect(areas[i]).fill();
+	return *this;
+}
+Canvas& Canvas::polyline(Point const* points, size_t count) {
+	if(count < 2) return *this;
+
+	moveTo(points[0]);
+	for(size_t i = 1; i < count; i++)
+		lineTo(points[i]);
+	return stroke();
+}
+Canvas& Canvas::texturedQuads(shared<Bitmap> const& bm, TexturedQuad const* quads, size_t count, Color const& tint) {
+	for(size_t i = 0; i < count; i++) {
+		fillTexture(quads[i].mapping(bm->width(), bm->height()), bm, tint)
+		.rect(quads[i].to)
+		.fill();
+	}
+	return *this;
+}
+Canvas& Canvas::glyphRuns(GlyphRun const* runs, size_t count) {
+	for(size_t i = 0; i < count; i++)
+		text(runs[i].position, runs[i].text);
+	return *this;
+}
+
+bool Canvas::beginLayer(Layer& layer, unsigned width, unsigned height) {
+	return false;
+}
+Canvas& Canvas::endLayer() {
+	return *this;
+}
+Canvas& Canvas::drawLayer(Layer const& layer, Rect const& to) {
+	return *this;
+}
 
 } // namespace wwidget
@@ -0,0 +1,421 @@
+#include "../include/wwidget/CanvasRecorder.hpp"
+
+#include "../include/wwidget/Bitmap.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace wwidget {
+
+CanvasRecorder::CanvasRecorder() :
+	mRecordLog(true),
+	mFrames(0),
+	mMeasurements(0),
+	mFillTexture(nullptr),
+	mStrokeTexture(nullptr),
+	mBoundTexture(nullptr),
+	mFontSize(18),
+	mLetterSpacing(0),
+	mLineHeight(1),
+	mLayers(0)
+{}
+CanvasRecorder::~CanvasRecorder() {}
+
+// =============================================================
+// == Recording =============================================
+// =============================================================
+
+bool CanvasRecorder::begin(const char* cmd, std::initializer_list<float> args) {
+	mCurrent.commands++;
+	if(!mRecordLog) return false;
+
+	mLog += cmd;
+	append(args);
+	return true;
+}
+void CanvasRecorder::append(std::initializer_list<float> args) {
+	char buffer[32];
+	for(float f : args) {
+		snprintf(buffer, sizeof(buffer), " %g", f == 0 ? 0.f : f); // No "-0"
+		mLog += buffer;
+	}
+}
+void CanvasRecorder::append(std::string_view txt) {
+	mLog += " \"";
+	for(char c : txt) {
+		switch(c) {
+			case '"':  mLog += "\\\""; break;
+			case '\\': mLog += "\\\\"; break;
+			case '\n': mLog += "\\n"; break;
+			default:   mLog += c; break;
+		}
+	}
+	mLog += '"';
+}
+void CanvasRecorder::append(Color const& color) {
+	auto byte = [](float f) { return (unsigned) std::lround(std::clamp(f, 0.f, 1.f) * 255); };
+	char buffer[16];
+	snprintf(buffer, sizeof(buffer), " #%02x%02x%02x%02x", byte(color.r), byte(color.g), byte(color.b), byte(color.a));
+	mLog += buffer;
+}
+void CanvasRecorder::append(Bitmap const* bm) {
+	size_t id = bm ? mTextureIds.emplace(bm, mTextureIds.size() + 1).first->second : 0;
+	char buffer[64];
+	snprintf(buffer, sizeof(buffer), " texture%zu(%ux%u)", id, bm ? bm->width() : 0, bm ? bm->height() : 0);
+	mLog += buffer;
+}
+
+void CanvasRecorder::record(const char* cmd, std::initializer_list<float> args) {
+	if(begin(cmd, args)) mLog += '\n';
+}
+void CanvasRecorder::record(const char* cmd, std::initializer_list<float> args, std::string_view txt) {
+	if(!begin(cmd, args)) return;
+	append(txt);
+	mLog += '\n';
+}
+void CanvasRecorder::record(const char* cmd, Color const& color) {
+	if(!begin(cmd, {})) return;
+	append(color);
+	mLog += '\n';
+}
+void CanvasRecorder::record(const char* cmd, Rect const& to, Bitmap const* bm, Color const& tint) {
+	if(!begin(cmd, { to.min.x, to.min.y, to.width(), to.height() })) return;
+	append(bm);
+	append(tint);
+	mLog += '\n';
+}
+
+void CanvasRecorder::bind(void const* texture) {
+	if(texture && texture != mBoundTexture) {
+		mBoundTexture = texture;
+		mCurrent.textureBinds++;
+	}
+}
+
+// =============================================================
+// == Frame & State =============================================
+// =============================================================
+
+Canvas& CanvasRecorder::beginFrame(Size const& frame_size, float dpi) {
+	mLog.clear();
+	mCurrent      = {};
+	mBoundTexture = nullptr;
+	record("beginFrame", { frame_size.x, frame_size.y });
+	return *this;
+}
+Canvas& CanvasRecorder::endFrame() {
+	record("endFrame");
+	mLast = mCurrent;
+	mFrames++;
+	return *this;
+}
+Canvas& CanvasRecorder::cancelFrame() {
+	record("cancelFrame");
+	mLast = mCurrent;
+	mFrames++;
+	return *this;
+}
+
+Canvas& CanvasRecorder::pushState() {
+	mCurrent.statePushes++;
+	record("pushState");
+	return *this;
+}
+Canvas& CanvasRecorder::popState() {
+	record("popState");
+	return *this;
+}
+Canvas& CanvasRecorder::resetState() {
+	record("resetState");
+	return *this;
+}
+
+Canvas& CanvasRecorder::scissor(Rect const& area) {
+	mCurrent.scissors++;
+	record("scissor", { area.min.x, area.min.y, area.width(), area.height() });
+	return *this;
+}
+Canvas& CanvasRecorder::scissorIntersect(Rect const& area) {
+	mCurrent.scissors++;
+	record("scissorIntersect", { area.min.x, area.min.y, area.width(), area.height() });
+	return *this;
+}
+Canvas& CanvasRecorder::resetScissor() {
+	record("resetScissor");
+	return *this;
+}
+
+Canvas& CanvasRecorder::resetTransform() {
+	record("resetTransform");
+	return *this;
+}
+Canvas& CanvasRecorder::translate(float x, float y) {
+	record("translate", { x, y });
+	return *this;
+}
+Canvas& CanvasRecorder::scale(float x, float y) {
+	record("scale", { x, y });
+	return *this;
+}
+
+// Properties
+Canvas& CanvasRecorder::lineWidth(float f) {
+	record("lineWidth", { f });
+	return *this;
+}
+Canvas& CanvasRecorder::fillColor(Color const& color) {
+	mFillTexture = nullptr;
+	record("fillColor", color);
+	return *this;
+}
+Canvas& CanvasRecorder::fillTexture(Rect const& to, shared<Bitmap> const& bm, Color const& tint) {
+	mFillTexture = bm.get();
+	record("fillTexture", to, bm.get(), tint);
+	return *this;
+}
+Canvas& CanvasRecorder::strokeColor(Color const& color) {
+	mStrokeTexture = nullptr;
+	record("strokeColor", color);
+	return *this;
+}
+Canvas& CanvasRecorder::strokeTexture(Rect const& to, shared<Bitmap> const& bm, Color const& tint) {
+	mStrokeTexture = bm.get();
+	record("strokeTexture", to, bm.get(), tint);
+	return *this;
+}
+
+// Shapes
+Canvas& CanvasRecorder::rect(Rect const& area) {
+	record("rect", { area.min.x, area.min.y, area.width(), area.height() });
+	return *this;
+}
+Canvas& CanvasRecorder::rect(Rect const& area, float radius) {
+	record("roundedRect", { area.min.x, area.min.y, area.width(), area.height(), radius });
+	return *this;
+}
+Canvas& CanvasRecorder::circle(Point const& center, float r) {
+	record("circle", { center.x, center.y, r });
+	return *this;
+}
+Canvas& CanvasRecorder::elipse(Point const& center, float rx, float ry) {
+	record("elipse", { center.x, center.y, rx, ry });
+	return *this;
+}
+Canvas& CanvasRecorder::arc(Point const& center, float radius, float from_angle, float to_angle, bool counter_clockwise) {
+	record(counter_clockwise ? "arcCCW" : "arc", { center.x, center.y, radius, from_angle, to_angle });
+	return *this;
+}
+
+// Path
+Canvas& CanvasRecorder::moveTo(Point const& p) {
+	record("moveTo", { p.x, p.y });
+	return *this;
+}
+Canvas& CanvasRecorder::lineTo(Point const& p) {
+	record("lineTo", { p.x, p.y });
+	return *this;
+}
+
+// =============================================================
+// == Text =============================================
+// =============================================================
+
+Canvas& CanvasRecorder::registerFont(const char* name, const char* path) {
+	record("registerFont", {}, name);
+	return *this;
+}
+Canvas& CanvasRecorder::font(const char* name) {
+	record("font", {}, *name ? name : "sans");
+	return *this;
+}
+Canvas& CanvasRecorder::fontSize(float f) {
+	mFontSize = f != 0 ? f : 18;
+	record("fontSize", { f });
+	return *this;
+}
+Canvas& CanvasRecorder::fontBlur(float f) {
+	record("fontBlur", { f });
+	return *this;
+}
+Canvas& CanvasRecorder::fontLetterSpacing(float f) {
+	mLetterSpacing = f;
+	record("fontLetterSpacing", { f });
+	return *this;
+}
+Canvas& CanvasRecorder::fontLineHeight(float f) {
+	mLineHeight = f;
+	record("fontLineHeight", { f });
+	return *this;
+}
+
+Canvas& CanvasRecorder::text(Point const& position, std::string_view txt) {
+	mCurrent.textRuns++;
+	record("text", { position.x, position.y }, txt);
+	return *this;
+}
+Canvas& CanvasRecorder::textBox(Point const& position, float maxWidth, std::string_view txt) {
+	mCurrent.textRuns++;
+	record("textBox", { position.x, position.y, maxWidth }, txt);
+	return *this;
+}
+
+float CanvasRecorder::advance(std::string_view txt) const noexcept {
+	size_t characters = std::count_if(txt.begin(), txt.end(), [](char c) { return (c & 0xC0) != 0x80; });
+	return characters * (mFontSize * .5f + mLetterSpacing);
+}
+
+Rect CanvasRecorder::textBounds(Point const& position, std::string_view txt) {
+	mMeasurements++;
+	FontMetrics m = fontMetrics();
+	mMeasurements--;
+	return Rect::absolute(position.x, position.y - m.ascend, position.x + advance(txt), position.y - m.descend);
+}
+Rect CanvasRecorder::textBoxBounds(Point const& position, float maxWidth, std::string_view txt) {
+	FontMetrics m = fontMetrics();
+
+	float  width = 0;
+	size_t lines = 0;
+	std::vector<uint32_t> starts;
+	size_t begin = 0;
+	while(begin <= txt.size()) {
+		size_t end = std::min(txt.find('\n', begin), txt.size());
+		std::string_view paragraph = txt.substr(begin, end - begin);
+
+		starts.clear();
+		textBreakLines(paragraph, maxWidth, starts);
+		for(size_t i = 0; i < starts.size(); i++) {
+			size_t lineEnd = i + 1 < starts.size() ? starts[i + 1] : paragraph.size();
+			width = std::max(width, advance(paragraph.substr(starts[i], lineEnd - starts[i])));
+		}
+		lines += starts.size();
+		begin = end + 1;
+	}
+
+	return Rect::absolute(
+		position.x, position.y - m.ascend,
+		position.x + width, position.y - m.descend + (lines - 1) * m.line_height * mLineHeight
+	);
+}
+FontMetrics CanvasRecorder::fontMetrics() {
+	mMeasurements++;
+	return { mFontSize * .75f, mFontSize * -.25f, mFontSize };
+}
+
+// =============================================================
+// == Commit =============================================
+// =============================================================
+
+Canvas& CanvasRecorder::fill() {
+	mCurrent.fills++;
+	bind(mFillTexture);
+	record("fill");
+	return *this;
+}
+Canvas& CanvasRecorder::fillPreserve() {
+	mCurrent.fills++;
+	bind(mFillTexture);
+	record("fillPreserve");
+	return *this;
+}
+Canvas& CanvasRecorder::stroke() {
+	mCurrent.strokes++;
+	bind(mStrokeTexture);
+	record("stroke");
+	return *this;
+}
+Canvas& CanvasRecorder::strokePreserve() {
+	mCurrent.strokes++;
+	bind(mStrokeTexture);
+	record("strokePreserve");
+	return *this;
+}
+
+// =============================================================
+// == Batches =============================================
+// =============================================================
+
+Canvas& CanvasRecorder::rects(Rect const* areas, Color const* colors, size_t count) {
+	mCurrent.fills++;
+	if(colors) mFillTexture = nullptr;
+	bind(mFillTexture);
+	if(!begin("rects", { (float) count })) return *this;
+
+	mLog += '\n';
+	for(size_t i = 0; i < count; i++) {
+		mLog += ' ';
+		append({ areas[i].min.x, areas[i].min.y, areas[i].width(), areas[i].height() });
+		if(colors) append(colors[i]);
+		mLog += '\n';
+	}
+	return *this;
+}
+Canvas& CanvasRecorder::polyline(Point const* points, size_t count) {
+	mCurrent.strokes++;
+	bind(mStrokeTexture);
+	if(!begin("polyline", { (float) count })) return *this;
+
+	mLog += '\n';
+	for(size_t i = 0; i < count; i++) {
+		mLog += ' ';
+		append({ points[i].x, points[i].y });
+		mLog += '\n';
+	}
+	return *this;
+}
+Canvas& CanvasRecorder::texturedQuads(shared<Bitmap> const& bm, TexturedQuad const* quads, size_t count, Color const& tint) {
+	mCurrent.fills++;
+	mFillTexture = bm.get();
+	bind(mFillTexture);
+	if(!begin("texturedQuads", { (float) count })) return *this;
+
+	append(bm.get());
+	append(tint);
+	mLog += '\n';
+	for(size_t i = 0; i < count; i++) {
+		auto& q = quads[i];
+		mLog += ' ';
+		append({ q.to.min.x, q.to.min.y, q.to.width(), q.to.height(), q.from.min.x, q.from.min.y, q.from.width(), q.from.height() });
+		mLog += '\n';
+	}
+	return *this;
+}
+Canvas& CanvasRecorder::glyphRuns(GlyphRun const* runs, size_t count) {
+	mCurrent.textRuns++;
+	if(!begin("glyphRuns", { (float) count })) return *this;
+
+	mLog += '\n';
+	for(size_t i = 0; i < count; i++) {
+		mLog += ' ';
+		append({ runs[i].position.x, runs[i].position.y });
+		append(runs[i].text);
+		mLog += '\n';
+	}
+	return *this;
+}
+
+// =============================================================
+// == Layers =============================================
+// =============================================================
+
+bool CanvasRecorder::beginLayer(Layer& layer, unsigned width, unsigned height) {
+	if(!layer.handle) layer.handle = make_shared<size_t>(++mLayers).cast_static<void>();
+	layer.width  = width;
+	layer.height = height;
+	record("beginLayer", { (float) *layer.handle.cast_static<size_t>(), (float) width, (float) height });
+	return true;
+}
+Canvas& CanvasRecorder::endLayer() {
+	record("endLayer");
+	return *this;
+}
+Canvas& CanvasRecorder::drawLayer(Layer const& layer, Rect const& to) {
+	mCurrent.fills++;
+	bind(layer.handle.get());
+	size_t id = layer.handle ? *layer.handle.cast_static<size_t>() : 0;
+	record("drawLayer", { (float) id, to.min.x, to.min.y, to.width(), to.height() });
+	return *this;
+}
+
+} // namespace wwidget
@@ -0,0 +1,907 @@
+#include "../include/wwidget/CanvasSoftware.hpp"
+#include "../include/wwidget/Font.hpp"
+#include "../include/wwidget/Error.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+	#include <emmintrin.h>
+	#define WWIDGET_SOFTWARE_SSE2 1
+#endif
+
+namespace wwidget {
+
+namespace {
+
+constexpr float Pi        = 3.14159265358979f;
+constexpr float Tolerance = .1f; //!< Maximum distance in pixels between a curve and its flattened polygon
+
+/// Premultiplied RGBA, 0 to 255
+struct Color16 {
+	uint16_t rgba[4];
+
+	Color16(Color const& c, float alpha = 1) noexcept {
+		float a = std::clamp(c.a * alpha, 0.f, 1.f);
+		rgba[0] = (uint16_t) std::lround(std::clamp(c.r, 0.f, 1.f) * a * 255);
+		rgba[1] = (uint16_t) std::lround(std::clamp(c.g, 0.f, 1.f) * a * 255);
+		rgba[2] = (uint16_t) std::lround(std::clamp(c.b, 0.f, 1.f) * a * 255);
+		rgba[3] = (uint16_t) std::lround(a * 255);
+	}
+
+	uint32_t packed() const noexcept {
+		uint8_t bytes[4] = { (uint8_t) rgba[0], (uint8_t) rgba[1], (uint8_t) rgba[2], (uint8_t) rgba[3] };
+		uint32_t result;
+		memcpy(&result, bytes, 4);
+		return result;
+	}
+};
+
+/// x / 255 for x in [0, 255 * 255], rounded
+inline unsigned div255(unsigned x) noexcept {
+	x += 128;
+	return (x + (x >> 8)) >> 8;
+}
+
+/// dst = src * coverage + dst * (1 - src.a * coverage), src premultiplied
+inline void blendPixel(uint8_t* dst, uint16_t const* src, unsigned coverage) noexcept {
+	unsigned a   = div255(src[3] * coverage);
+	unsigned inv = 255 - a;
+	for(int k = 0; k < 4; k++) {
+		dst[k] = (uint8_t) (div255(src[k] * coverage) + div255(dst[k] * inv));
+	}
+}
+
+#ifdef WWIDGET_SOFTWARE_SSE2
+inline __m128i div255(__m128i x) noexcept {
+	x = _mm_add_epi16(x, _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+#endif
+
+/// Blends a solid color into n pixels, each with its own coverage
+void blendSolid(uint32_t* dst, uint8_t const* coverage, int n, Color16 const& color) {
+	int i = 0;
+	bool     opaque = color.rgba[3] == 255;
+	uint32_t packed = color.packed();
+
+#ifdef WWIDGET_SOFTWARE_SSE2
+	__m128i zero = _mm_setzero_si128();
+	__m128i c255 = _mm_set1_epi16(255);
+	__m128i col  = _mm_set_epi16(
+		color.rgba[3], color.rgba[2], color.rgba[1], color.rgba[0],
+		color.rgba[3], color.rgba[2], color.rgba[1], color.rgba[0]);
+
+	for(; i + 4 <= n; i += 4) {
+		uint32_t cov4;
+		memcpy(&cov4, coverage + i, 4);
+		if(cov4 == 0) continue;
+		if(opaque && cov4 == 0xFFFFFFFF) {
+			dst[i] = dst[i + 1] = dst[i + 2] = dst[i + 3] = packed;
+			continue;
+		}
+
+		short c0 = coverage[i], c1 = coverage[i + 1], c2 = coverage[i + 2], c3 = coverage[i + 3];
+		__m128i cov_lo = _mm_set_epi16(c1, c1, c1, c1, c0, c0, c0, c0);
+		__m128i cov_hi = _mm_set_epi16(c3, c3, c3, c3, c2, c2, c2, c2);
+
+		// Source, premultiplied and scaled by coverage
+		__m128i src_lo = div255(_mm_mullo_epi16(col, cov_lo));
+		__m128i src_hi = div255(_mm_mullo_epi16(col, cov_hi));
+		__m128i inv_lo = _mm_sub_epi16(c255, _mm_shufflehi_epi16(_mm_shufflelo_epi16(src_lo, 0xFF), 0xFF));
+		__m128i inv_hi = _mm_sub_epi16(c255, _mm_shufflehi_epi16(_mm_shufflelo_epi16(src_hi, 0xFF), 0xFF));
+
+		__m128i d      = _mm_loadu_si128((__m128i const*)(dst + i));
+		__m128i dst_lo = _mm_unpacklo_epi8(d, zero);
+		__m128i dst_hi = _mm_unpackhi_epi8(d, zero);
+		dst_lo = _mm_add_epi16(src_lo, div255(_mm_mullo_epi16(dst_lo, inv_lo)));
+		dst_hi = _mm_add_epi16(src_hi, div255(_mm_mullo_epi16(dst_hi, inv_hi)));
+		_mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(dst_lo, dst_hi));
+	}
+#endif
+
+	for(; i < n; i++) {
+		if(coverage[i] == 0) continue;
+		if(opaque && coverage[i] == 255) { dst[i] = packed; continue; }
+		blendPixel((uint8_t*)(dst + i), color.rgba, coverage[i]);
+	}
+}
+
+/// Blends premultiplied pixels into n pixels, each with its own coverage
+void blendTexels(uint32_t* dst, uint32_t const* src, uint8_t const* coverage, int n) {
+	for(int i = 0; i < n; i++) {
+		if(coverage[i] == 0) continue;
+		uint8_t const* p = (uint8_t const*) (src + i);
+		if(p[3] == 255 && coverage[i] == 255) { dst[i] = src[i]; continue; }
+		if(p[3] == 0) continue;
+		uint16_t texel[4] = { p[0], p[1], p[2], p[3] };
+		blendPixel((uint8_t*)(dst + i), texel, coverage[i]);
+	}
+}
+
+/// Bilinear sample at pixel coordinates (pixel centers at .5), premultiplied RGBA 0 to 255
+void sample(Bitmap const& bm, float u, float v, float out[4], bool premultiplied) {
+	int w = (int) bm.width(), h = (int) bm.height();
+	u = std::clamp(u - .5f, 0.f, w - 1.f);
+	v = std::clamp(v - .5f, 0.f, h - 1.f);
+	int   x0 = (int) u, y0 = (int) v;
+	int   x1 = std::min(x0 + 1, w - 1), y1 = std::min(y0 + 1, h - 1);
+	float fx = u - x0, fy = v - y0;
+
+	auto texel = [&](int x, int y, float weight) {
+		uint8_t const* p = bm.data() + (size_t(y) * w + x) * (unsigned) bm.format();
+		switch(bm.format()) {
+			case Bitmap::ALPHA: // An alpha mask, tinted by the paint
+				for(int k = 0; k < 4; k++) out[k] += p[0] * weight;
+				break;
+			case Bitmap::RGB:
+				for(int k = 0; k < 3; k++) out[k] += p[k] * weight;
+				out[3] += 255 * weight;
+				break;
+			case Bitmap::RGBA:
+				for(int k = 0; k < 3; k++) out[k] += p[k] * (premultiplied ? 1.f : p[3] / 255.f) * weight;
+				out[3] += p[3] * weight;
+				break;
+			default: break;
+		}
+	};
+	out[0] = out[1] = out[2] = out[3] = 0;
+	texel(x0, y0, (1 - fx) * (1 - fy));
+	texel(x1, y0, fx * (1 - fy));
+	texel(x0, y1, (1 - fx) * fy);
+	texel(x1, y1, fx * fy);
+}
+
+/// Bilinear sample of an ALPHA bitmap, 0 to 255. u and v have to be inside the bitmap by half a pixel.
+inline float sampleAlpha(uint8_t const* data, unsigned stride, float u, float v) noexcept {
+	u -= .5f; v -= .5f;
+	int   x0 = (int) u, y0 = (int) v;
+	float fx = u - x0, fy = v - y0;
+	uint8_t const* p = data + size_t(y0) * stride + x0;
+	float top    = p[0] + (p[1] - p[0]) * fx;
+	float bottom = p[stride] + (p[stride + 1] - p[stride]) * fx;
+	return top + (bottom - top) * fy;
+}
+
+uint32_t decodeUtf8(std::string_view s, size_t& i) noexcept {
+	uint8_t  c = s[i++];
+	int      extra;
+	uint32_t cp;
+	if(c < 0x80)      { return c; }
+	else if(c < 0xE0) { cp = c & 0x1F; extra = 1; }
+	else if(c < 0xF0) { cp = c & 0x0F; extra = 2; }
+	else              { cp = c & 0x07; extra = 3; }
+	for(; extra > 0 && i < s.size() && (s[i] & 0xC0) == 0x80; extra--) {
+		cp = (cp << 6) | (s[i++] & 0x3F);
+	}
+	return extra ? 0xFFFD : cp;
+}
+
+int segmentsFor(float radius, float angle) noexcept {
+	if(radius <= Tolerance) return 2;
+	float step = 2 * std::acos(1 - Tolerance / radius);
+	int n = std::clamp((int) std::ceil(std::abs(angle) / step), 2, 512);
+	return (n + 3) & ~3; // Keeps full circles symmetric
+}
+
+} // namespace
+
+// =============================================================
+// == Frame & State =============================================
+// =============================================================
+
+CanvasSoftware::CanvasSoftware() {
+	for(auto [name, path] : std::initializer_list<std::pair<const char*, const char*>>{
+		{"serif", "/usr/share/fonts/TTF/DejaVuSerif.ttf"},
+		{"mono", "/usr/share/fonts/TTF/DejaVuSansMono.ttf"},
+		{"sans", "/usr/share/fonts/TTF/DejaVuSans.ttf" },
+		{"icon", "/usr/share/fonts/noto/NotoSansSymbols2-Regular.ttf"}
+	}) {
+		mFontFiles[name] = path;
+	}
+}
+CanvasSoftware::~CanvasSoftware() {}
+
+Rect CanvasSoftware::transformed(Rect const& r) const noexcept {
+	Point a = mState.transform.apply(r.min);
+	Point b = mState.transform.apply(r.max);
+	return Rect::absolute(std::min(a.x, b.x), std::min(a.y, b.y), std::max(a.x, b.x), std::max(a.y, b.y));
+}
+
+Rect CanvasSoftware::frameRect() const noexcept {
+	return Rect(0, 0, (float) mTarget.width(), (float) mTarget.height());
+}
+
+Canvas& CanvasSoftware::beginFrame(Size const& frame_size, float dpi) {
+	unsigned w = (unsigned) std::max(0.f, std::ceil(frame_size.x));
+	unsigned h = (unsigned) std::max(0.f, std::ceil(frame_size.y));
+	if(w != mTarget.width() || h != mTarget.height() || mTarget.format() != Bitmap::RGBA) {
+		mTarget.init(w, h, Bitmap::RGBA);
+	}
+	if(mTarget.data()) memset(mTarget.data(), 0, size_t(w) * h * 4);
+	mTarget.mRendererProxy.reset();
+
+	mStates.clear();
+	resetState();
+	clearPath();
+	return *this;
+}
+Canvas& CanvasSoftware::endFrame() {
+	clearPath();
+	return *this;
+}
+Canvas& CanvasSoftware::cancelFrame() {
+	clearPath();
+	return *this;
+}
+
+Canvas& CanvasSoftware::pushState() {
+	mStates.push_back(mState);
+	return *this;
+}
+Canvas& CanvasSoftware::popState() {
+	if(!mStates.empty()) {
+		mState = std::move(mStates.back());
+		mStates.pop_back();
+	}
+	return *this;
+}
+Canvas& CanvasSoftware::resetState() {
+	mState = State();
+	mState.scissor = frameRect();
+	return *this;
+}
+
+// Scissor
+Canvas& CanvasSoftware::scissor(Rect const& area) {
+	mState.scissor = frameRect();
+	return scissorIntersect(area);
+}
+Canvas& CanvasSoftware::scissorIntersect(Rect const& area) {
+	Rect r = transformed(area);
+	mState.scissor = mState.scissor.clip(Rect::absolute(
+		std::round(r.min.x), std::round(r.min.y),
+		std::round(r.max.x), std::round(r.max.y)));
+	return *this;
+}
+Canvas& CanvasSoftware::resetScissor() {
+	mState.scissor = frameRect();
+	return *this;
+}
+
+// Transform
+Canvas& CanvasSoftware::resetTransform() {
+	mState.transform = {};
+	return *this;
+}
+Canvas& CanvasSoftware::translate(float x, float y) {
+	mState.transform.tx += x * mState.transform.sx;
+	mState.transform.ty += y * mState.transform.sy;
+	return *this;
+}
+Canvas& CanvasSoftware::scale(float x, float y) {
+	mState.transform.sx *= x;
+	mState.transform.sy *= y;
+	return *this;
+}
+
+// Properties
+Canvas& CanvasSoftware::lineWidth(float f) {
+	mState.lineWidth = f;
+	return *this;
+}
+Canvas& CanvasSoftware::fillColor(Color const& color) {
+	mState.fill = { color, nullptr, {} };
+	return *this;
+}
+Canvas& CanvasSoftware::fillTexture(Rect const& to, shared<Bitmap> const& bm, Color const& tint) {
+	mState.fill = { tint, bm, transformed(to) };
+	return *this;
+}
+Canvas& CanvasSoftware::strokeColor(Color const& color) {
+	mState.stroke = { color, nullptr, {} };
+	return *this;
+}
+Canvas& CanvasSoftware::strokeTexture(Rect const& to, shared<Bitmap> const& bm, Color const& tint) {
+	mState.stroke = { tint, bm, transformed(to) };
+	return *this;
+}
+
+// =============================================================
+// == Path =============================================
+// =============================================================
+
+void CanvasSoftware::addPoint(Point const& p, bool newSubPath) {
+	if(newSubPath || mSubPaths.empty() || mSubPaths.back().closed) {
+		mSubPaths.push_back({ mPoints.size(), 0, false });
+	}
+	mPoints.push_back(p);
+	mSubPaths.back().count++;
+}
+void CanvasSoftware::closeSubPath() {
+	if(!mSubPaths.empty()) mSubPaths.back().closed = true;
+}
+void CanvasSoftware::clearPath() {
+	mPoints.clear();
+	mSubPaths.clear();
+}
+
+void CanvasSoftware::addEllipse(Point const& center, float rx, float ry, float from, float to, bool ccw, bool connect) {
+	float sweep = to - from;
+	if(std::abs(sweep) >= 2 * Pi) {
+		sweep = ccw ? -2 * Pi : 2 * Pi;
+	}
+	else if(!ccw) {
+		while(sweep < 0) sweep += 2 * Pi;
+	}
+	else {
+		while(sweep > 0) sweep -= 2 * Pi;
+	}
+
+	auto& t = mState.transform;
+	int n = segmentsFor(std::max(std::abs(rx * t.sx), std::abs(ry * t.sy)), sweep);
+	for(int i = 0; i <= n; i++) {
+		float a = from + sweep * i / n;
+		addPoint(t.apply({ center.x + std::cos(a) * rx, center.y + std::sin(a) * ry }), i == 0 && !connect);
+	}
+}
+
+Canvas& CanvasSoftware::rect(Rect const& area) {
+	moveTo(area.min);
+	lineTo({ area.min.x, area.max.y });
+	lineTo(area.max);
+	lineTo({ area.max.x, area.min.y });
+	closeSubPath();
+	return *this;
+}
+Canvas& CanvasSoftware::rect(Rect const& area, float radius) {
+	float r = std::min(radius, std::min(std::abs(area.width()), std::abs(area.height())) * .5f);
+	if(r < .1f) return rect(area);
+
+	addEllipse({ area.min.x + r, area.min.y + r }, r, r, Pi, 1.5f * Pi, false, false);
+	addEllipse({ area.max.x - r, area.min.y + r }, r, r, 1.5f * Pi, 2 * Pi, false, true);
+	addEllipse({ area.max.x - r, area.max.y - r }, r, r, 0, .5f * Pi, false, true);
+	addEllipse({ area.min.x + r, area.max.y - r }, r, r, .5f * Pi, Pi, false, true);
+	closeSubPath();
+	return *this;
+}
+Canvas& CanvasSoftware::circle(Point const& center, float r) {
+	return elipse(center, r, r);
+}
+Canvas& CanvasSoftware::elipse(Point const& center, float rx, float ry) {
+	addEllipse(center, rx, ry, 0, 2 * Pi, false, false);
+	closeSubPath();
+	return *this;
+}
+Canvas& CanvasSoftware::arc(Point const& center, float radius, float from_angle, float to_angle, bool counter_clockwise) {
+	// Like nanovg: connects to the current sub path with a line if there is one
+	bool connect = !mSubPaths.empty() && !mSubPaths.back().closed;
+	addEllipse(center, radius, radius, from_angle, to_angle, counter_clockwise, connect);
+	return *this;
+}
+
+Canvas& CanvasSoftware::moveTo(Point const& p) {
+	addPoint(mState.transform.apply(p), true);
+	return *this;
+}
+Canvas& CanvasSoftware::lineTo(Point const& p) {
+	addPoint(mState.transform.apply(p), false);
+	return *this;
+}
+
+// =============================================================
+// == Rasterizer =============================================
+// =============================================================
+
+/// Adds the signed area the line covers to the accumulation buffer, one row at a time.
+/// Summing up a row of the buffer from the left yields the coverage of each pixel.
+/// Parts left of the buffer count as if they were on its left edge, parts right of it are dropped.
+void CanvasSoftware::accumulateLine(Point p0, Point p1, int width, int height) {
+	if(p0.y == p1.y) return;
+
+	float dir = 1;
+	if(p0.y > p1.y) {
+		std::swap(p0, p1);
+		dir = -1;
+	}
+	if(p1.y <= 0 || p0.y >= height) return;
+
+	float dxdy = (p1.x - p0.x) / (p1.y - p0.y);
+	float x    = p0.x;
+	if(p0.y < 0) x -= p0.y * dxdy;
+
+	int   yBegin = std::max(0, (int) std::floor(p0.y));
+	int   yEnd   = std::min(height, (int) std::ceil(p1.y));
+	float maxX   = (float) width;
+	for(int y = yBegin; y < yEnd; y++) {
+		float* row   = mAccumulation.data() + size_t(y) * (width + 2);
+		float  dy    = std::min(y + 1.f, p1.y) - std::max((float) y, p0.y);
+		float  xnext = x + dxdy * dy;
+		float  d     = dy * dir;
+
+		float xa = std::clamp(x, 0.f, maxX), xb = std::clamp(xnext, 0.f, maxX);
+		float x0 = std::min(xa, xb), x1 = std::max(xa, xb);
+		float x0floor = std::floor(x0);
+		int   x0i     = (int) x0floor;
+		float x1ceil  = std::ceil(x1);
+		int   x1i     = (int) x1ceil;
+
+		if(x1i <= x0i + 1) {
+			// Within one pixel: split the area at the line's mean x
+			float xmf = .5f * (xa + xb) - x0floor;
+			row[x0i]     += d - d * xmf;
+			row[x0i + 1] += d * xmf;
+		}
+		else {
+			float s   = 1 / (x1 - x0);
+			float x0f = x0 - x0floor;
+			float a0  = .5f * s * (1 - x0f) * (1 - x0f);
+			float x1f = x1 - x1ceil + 1;
+			float am  = .5f * s * x1f * x1f;
+
+			row[x0i] += d * a0;
+			if(x1i == x0i + 2) {
+				row[x0i + 1] += d * (1 - a0 - am);
+			}
+			else {
+				float a1 = s * (1.5f - x0f);
+				row[x0i + 1] += d * (a1 - a0);
+				for(int xi = x0i + 2; xi < x1i - 1; xi++) row[xi] += d * s;
+				float a2 = a1 + (x1i - x0i - 3) * s;
+				row[x1i - 1] += d * (1 - a2 - am);
+			}
+			row[x1i] += d * am;
+		}
+		x = xnext;
+	}
+}
+
+void CanvasSoftware::rasterize(std::vector<Point> const& points, std::vector<SubPath> const& parts, Paint const& paint) {
+	if(points.empty() || !mTarget.data()) return;
+
+	Rect bounds = Rect::absolute(points[0].x, points[0].y, points[0].x, points[0].y);
+	for(auto& p : points) {
+		bounds.min.x = std::min(bounds.min.x, p.x); bounds.max.x = std::max(bounds.max.x, p.x);
+		bounds.min.y = std::min(bounds.min.y, p.y); bounds.max.y = std::max(bounds.max.y, p.y);
+	}
+	bounds = mState.scissor.clip(bounds);
+
+	int x0 = (int) std::floor(bounds.min.x), x1 = (int) std::ceil(bounds.max.x);
+	int y0 = (int) std::floor(bounds.min.y), y1 = (int) std::ceil(bounds.max.y);
+	int w = x1 - x0, h = y1 - y0;
+	if(w <= 0 || h <= 0) return;
+
+	mAccumulation.assign(size_t(w + 2) * h, 0.f);
+	mCoverage.resize(w);
+
+	Point origin((float) x0, (float) y0);
+	for(auto& part : parts) {
+		for(size_t i = 0; i < part.count; i++) {
+			Point a = points[part.first + i] - origin;
+			Point b = points[part.first + (i + 1) % part.count] - origin; // Fills are always closed
+			accumulateLine(a, b, w, h);
+		}
+	}
+
+	uint32_t* pixels = (uint32_t*) mTarget.data();
+	for(int y = 0; y < h; y++) {
+		float const* row = mAccumulation.data() + size_t(y) * (w + 2);
+		float        acc = 0;
+		size_t       covered = 0;
+		for(int x = 0; x < w; x++) {
+			acc += row[x];
+			uint8_t c = (uint8_t) (std::min(1.f, std::abs(acc)) * 255 + .5f);
+			mCoverage[x] = c;
+			covered += c != 0;
+		}
+		if(covered == 0) continue;
+		mCounters.pixels += covered;
+		blendRow(pixels + size_t(y0 + y) * mTarget.width() + x0, mCoverage.data(), x0, y0 + y, w, paint);
+	}
+	mCounters.primitives++;
+}
+
+void CanvasSoftware::fillAligned(Rect const& area, Paint const& paint) {
+	if(!mTarget.data()) return;
+
+	Rect bounds = mState.scissor.clip(area);
+	int x0 = (int) std::floor(bounds.min.x), x1 = (int) std::ceil(bounds.max.x);
+	int y0 = (int) std::floor(bounds.min.y), y1 = (int) std::ceil(bounds.max.y);
+	int w = x1 - x0;
+	if(w <= 0 || y1 <= y0) return;
+
+	// Coverage is the product of the covered fractions of the pixel's column and row
+	auto covered = [](int pixel, float min, float max) {
+		return std::clamp(std::min(pixel + 1.f, max) - std::max((float) pixel, min), 0.f, 1.f);
+	};
+	mAccumulation.resize(w);
+	for(int x = 0; x < w; x++) {
+		mAccumulation[x] = covered(x0 + x, bounds.min.x, bounds.max.x);
+	}
+
+	mCoverage.resize(w);
+	uint32_t* pixels = (uint32_t*) mTarget.data();
+	float     rowCoverage = -1;
+	for(int y = y0; y < y1; y++) {
+		float cy = covered(y, bounds.min.y, bounds.max.y);
+		if(cy != rowCoverage) { // Only the first and last row differ from the others
+			rowCoverage = cy;
+			for(int x = 0; x < w; x++)
+				mCoverage[x] = (uint8_t) (std::min(1.f, mAccumulation[x] * cy) * 255 + .5f);
+		}
+		mCounters.pixels += w;
+		blendRow(pixels + size_t(y) * mTarget.width() + x0, mCoverage.data(), x0, y, w, paint);
+	}
+	mCounters.primitives++;
+}
+
+void CanvasSoftware::blendRow(uint32_t* dst, uint8_t const* coverage, int x, int y, int n, Paint const& paint) {
+	if(!paint.texture || !paint.texture->data()) {
+		blendSolid(dst, coverage, n, Color16(paint.color));
+		return;
+	}
+
+	Bitmap const& bm   = *paint.texture;
+	if(paint.premultiplied && bm.format() == Bitmap::RGBA && paint.color.r == 1 && paint.color.g == 1 && paint.color.b == 1 && paint.color.a == 1 &&
+	   paint.to.width() == bm.width() && paint.to.height() == bm.height() &&
+	   paint.to.min.x == std::floor(paint.to.min.x) && paint.to.min.y == std::floor(paint.to.min.y))
+	{
+		// Layers are drawn 1:1, so they're blended without sampling
+		int u = x - (int) paint.to.min.x, v = y - (int) paint.to.min.y;
+		if(v >= 0 && v < (int) bm.height() && u >= 0 && u + n <= (int) bm.width()) {
+			blendTexels(dst, (uint32_t const*) bm.data() + size_t(v) * bm.width() + u, coverage, n);
+			return;
+		}
+	}
+
+	Color16       tint(paint.color);
+	float         su   = bm.width() / paint.to.width();
+	float         sv   = bm.height() / paint.to.height();
+	float         v    = (y + .5f - paint.to.min.y) * sv;
+	for(int i = 0; i < n; i++) {
+		if(coverage[i] == 0) continue;
+		float texel[4];
+		sample(bm, (x + i + .5f - paint.to.min.x) * su, v, texel, paint.premultiplied);
+
+		uint16_t src[4];
+		for(int k = 0; k < 4; k++) src[k] = (uint16_t) div255((unsigned)(texel[k] + .5f) * tint.rgba[k]);
+		blendPixel((uint8_t*)(dst + i), src, coverage[i]);
+	}
+}
+
+/// Turns the path into one polygon per line segment and one per joint, all with the same winding.
+/// The rasterizer clamps the coverage, so where they overlap they don't get darker.
+void CanvasSoftware::strokeToPolygons(float width) {
+	mPolygons.clear();
+	mPolygonParts.clear();
+	float hw = width * .5f;
+	if(hw <= 0) return;
+
+	auto addPolygon = [&](std::initializer_list<Point> pts) {
+		mPolygonParts.push_back({ mPolygons.size(), pts.size(), true });
+		mPolygons.insert(mPolygons.end(), pts);
+	};
+	int joinSegments = std::clamp(segmentsFor(hw, 2 * Pi), 6, 64);
+	auto addJoin = [&](Point const& c) {
+		mPolygonParts.push_back({ mPolygons.size(), (size_t) joinSegments, true });
+		for(int i = 0; i < joinSegments; i++) {
+			float a = -2 * Pi * i / joinSegments; // Same winding as the segments
+			mPolygons.push_back({ c.x + std::cos(a) * hw, c.y + std::sin(a) * hw });
+		}
+	};
+
+	for(auto& sub : mSubPaths) {
+		size_t segments = sub.closed ? sub.count : sub.count - 1;
+		for(size_t i = 0; i < segments; i++) {
+			Point a = mPoints[sub.first + i];
+			Point b = mPoints[sub.first + (i + 1) % sub.count];
+			float dx = b.x - a.x, dy = b.y - a.y;
+			float len = std::sqrt(dx * dx + dy * dy);
+			if(len < 1e-4f) continue;
+			Point n(-dy / len * hw, dx / len * hw);
+			addPolygon({ a + n, b + n, b - n, a - n });
+
+			if(hw > .5f && (sub.closed || i + 1 < segments)) addJoin(b);
+		}
+	}
+}
+
+// Commit
+Canvas& CanvasSoftware::fill() {
+	fillPreserve();
+	clearPath();
+	return *this;
+}
+Canvas& CanvasSoftware::fillPreserve() {
+	rasterize(mPoints, mSubPaths, mState.fill);
+	return *this;
+}
+Canvas& CanvasSoftware::stroke() {
+	strokePreserve();
+	clearPath();
+	return *this;
+}
+Canvas& CanvasSoftware::strokePreserve() {
+	auto& t = mState.transform;
+	strokeToPolygons(mState.lineWidth * std::sqrt(std::abs(t.sx * t.sy)));
+	rasterize(mPolygons, mPolygonParts, mState.stroke);
+	return *this;
+}
+
+// =============================================================
+// == Batches =============================================
+// =============================================================
+
+Canvas& CanvasSoftware::rects(Rect const* areas, Color const* colors, size_t count) {
+	if(!colors) {
+		// All at once: overlapping rects must not be blended twice
+		return Canvas::rects(areas, colors, count);
+	}
+	for(size_t i = 0; i < count; i++) {
+		mState.fill = { colors[i], nullptr, {} };
+		fillAligned(transformed(areas[i]), mState.fill);
+	}
+	return *this;
+}
+Canvas& CanvasSoftware::polyline(Point const* points, size_t count) {
+	if(count < 2) return *this;
+
+	for(size_t i = 0; i < count; i++)
+		addPoint(mState.transform.apply(points[i]), i == 0);
+	return stroke();
+}
+Canvas& CanvasSoftware::texturedQuads(shared<Bitmap> const& bm, TexturedQuad const* quads, size_t count, Color const& tint) {
+	for(size_t i = 0; i < count; i++) {
+		mState.fill = { tint, bm, transformed(quads[i].mapping(bm->width(), bm->height())) };
+		fillAligned(transformed(quads[i].to), mState.fill);
+	}
+	return *this;
+}
+Canvas& CanvasSoftware::glyphRuns(GlyphRun const* runs, size_t count) {
+	for(size_t i = 0; i < count; i++)
+		drawText(runs[i].position, runs[i].text);
+	return *this;
+}
+
+// Layers
+bool CanvasSoftware::beginLayer(Layer& layer, unsigned width, unsigned height) {
+	shared<Bitmap> bm = layer.handle.cast_static<Bitmap>();
+	if(!bm) {
+		bm = make_shared<Bitmap>();
+		layer.handle = bm.cast_static<void>();
+	}
+	if(bm->width() != width || bm->height() != height) {
+		bm->init(width, height, Bitmap::RGBA);
+	}
+	else if(bm->data()) {
+		memset(bm->data(), 0, size_t(width) * height * 4);
+	}
+	layer.width  = width;
+	layer.height = height;
+
+	// Draw into the layer, the frame is swapped back by endLayer
+	std::swap(mTarget, *bm);
+	mLayerTarget = std::move(bm);
+	mStates.clear();
+	resetState();
+	clearPath();
+	return true;
+}
+Canvas& CanvasSoftware::endLayer() {
+	if(!mLayerTarget) return *this;
+	clearPath();
+	std::swap(mTarget, *mLayerTarget);
+	mLayerTarget.reset();
+	return *this;
+}
+Canvas& CanvasSoftware::drawLayer(Layer const& layer, Rect const& to) {
+	shared<Bitmap> bm = layer.handle.cast_static<Bitmap>();
+	if(!bm) return *this;
+	Rect area = transformed(to);
+	fillAligned(area, Paint{ Color::white(), std::move(bm), area, true });
+	return *this;
+}
+
+// =============================================================
+// == Text =============================================
+// =============================================================
+
+Canvas& CanvasSoftware::registerFont(const char* name, const char* path) {
+	mFontFiles[name] = path;
+	mFonts.erase(name);
+	return *this;
+}
+Canvas& CanvasSoftware::registerFont(const char* name, shared<Font> font) {
+	mFonts[name] = std::move(font);
+	return *this;
+}
+
+Font* CanvasSoftware::currentFont() {
+	auto iter = mFonts.find(mState.font);
+	if(iter != mFonts.end()) return iter->second.get();
+
+	auto file = mFontFiles.find(mState.font);
+	if(file == mFontFiles.end()) {
+		if(mState.font == "sans") return nullptr;
+		std::string name = std::move(mState.font);
+		mState.font = "sans";
+		Font* result = currentFont();
+		mState.font = std::move(name);
+		return result;
+	}
+
+	shared<Font> font;
+	try {
+		font = stx::make_shared<Font>(file->second);
+	}
+	catch(exceptions::FailedLoadingFile&) {
+		fprintf(stderr, "Failed loading font '%s' from %s\n", mState.font.c_str(), file->second.c_str());
+	}
+	return (mFonts[mState.font] = std::move(font)).get();
+}
+
+Canvas& CanvasSoftware::font(const char* name) {
+	mState.font = *name ? name : "sans";
+	return *this;
+}
+Canvas& CanvasSoftware::fontSize(float f) {
+	mState.fontSize = f != 0 ? f : 18;
+	return *this;
+}
+Canvas& CanvasSoftware::fontBlur(float f) {
+	return *this;
+}
+Canvas& CanvasSoftware::fontLetterSpacing(float f) {
+	mState.letterSpacing = f;
+	return *this;
+}
+Canvas& CanvasSoftware::fontLineHeight(float f) {
+	mState.lineHeight = f;
+	return *this;
+}
+
+float CanvasSoftware::advanceOf(std::string_view txt) {
+	Font* font = currentFont();
+	if(!font) return 0;
+
+	float    size = mState.fontSize;
+	float    x    = 0;
+	uint32_t prev = 0;
+	for(size_t i = 0; i < txt.size();) {
+		uint32_t c = decodeUtf8(txt, i);
+		if(prev) x += font->kerning(prev, c) * size;
+		x += font->glyph(c).advance * size + mState.letterSpacing;
+		prev = c;
+	}
+	return x;
+}
+
+void CanvasSoftware::drawText(Point const& pen, std::string_view txt) {
+	Font* font = currentFont();
+	if(!font || !mTarget.data()) return;
+
+	auto&  t      = mState.transform;
+	float  size   = mState.fontSize;
+	float  scale  = size * std::abs(t.sy) / font->sdfSize(); // Pixels per distance field pixel
+	float  spread = 2.f * font->spread() * scale;
+	Rect   clip   = mState.scissor;
+	auto*  pixels = (uint32_t*) mTarget.data();
+
+	float    x    = pen.x;
+	uint32_t prev = 0;
+	for(size_t i = 0; i < txt.size();) {
+		uint32_t c = decodeUtf8(txt, i);
+		if(prev) x += font->kerning(prev, c) * size;
+		prev = c;
+
+		Font::Glyph g = font->glyph(c);
+		Bitmap const& atlas = font->atlas();
+		if(g) {
+			Point q0 = t.apply({ x + g.x0 * size, pen.y + g.y0 * size });
+			Point q1 = t.apply({ x + g.x1 * size, pen.y + g.y1 * size });
+			if(q0.x > q1.x) std::swap(q0.x, q1.x);
+			if(q0.y > q1.y) std::swap(q0.y, q1.y);
+
+			int px0 = std::max((int) std::floor(q0.x), (int) clip.min.x), px1 = std::min((int) std::ceil(q1.x), (int) clip.max.x);
+			int py0 = std::max((int) std::floor(q0.y), (int) clip.min.y), py1 = std::min((int) std::ceil(q1.y), (int) clip.max.y);
+			if(px1 > px0 && py1 > py0) {
+				float su = g.width / (q1.x - q0.x), sv = g.height / (q1.y - q0.y);
+				mCoverage.resize(px1 - px0);
+				for(int py = py0; py < py1; py++) {
+					float  v       = g.y + std::clamp((py + .5f - q0.y) * sv, .5f, g.height - .5f);
+					size_t covered = 0;
+					for(int px = px0; px < px1; px++) {
+						float u = g.x + std::clamp((px + .5f - q0.x) * su, .5f, g.width - .5f);
+						float d = sampleAlpha(atlas.data(), atlas.width(), u, v);
+						float alpha = std::clamp((d / 255.f - Font::edge()) * spread + .5f, 0.f, 1.f);
+						uint8_t cov = (uint8_t) (alpha * 255 + .5f);
+						mCoverage[px - px0] = cov;
+						covered += cov != 0;
+					}
+					if(covered == 0) continue;
+					mCounters.pixels += covered;
+					blendRow(pixels + size_t(py) * mTarget.width() + px0, mCoverage.data(), px0, py, px1 - px0, mState.fill);
+				}
+			}
+		}
+		x += g.advance * size + mState.letterSpacing;
+	}
+	mCounters.primitives++;
+}
+
+Canvas& CanvasSoftware::text(Point const& position, std::string_view txt) {
+	drawText(position, txt);
+	return *this;
+}
+
+Canvas& CanvasSoftware::textBox(Point const& position, float maxWidth, std::string_view txt) {
+	float lineHeight = fontMetrics().line_height * mState.lineHeight;
+	float y = position.y;
+
+	std::vector<uint32_t> lines;
+	size_t begin = 0;
+	while(begin <= txt.size()) {
+		size_t end = std::min(txt.find('\n', begin), txt.size());
+		std::string_view paragraph = txt.substr(begin, end - begin);
+
+		lines.clear();
+		textBreakLines(paragraph, maxWidth, lines);
+		for(size_t i = 0; i < lines.size(); i++) {
+			size_t lineEnd = i + 1 < lines.size() ? lines[i + 1] : paragraph.size();
+			drawText({ position.x, y }, paragraph.substr(lines[i], lineEnd - lines[i]));
+			y += lineHeight;
+		}
+		begin = end + 1;
+	}
+	return *this;
+}
+
+Rect CanvasSoftware::textBounds(Point const& position, std::string_view txt) {
+	FontMetrics metrics = fontMetrics();
+	return Rect::absolute(
+		position.x, position.y - metrics.ascend,
+		position.x + advanceOf(txt), position.y - metrics.descend
+	);
+}
+Rect CanvasSoftware::textBoxBounds(Point const& position, float maxWidth, std::string_view txt) {
+	FontMetrics metrics    = fontMetrics();
+	float       lineHeight = metrics.line_height * mState.lineHeight;
+	float       width      = 0;
+	size_t      lineCount  = 0;
+
+	std::vector<uint32_t> lines;
+	size_t begin = 0;
+	while(begin <= txt.size()) {
+		size_t end = std::min(txt.find('\n', begin), txt.size());
+		std::string_view paragraph = txt.substr(begin, end - begin);
+
+		lines.clear();
+		textBreakLines(paragraph, maxWidth, lines);
+		for(size_t i = 0; i < lines.size(); i++) {
+			size_t lineEnd = i + 1 < lines.size() ? lines[i + 1] : paragraph.size();
+			width = std::max(width, advanceOf(paragraph.substr(lines[i], lineEnd - lines[i])));
+		}
+		lineCount += lines.size();
+		begin = end + 1;
+	}
+
+	return Rect::absolute(
+		position.x, position.y - metrics.ascend,
+		position.x + width, position.y - metrics.descend + (lineCount - 1) * lineHeight
+	);
+}
+
+FontMetrics CanvasSoftware::fontMetrics() {
+	FontMetrics metrics = { 0, 0, 0 };
+	if(Font* font = currentFont()) {
+		float size = mState.fontSize;
+		metrics.ascend      = font->ascent() * size;
+		metrics.descend     = font->descent() * size;
+		metrics.line_height = (font->ascent() - font->descent() + font->lineGap()) * size;
+	}
+	return metrics;
+}
+
+} // namespace wwidget
@@ -5,6 +5,13 @@ namespace wwidget {
 Context::Context() {}
 Context::~Context() {}
 
+void Context::defer(TaskPriority, std::function<void()> fn) {
+	defer(std::move(fn));
+}
+
+void Context::wakeup() {}
+void Context::requestFrame(Clock::time_point) {}
+
 std::string Context::getRessource(RessourceId res) {
 	// TODO: windows compatibility
 	switch(res) {
@@ -0,0 +1,292 @@
+#include "../include/wwidget/Font.hpp"
+#include "../include/wwidget/Error.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+
+// fontstash compiles stb_truetype with its own allocator, which needs a FONScontext.
+// Font uses a private copy instead.
+#if defined(__GNUC__)
+	#pragma GCC diagnostic push
+	#pragma GCC diagnostic ignored "-Wunused-function"
+	#pragma GCC diagnostic ignored "-Wsign-compare"
+	#pragma GCC diagnostic ignored "-Wimplicit-fallthrough"
+#endif
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "thirdparty/stb_truetype.h"
+#if defined(__GNUC__)
+	#pragma GCC diagnostic pop
+#endif
+
+namespace wwidget {
+
+struct Font::Face {
+	stbtt_fontinfo info;
+	float          scale; //!< Font units to pixels at sdfSize
+	int            ascent, descent, lineGap;
+};
+
+// =============================================================
+// == Distance transform =============================================
+// =============================================================
+
+namespace {
+
+constexpr float Infinity = 1e20f;
+
+/// Squared euclidean distance transform of one row or column (Felzenszwalb & Huttenlocher)
+void edt1d(float const* f, float* d, int n, int* v, float* z) {
+	int k = 0;
+	v[0] = 0;
+	z[0] = -Infinity;
+	z[1] = +Infinity;
+	for(int q = 1; q < n; q++) {
+		float s;
+		while(true) {
+			s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+			if(s > z[k] || k == 0) break;
+			--k;
+		}
+		if(s <= z[k]) { // k == 0
+			v[0] = q;
+			z[1] = +Infinity;
+			continue;
+		}
+		++k;
+		v[k] = q;
+		z[k] = s;
+		z[k + 1] = +Infinity;
+	}
+	k = 0;
+	for(int q = 0; q < n; q++) {
+		while(z[k + 1] < q) ++k;
+		d[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+	}
+}
+
+/// In place: grid holds 0 for feature pixels and Infinity for everything else,
+/// afterwards it holds the squared distance to the closest feature pixel.
+void edt2d(std::vector<float>& grid, int w, int h) {
+	int n = std::max(w, h);
+	std::vector<float> f(n), d(n), z(n + 1);
+	std::vector<int>   v(n);
+
+	for(int x = 0; x < w; x++) {
+		for(int y = 0; y < h; y++) f[y] = grid[y * w + x];
+		edt1d(f.data(), d.data(), h, v.data(), z.data());
+		for(int y = 0; y < h; y++) grid[y * w + x] = d[y];
+	}
+	for(int y = 0; y < h; y++) {
+		edt1d(&grid[y * w], d.data(), w, v.data(), z.data());
+		std::copy_n(d.data(), w, &grid[y * w]);
+	}
+}
+
+} // namespace
+
+// =============================================================
+// == Font =============================================
+// =============================================================
+
+Font::Font(unsigned sdfSize, unsigned spread, unsigned maxAtlasSize) :
+	mSdfSize(sdfSize),
+	mSpread(spread),
+	mMaxAtlasSize(maxAtlasSize),
+	mGeneration(0)
+{}
+Font::Font(std::string const& path) :
+	Font()
+{
+	load(path);
+}
+Font::~Font() {}
+
+void Font::load(std::string const& path) {
+	std::ifstream file(path, std::ios::binary);
+	if(!file) throw exceptions::FailedLoadingFile(path);
+	std::vector<uint8_t> data{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+	try {
+		load(std::move(data));
+	}
+	catch(exceptions::InvalidOperation&) {
+		throw exceptions::FailedLoadingFile(path, "Not a TrueType font");
+	}
+}
+void Font::load(std::vector<uint8_t> data) {
+	auto face = std::make_unique<Face>();
+	int offset = data.empty() ? -1 : stbtt_GetFontOffsetForIndex(data.data(), 0);
+	if(offset < 0 || !stbtt_InitFont(&face->info, data.data(), offset)) {
+		throw exceptions::InvalidOperation("Font::load: Not a TrueType font");
+	}
+	face->scale = stbtt_ScaleForPixelHeight(&face->info, (float) mSdfSize);
+	stbtt_GetFontVMetrics(&face->info, &face->ascent, &face->descent, &face->lineGap);
+
+	clear();
+	mData = std::move(data);
+	mFace = std::move(face);
+	mFace->info.data = mData.data(); // mData's buffer didn't move, but don't rely on it
+}
+
+float Font::ascent() const noexcept { return mFace ? mFace->ascent * mFace->scale / mSdfSize : 0; }
+float Font::descent() const noexcept { return mFace ? mFace->descent * mFace->scale / mSdfSize : 0; }
+float Font::lineGap() const noexcept { return mFace ? mFace->lineGap * mFace->scale / mSdfSize : 0; }
+
+float Font::kerning(uint32_t left, uint32_t right) const {
+	if(!mFace) return 0;
+	return stbtt_GetCodepointKernAdvance(&mFace->info, (int) left, (int) right) * mFace->scale / mSdfSize;
+}
+
+Font::Glyph const& Font::glyph(uint32_t codepoint) {
+	auto iter = mGlyphs.find(codepoint);
+	if(iter != mGlyphs.end()) return iter->second;
+
+	Glyph g;
+	if(mFace) rasterize(codepoint, g);
+	return mGlyphs.emplace(codepoint, g).first->second;
+}
+
+void Font::rasterize(uint32_t codepoint, Glyph& g) {
+	int index = stbtt_FindGlyphIndex(&mFace->info, (int) codepoint);
+
+	int advance, lsb;
+	stbtt_GetGlyphHMetrics(&mFace->info, index, &advance, &lsb);
+	g.advance = advance * mFace->scale / mSdfSize;
+
+	int cw = 0, ch = 0, xoff = 0, yoff = 0;
+	uint8_t* coverage = stbtt_GetGlyphBitmap(&mFace->info, mFace->scale, mFace->scale, index, &cw, &ch, &xoff, &yoff);
+	if(!coverage || cw <= 0 || ch <= 0) {
+		if(coverage) stbtt_FreeBitmap(coverage, nullptr);
+		return;
+	}
+
+	int spread = (int) mSpread;
+	int w = cw + 2 * spread, h = ch + 2 * spread;
+
+	unsigned x, y;
+	if(!allocate(w, h, x, y)) {
+		// The atlas is full: start over, the glyphs in use will come back
+		clear();
+		mStats.resets++;
+		if(!allocate(w, h, x, y)) {
+			stbtt_FreeBitmap(coverage, nullptr);
+			return; // Larger than the whole atlas
+		}
+	}
+
+	auto cov = [&](int px, int py) -> uint8_t {
+		px -= spread; py -= spread;
+		return (px < 0 || py < 0 || px >= cw || py >= ch) ? 0 : coverage[py * cw + px];
+	};
+
+	// Squared distances to the closest inside and outside pixels
+	std::vector<float> toInside(w * h), toOutside(w * h);
+	for(int py = 0; py < h; py++) {
+		for(int px = 0; px < w; px++) {
+			bool inside = cov(px, py) >= 128;
+			toInside [py * w + px] = inside ? 0 : Infinity;
+			toOutside[py * w + px] = inside ? Infinity : 0;
+		}
+	}
+	edt2d(toInside, w, h);
+	edt2d(toOutside, w, h);
+
+	uint8_t* atlas = mAtlas.data();
+	unsigned stride = mAtlas.width();
+	for(int py = 0; py < h; py++) {
+		for(int px = 0; px < w; px++) {
+			float   dOut = std::sqrt(toInside[py * w + px]);
+			float   dIn  = std::sqrt(toOutside[py * w + px]);
+			uint8_t c    = cov(px, py);
+
+			// Signed distance to the outline in pixels, positive outside
+			float d = dOut > 0 ? dOut - .5f : .5f - dIn;
+			if(c > 0 && c < 255 && std::min(dOut, dIn) <= 1) d = .5f - c / 255.f; // Anti-aliased edge pixels know better
+
+			float value = edge() - d / (2 * spread);
+			atlas[(y + py) * stride + x + px] = (uint8_t) std::lround(std::clamp(value, 0.f, 1.f) * 255);
+		}
+	}
+	stbtt_FreeBitmap(coverage, nullptr);
+
+	g.x      = x;
+	g.y      = y;
+	g.width  = w;
+	g.height = h;
+	g.x0     = float(xoff - spread) / mSdfSize;
+	g.y0     = float(yoff - spread) / mSdfSize;
+	g.x1     = g.x0 + float(w) / mSdfSize;
+	g.y1     = g.y0 + float(h) / mSdfSize;
+
+	mAtlas.mRendererProxy.reset();
+	mStats.rasterized++;
+	mStats.glyphs++;
+}
+
+// =============================================================
+// == Atlas =============================================
+// =============================================================
+
+bool Font::allocate(unsigned w, unsigned h, unsigned& x, unsigned& y) {
+	constexpr unsigned Padding = 1;
+	w += Padding; h += Padding;
+	if(w > mMaxAtlasSize || h > mMaxAtlasSize) return false;
+
+	if(mAtlas.width() == 0) growAtlas(std::min(256u, mMaxAtlasSize));
+
+	while(true) {
+		unsigned size = mAtlas.width();
+
+		// Shelves as tall as the glyph, but not much taller
+		for(auto& shelf : mShelves) {
+			if(shelf.height >= h && shelf.height <= h + h / 2 && shelf.used + w <= size) {
+				x = shelf.used;
+				y = shelf.y;
+				shelf.used += w;
+				return true;
+			}
+		}
+
+		unsigned top = mShelves.empty() ? 0 : mShelves.back().y + mShelves.back().height;
+		if(top + h <= size && w <= size) {
+			mShelves.push_back({ top, h, w });
+			x = 0;
+			y = top;
+			return true;
+		}
+
+		if(size >= mMaxAtlasSize) return false;
+		growAtlas(std::min(size * 2, mMaxAtlasSize));
+	}
+}
+
+void Font::growAtlas(unsigned size) {
+	Bitmap grown;
+	grown.init(size, size, Bitmap::ALPHA);
+	memset(grown.data(), 0, size * size);
+	for(unsigned row = 0; row < mAtlas.height(); row++) {
+		memcpy(grown.data() + row * size, mAtlas.data() + row * mAtlas.width(), mAtlas.width());
+	}
+	mAtlas = grown;
+}
+
+void Font::clear() {
+	mGlyphs.clear();
+	mShelves.clear();
+	if(mAtlas.data()) memset(mAtlas.data(), 0, mAtlas.width() * mAtlas.height());
+	mAtlas.mRendererProxy.reset();
+	mStats.glyphs = 0;
+	mGeneration++;
+}
+
+size_t Font::memoryUsage() const noexcept {
+	size_t atlas  = size_t(mAtlas.width()) * mAtlas.height();
+	size_t glyphs = mGlyphs.bucket_count() * sizeof(void*) + mGlyphs.size() * (sizeof(std::pair<uint32_t, Glyph>) + 2 * sizeof(void*));
+	return atlas + glyphs;
+}
+
+} // namespace wwidget
@@ -0,0 +1,147 @@
+#include "../include/wwidget/InputQueue.hpp"
+
+#include "../include/wwidget/Widget.hpp"
+
+#include <algorithm>
+
+namespace wwidget {
+
+InputQueue::InputQueue() :
+	mKeepPaths(false)
+{}
+InputQueue::~InputQueue() {}
+
+template<class T>
+void InputQueue::pushMotion(T const& motion) {
+	++mCounters.received;
+	if(!mEntries.empty()) {
+		auto& last = mEntries.back();
+		// Exactly T: a Dragged must not be merged into a Moved and the other way around
+		if(T* before = std::get_if<T>(&last.event); before && before->buttons == motion.buttons) {
+			before->position = motion.position;
+			before->time     = motion.time;
+			before->moved_x  = motion.position.x - before->old_x;
+			before->moved_y  = motion.position.y - before->old_y;
+			if(mKeepPaths) mPaths.push_back(motion.position);
+			++mCounters.coalesced;
+			return;
+		}
+	}
+	mEntries.push_back({motion, mPaths.size()});
+	if(mKeepPaths) mPaths.push_back(motion.position);
+}
+
+void InputQueue::push(Click     const& e) { ++mCounters.received; mEntries.push_back({e, mPaths.size()}); }
+void InputQueue::push(Scroll    const& e) { ++mCounters.received; mEntries.push_back({e, mPaths.size()}); }
+void InputQueue::push(Moved     const& e) { pushMotion(e); }
+void InputQueue::push(Dragged   const& e) { pushMotion(e); }
+void InputQueue::push(KeyEvent  const& e) { ++mCounters.received; mEntries.push_back({e, mPaths.size()}); }
+void InputQueue::push(TextInput const& e) { ++mCounters.received; mEntries.push_back({e, mPaths.size()}); }
+
+size_t InputQueue::dispatch(Widget& root) {
+	// Handlers may push input or clear the queue, which mustn't move the entries being dispatched
+	std::vector<Entry> entries;
+	std::vector<Point> paths;
+	entries.swap(mEntries);
+	paths.swap(mPaths);
+
+	size_t count = entries.size();
+	for(size_t i = 0; i < count; i++) {
+		auto&  entry   = entries[i];
+		size_t pathEnd = i + 1 < count ? entries[i + 1].pathBegin : paths.size();
+		std::visit([&](auto& e) {
+			using T = std::decay_t<decltype(e)>;
+			if constexpr(std::is_base_of_v<Moved, T>) {
+				if(pathEnd > entry.pathBegin) {
+					e.path       = paths.data() + entry.pathBegin;
+					e.pathLength = pathEnd - entry.pathBegin;
+				}
+				hover(root, e.position);
+			}
+			root.send(e);
+		}, entry.event);
+	}
+	mCounters.dispatched += count;
+
+	// Keep the capacity, unless handlers queued new input
+	if(mEntries.empty()) {
+		entries.clear();
+		paths.clear();
+		entries.swap(mEntries);
+		paths.swap(mPaths);
+	}
+	return count;
+}
+
+void InputQueue::hover(Widget& root, Point const& position) {
+	auto& path = mHoverPath;
+
+	// Keep the part of the path which is still connected and under the pointer
+	Point  local = position; // Relative to path[keep - 1]
+	size_t keep  = 0;
+	for(; keep < path.size(); keep++) {
+		Widget* w = path[keep];
+		Point   p = local;
+		if(keep == 0) {
+			if(w != &root) break;
+		}
+		else {
+			if(w->parent().get() != path[keep - 1]) break;
+			p.x -= w->offsetx();
+			p.y -= w->offsety();
+		}
+		if(!Rect(w->size()).contains(p)) break;
+		local = p;
+	}
+
+	while(path.size() > keep) {
+		Widget* w = path.back();
+		path.pop_back();
+		w->mFlags.hovered = false;
+		w->on(Leave());
+	}
+
+	auto enter = [&](Widget* w) {
+		path.push_back(w);
+		w->mFlags.hovered = true;
+		Enter e;
+		e.position = local; // Relative to w
+		w->on(e);
+	};
+
+	if(path.empty()) {
+		++mCounters.hitTests;
+		if(!Rect(root.size()).contains(position)) return;
+		enter(&root);
+	}
+
+	// Descend to the topmost child under the pointer, like events are sent
+	for(Widget* w = path.back(); w;) {
+		Widget* next = nullptr;
+		for(shared<Widget> child = w->lastChild(); child; child = child->prevSibling()) {
+			++mCounters.hitTests;
+			Point p = { local.x - child->offsetx(), local.y - child->offsety() };
+			if(Rect(child->size()).contains(p)) {
+				next  = child.get();
+				local = p;
+				break;
+			}
+		}
+		if(next) enter(next);
+		w = next;
+	}
+}
+
+void InputQueue::unhover(Widget& w) noexcept {
+	auto it = std::find(mHoverPath.begin(), mHoverPath.end(), &w);
+	for(auto i = it; i != mHoverPath.end(); ++i)
+		(*i)->mFlags.hovered = false;
+	mHoverPath.erase(it, mHoverPath.end());
+}
+
+void InputQueue::clear() noexcept {
+	mEntries.clear();
+	mPaths.clear();
+}
+
+} // namespace wwidget
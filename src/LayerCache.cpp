@@ -0,0 +1,190 @@
+#include "../include/wwidget/LayerCache.hpp"
+
+#include "../include/wwidget/Widget.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace wwidget {
+
+LayerCache::LayerCache(size_t budget) :
+	mBudget(budget),
+	mMemoryUsage(0)
+{}
+LayerCache::~LayerCache() {}
+
+void LayerCache::free(Entry& e) {
+	mMemoryUsage -= e.layer.memoryUsage() + e.spare.memoryUsage();
+	e.layer    = {};
+	e.spare    = {};
+	e.valid    = false;
+	e.scrolled = {};
+	e.repaint  = {};
+}
+
+void LayerCache::add(Widget const* w) {
+	mEntries.emplace(w, Entry());
+}
+void LayerCache::remove(Widget const* w) {
+	auto iter = mEntries.find(w);
+	if(iter == mEntries.end()) return;
+	free(iter->second);
+	mEntries.erase(iter);
+}
+
+bool LayerCache::dirty(Widget const& w) noexcept {
+	return w.mFlags.needsRedraw || w.mFlags.childNeedsRedraw;
+}
+
+static bool empty(Rect const& r) noexcept {
+	return !(r.width() > 0 && r.height() > 0);
+}
+/// a without b, as up to 4 rects
+static size_t subtract(Rect const& a, Rect const& b, Rect out[4]) {
+	Rect   overlap = a.clip(b);
+	size_t n       = 0;
+	if(empty(a)) return 0;
+	if(empty(overlap)) {
+		out[n++] = a;
+		return n;
+	}
+	if(overlap.min.y > a.min.y) out[n++] = Rect::absolute(a.min.x, a.min.y, a.max.x, overlap.min.y);
+	if(overlap.max.y < a.max.y) out[n++] = Rect::absolute(a.min.x, overlap.max.y, a.max.x, a.max.y);
+	if(overlap.min.x > a.min.x) out[n++] = Rect::absolute(a.min.x, overlap.min.y, overlap.min.x, overlap.max.y);
+	if(overlap.max.x < a.max.x) out[n++] = Rect::absolute(overlap.max.x, overlap.min.y, a.max.x, overlap.max.y);
+	return n;
+}
+
+bool LayerCache::scroll(Widget const* w, Point const& delta, Rect const& repaint) {
+	auto iter = mEntries.find(w);
+	if(iter == mEntries.end() || !iter->second.valid) return false;
+
+	Entry& e = iter->second;
+	e.scrolled = e.scrolled + delta;
+	if(!empty(repaint)) {
+		e.repaint = empty(e.repaint) ? repaint : Rect::absolute(
+			std::min(e.repaint.min.x, repaint.min.x), std::min(e.repaint.min.y, repaint.min.y),
+			std::max(e.repaint.max.x, repaint.max.x), std::max(e.repaint.max.y, repaint.max.y));
+	}
+	// The parents have to be drawn again, but not w
+	for(auto p = w->parent(); p; p = p->parent()) p->mFlags.childNeedsRedraw = true;
+	return true;
+}
+
+/// Draws e.layer moved by e.scrolled into e.spare, draws what's missing and swaps them
+bool LayerCache::blit(Canvas& c, Widget& w, Entry& e) {
+	float width  = (float) e.layer.width;
+	float height = (float) e.layer.height;
+	Point d      = e.scrolled;
+	// Only whole pixels, the content would get blurry otherwise
+	if(d.x != std::round(d.x) || d.y != std::round(d.y) || std::abs(d.x) >= width || std::abs(d.y) >= height) return false;
+	if(!e.spare.handle && mMemoryUsage + e.layer.memoryUsage() > mBudget) return false;
+
+	mMemoryUsage -= e.spare.memoryUsage();
+	bool drawn = c.beginLayer(e.spare, e.layer.width, e.layer.height);
+	mMemoryUsage += e.spare.memoryUsage();
+	if(!drawn) return false;
+
+	Rect full(width, height);
+	Rect moved   = Rect(d.x, d.y, width, height).clip(full);
+	Rect repaint = e.repaint.clip(full);
+
+	Rect   pieces[4];
+	size_t n = subtract(moved, repaint, pieces);
+	for(size_t i = 0; i < n; i++) {
+		c.pushState();
+		c.scissor(pieces[i]);
+		c.drawLayer(e.layer, { d.x, d.y, width, height });
+		c.popState();
+	}
+
+	auto draw = [&](Rect const& area) {
+		c.pushState();
+		c.scissor(area);
+		w.drawRecursive(c, false, area);
+		c.popState();
+	};
+	// What was exposed, without repaint: everything is drawn once, translucent things would get darker otherwise
+	n = subtract(full, moved, pieces);
+	for(size_t i = 0; i < n; i++) {
+		Rect   exposed[4];
+		size_t m = subtract(pieces[i], repaint, exposed);
+		for(size_t k = 0; k < m; k++) draw(exposed[k]);
+	}
+	if(!empty(repaint)) draw(repaint);
+	c.endLayer();
+
+	std::swap(e.layer, e.spare);
+	mCounters.blits++;
+	return true;
+}
+
+void LayerCache::render(Canvas& c, Widget const* root) {
+	// Deepest first, so layers inside of layers are ready when the outer one is drawn
+	std::vector<std::pair<size_t, Widget*>> pending;
+	for(auto& [w, e] : mEntries) {
+		size_t        depth = 0;
+		Widget const* top   = w;
+		for(auto p = w->parent(); p; p = p->parent(), depth++) top = p.get();
+		if(top != root) { // Removed from the tree
+			if(e.layer.handle) free(e);
+			continue;
+		}
+
+		unsigned width  = (unsigned) std::ceil(std::max(0.f, w->width()));
+		unsigned height = (unsigned) std::ceil(std::max(0.f, w->height()));
+		bool moved = e.scrolled.x != 0 || e.scrolled.y != 0 || !empty(e.repaint);
+		if(e.valid && !dirty(*w) && !moved && e.layer.width == width && e.layer.height == height) continue;
+		pending.emplace_back(depth, const_cast<Widget*>(w));
+	}
+	std::sort(pending.begin(), pending.end(), [](auto& a, auto& b) { return a.first > b.first; });
+
+	for(auto& [depth, w] : pending) {
+		Entry&   e      = mEntries[w];
+		unsigned width  = (unsigned) std::ceil(std::max(0.f, w->width()));
+		unsigned height = (unsigned) std::ceil(std::max(0.f, w->height()));
+
+		bool blitted = e.valid && !dirty(*w) && e.layer.width == width && e.layer.height == height && blit(c, *w, e);
+		e.scrolled = {};
+		e.repaint  = {};
+		if(blitted) {
+			mCounters.renders++;
+			continue;
+		}
+
+		size_t bytes = size_t(width) * height * 4;
+		if(bytes == 0 || mMemoryUsage - e.layer.memoryUsage() + bytes > mBudget) {
+			free(e);
+			continue;
+		}
+
+		mMemoryUsage -= e.layer.memoryUsage();
+		bool drawn = c.beginLayer(e.layer, width, height);
+		mMemoryUsage += e.layer.memoryUsage();
+		if(!drawn) {
+			free(e);
+			continue;
+		}
+		w->drawRecursive(c, false);
+		c.endLayer();
+
+		e.valid = true;
+		mCounters.renders++;
+	}
+}
+
+Layer const* LayerCache::find(Widget const* w) {
+	auto iter = mEntries.find(w);
+	if(iter == mEntries.end() || !iter->second.valid || dirty(*w)) return nullptr;
+	if(iter->second.scrolled.x != 0 || iter->second.scrolled.y != 0 || !empty(iter->second.repaint)) return nullptr;
+
+	mCounters.composites++;
+	return &iter->second.layer;
+}
+
+void LayerCache::clear() {
+	for(auto& [w, e] : mEntries) free(e);
+}
+
+} // namespace wwidget
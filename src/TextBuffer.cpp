@@ -0,0 +1,201 @@
+#include "../include/wwidget/TextBuffer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace wwidget {
+
+static bool isContinuationByte(char c) noexcept {
+	return (c & 0xC0) == 0x80;
+}
+
+TextBuffer::TextBuffer() :
+	mGapBegin(0),
+	mGapEnd(0),
+	mAnchor(0),
+	mCursorX(0),
+	mWidth(0)
+{}
+
+std::string TextBuffer::str() const {
+	std::string result;
+	result.reserve(size());
+	result.append(beforeCursor());
+	result.append(afterCursor());
+	return result;
+}
+std::string TextBuffer::substr(size_t begin, size_t end) const {
+	std::string result;
+	end = std::min(end, size());
+	for(size_t i = begin; i < end; i++) result += (*this)[i];
+	return result;
+}
+
+// =============================================================
+// == Gap =============================================
+// =============================================================
+
+void TextBuffer::moveGap(size_t pos) {
+	if(pos < mGapBegin) {
+		size_t n = mGapBegin - pos;
+		float  moved = 0;
+		for(size_t i = pos; i < mGapBegin; i++) moved += mAdvances[i];
+		std::move_backward(mText.begin() + pos, mText.begin() + mGapBegin, mText.begin() + mGapEnd);
+		std::move_backward(mAdvances.begin() + pos, mAdvances.begin() + mGapBegin, mAdvances.begin() + mGapEnd);
+		mGapBegin -= n;
+		mGapEnd   -= n;
+		mCursorX  -= moved;
+	}
+	else if(pos > mGapBegin) {
+		size_t n = pos - mGapBegin;
+		float  moved = 0;
+		for(size_t i = mGapEnd; i < mGapEnd + n; i++) moved += mAdvances[i];
+		std::move(mText.begin() + mGapEnd, mText.begin() + mGapEnd + n, mText.begin() + mGapBegin);
+		std::move(mAdvances.begin() + mGapEnd, mAdvances.begin() + mGapEnd + n, mAdvances.begin() + mGapBegin);
+		mGapBegin += n;
+		mGapEnd   += n;
+		mCursorX  += moved;
+	}
+	if(mGapBegin == 0) mCursorX = 0; // Don't accumulate rounding errors
+}
+
+void TextBuffer::growGap(size_t n) {
+	if(mGapEnd - mGapBegin >= n) return;
+
+	// Grow geometrically so that a sequence of inserts is O(1) amortized
+	size_t tail    = mText.size() - mGapEnd;
+	size_t newSize = std::max(mText.size() * 2, size() + n + 64);
+	mText.resize(newSize);
+	mAdvances.resize(newSize);
+	std::move_backward(mText.begin() + mGapEnd, mText.begin() + mGapEnd + tail, mText.end());
+	std::move_backward(mAdvances.begin() + mGapEnd, mAdvances.begin() + mGapEnd + tail, mAdvances.end());
+	mGapEnd = newSize - tail;
+}
+
+void TextBuffer::eraseRange(size_t begin, size_t end) {
+	if(begin >= end) return;
+	moveGap(begin);
+	for(size_t i = mGapEnd; i < mGapEnd + (end - begin); i++) mWidth -= mAdvances[i];
+	mGapEnd += end - begin;
+	mAnchor  = mGapBegin;
+	if(empty()) mWidth = 0;
+}
+
+// =============================================================
+// == Editing =============================================
+// =============================================================
+
+void TextBuffer::assign(std::string_view utf8, Measure const& measure) {
+	mText.clear();
+	mAdvances.clear();
+	mGapBegin = mGapEnd = mAnchor = 0;
+	mCursorX = mWidth = 0;
+	insert(utf8, measure);
+}
+
+void TextBuffer::insert(std::string_view utf8, Measure const& measure) {
+	if(hasSelection()) eraseRange(selectionBegin(), selectionEnd());
+
+	growGap(utf8.size());
+	for(size_t i = 0; i < utf8.size();) {
+		size_t len = 1;
+		while(i + len < utf8.size() && isContinuationByte(utf8[i + len])) ++len;
+
+		float advance = measure ? measure(utf8.substr(i, len)) : 0;
+		for(size_t j = 0; j < len; j++) {
+			mText[mGapBegin]     = utf8[i + j];
+			mAdvances[mGapBegin] = j == 0 ? advance : 0;
+			++mGapBegin;
+		}
+		mCursorX += advance;
+		mWidth   += advance;
+		i += len;
+	}
+	mAnchor = mGapBegin;
+}
+
+void TextBuffer::eraseBackward() {
+	if(hasSelection())
+		eraseRange(selectionBegin(), selectionEnd());
+	else
+		eraseRange(prevCharacter(cursor()), cursor());
+}
+void TextBuffer::eraseForward() {
+	if(hasSelection())
+		eraseRange(selectionBegin(), selectionEnd());
+	else
+		eraseRange(cursor(), nextCharacter(cursor()));
+}
+
+void TextBuffer::remeasure(Measure const& measure) {
+	size_t anchor = mAnchor, cursor = mGapBegin;
+	std::string text = str();
+	assign(text, measure);
+	select(anchor, cursor);
+}
+
+// =============================================================
+// == Cursor & Selection =============================================
+// =============================================================
+
+float TextBuffer::xAt(size_t pos) const noexcept {
+	pos = std::min(pos, size());
+	float x = mCursorX;
+	if(pos < mGapBegin) {
+		for(size_t i = pos; i < mGapBegin; i++) x -= mAdvances[i];
+	}
+	else {
+		for(size_t i = mGapBegin; i < pos; i++) x += mAdvances[toIndex(i)];
+	}
+	return x;
+}
+
+size_t TextBuffer::positionAt(float x) const noexcept {
+	float left = 0;
+	for(size_t pos = 0; pos < size(); pos = nextCharacter(pos)) {
+		float advance = mAdvances[toIndex(pos)];
+		if(x < left + advance * .5f) return pos;
+		left += advance;
+	}
+	return size();
+}
+
+void TextBuffer::moveCursor(size_t pos, bool select) {
+	pos = std::min(pos, size());
+	while(pos > 0 && pos < size() && isContinuationByte((*this)[pos])) --pos;
+	size_t anchor = select ? mAnchor : pos;
+	moveGap(pos);
+	mAnchor = anchor;
+}
+void TextBuffer::moveLeft(bool select) {
+	if(!select && hasSelection())
+		moveCursor(selectionBegin());
+	else
+		moveCursor(prevCharacter(cursor()), select);
+}
+void TextBuffer::moveRight(bool select) {
+	if(!select && hasSelection())
+		moveCursor(selectionEnd());
+	else
+		moveCursor(nextCharacter(cursor()), select);
+}
+
+void TextBuffer::select(size_t anchor, size_t cursor) {
+	moveCursor(anchor);
+	moveCursor(cursor, true);
+}
+
+size_t TextBuffer::prevCharacter(size_t pos) const noexcept {
+	if(pos == 0) return 0;
+	--pos;
+	while(pos > 0 && isContinuationByte((*this)[pos])) --pos;
+	return pos;
+}
+size_t TextBuffer::nextCharacter(size_t pos) const noexcept {
+	if(pos >= size()) return size();
+	++pos;
+	while(pos < size() && isContinuationByte((*this)[pos])) ++pos;
+	return pos;
+}
+
+} // namespace wwidget
@@ -0,0 +1,108 @@
+#include "../include/wwidget/TextMetricsCache.hpp"
+
+#include <string>
+
+namespace wwidget {
+
+bool TextMetricsCache::Key::operator==(Key const& other) const noexcept {
+	return
+		font == other.font &&
+		size == other.size &&
+		letterSpacing == other.letterSpacing &&
+		wrapWidth == other.wrapWidth &&
+		textHash == other.textHash &&
+		text == other.text;
+}
+
+size_t TextMetricsCache::KeyHash::operator()(Key const& k) const noexcept {
+	size_t h = k.textHash;
+	auto combine = [&](size_t v) { h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2); };
+	combine(k.font);
+	combine(std::hash<float>()(k.size));
+	combine(std::hash<float>()(k.letterSpacing));
+	combine(std::hash<float>()(k.wrapWidth));
+	return h;
+}
+
+TextMetricsCache::TextMetricsCache(size_t capacity) :
+	mCapacity(capacity)
+{}
+
+Rect TextMetricsCache::bounds(Canvas& c, std::string_view font, float size, float letterSpacing, float wrapWidth, std::string_view txt, size_t txtHash) {
+	Key key { fnv1a(font), size, letterSpacing, wrapWidth, txt, txtHash };
+
+	auto iter = mIndex.find(key);
+	if(iter != mIndex.end()) {
+		mCounters.hits++;
+		mEntries.splice(mEntries.begin(), mEntries, iter->second);
+		return iter->second->bounds;
+	}
+
+	mCounters.misses++;
+
+	std::string fontName(font);
+	c.font(fontName.c_str())
+	 .fontSize(size)
+	 .fontLetterSpacing(letterSpacing);
+	Rect result = wrapWidth == NoWrap ?
+		c.textBounds({}, txt) :
+		c.textBoxBounds({}, wrapWidth, txt);
+
+	if(mCapacity == 0) return result;
+
+	while(mEntries.size() >= mCapacity) {
+		mIndex.erase(mEntries.back().key);
+		mEntries.pop_back();
+		mCounters.evictions++;
+	}
+	// The stored key has to refer to the entry's own copy of the string, not the caller's
+	mEntries.push_front({ std::string(txt), key, result });
+	Entry& entry = mEntries.front();
+	entry.key.text = entry.text;
+	mIndex.emplace(entry.key, mEntries.begin());
+
+	return result;
+}
+
+FontMetrics TextMetricsCache::fontMetrics(Canvas& c, std::string_view font, float size) {
+	Key key { fnv1a(font), size, 0, 0, {}, 0 };
+
+	auto iter = mFontMetrics.find(key);
+	if(iter != mFontMetrics.end()) {
+		mCounters.hits++;
+		return iter->second;
+	}
+
+	mCounters.misses++;
+
+	std::string fontName(font);
+	c.font(fontName.c_str())
+	 .fontSize(size);
+	FontMetrics result = c.fontMetrics();
+
+	// There are only a few fonts and sizes in use at a time, start over if that isn't true
+	if(mFontMetrics.size() >= 256) {
+		mCounters.evictions += mFontMetrics.size();
+		mFontMetrics.clear();
+	}
+	mFontMetrics.emplace(key, result);
+
+	return result;
+}
+
+void TextMetricsCache::clear() {
+	mEntries.clear();
+	mIndex.clear();
+	mFontMetrics.clear();
+}
+
+void TextMetricsCache::capacity(size_t n) {
+	mCapacity = n;
+	while(mEntries.size() > mCapacity) {
+		mIndex.erase(mEntries.back().key);
+		mEntries.pop_back();
+		mCounters.evictions++;
+	}
+}
+
+} // namespace wwidget
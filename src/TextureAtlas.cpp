@@ -0,0 +1,161 @@
+#include "../include/wwidget/TextureAtlas.hpp"
+
+#include "../include/wwidget/Bitmap.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace wwidget {
+
+TextureAtlas::TextureAtlas(unsigned pageSize, unsigned maxItemSize, unsigned padding) :
+	mPageSize(pageSize),
+	mMaxItemSize(std::min(maxItemSize, pageSize - 2 * padding)),
+	mPadding(padding)
+{}
+
+bool TextureAtlas::fits(unsigned w, unsigned h) const noexcept {
+	return w > 0 && h > 0 && w <= mMaxItemSize && h <= mMaxItemSize;
+}
+
+bool TextureAtlas::allocateOnPage(Page& page, unsigned w, unsigned h, Region& result) {
+	unsigned padW = w + 2 * mPadding;
+	unsigned padH = h + 2 * mPadding;
+
+	// Best fit: the lowest shelf that is tall enough, but not much taller
+	Shelf* best = nullptr;
+	for(auto& shelf : page.shelves) {
+		if(shelf.live == 0) shelf.used = 0;
+		if(shelf.height < padH || shelf.height > padH + padH / 2) continue;
+		if(mPageSize - shelf.used < padW) continue;
+		if(!best || shelf.height < best->height) best = &shelf;
+	}
+
+	if(!best) {
+		unsigned bottom = page.shelves.empty() ? 0 : page.shelves.back().y + page.shelves.back().height;
+		if(mPageSize - bottom >= padH) {
+			page.shelves.push_back({ bottom, padH, 0, 0 });
+			best = &page.shelves.back();
+		}
+	}
+	if(!best) {
+		// The page is full, waste some height rather than starting a new page
+		for(auto& shelf : page.shelves) {
+			if(shelf.height >= padH && mPageSize - shelf.used >= padW && (!best || shelf.height < best->height))
+				best = &shelf;
+		}
+		if(!best) return false;
+	}
+
+	result.x      = best->used + mPadding;
+	result.y      = best->y + mPadding;
+	result.width  = w;
+	result.height = h;
+	best->used += padW;
+	best->live++;
+	page.live++;
+	return true;
+}
+
+TextureAtlas::Region TextureAtlas::allocate(unsigned w, unsigned h) {
+	Region result;
+	if(!fits(w, h)) return result;
+
+	for(unsigned i = 0; i < mPages.size(); i++) {
+		if(mPages[i].pixels && allocateOnPage(mPages[i], w, h, result)) {
+			result.page = i;
+			return result;
+		}
+	}
+
+	// Reuse an evicted page if there is one
+	unsigned index = 0;
+	while(index < mPages.size() && mPages[index].pixels) ++index;
+	if(index == mPages.size()) mPages.emplace_back();
+
+	Page& page = mPages[index];
+	size_t bytes = (size_t) mPageSize * mPageSize * 4;
+	page.pixels.reset(new uint8_t[bytes]);
+	memset(page.pixels.get(), 0, bytes);
+
+	allocateOnPage(page, w, h, result);
+	result.page = index;
+	return result;
+}
+
+TextureAtlas::Region TextureAtlas::add(Bitmap const& bm) {
+	Region region = allocate(bm.width(), bm.height());
+	if(!region) return region;
+
+	unsigned components;
+	switch(bm.format()) {
+		case Bitmap::ALPHA: components = 1; break;
+		case Bitmap::RGB:   components = 3; break;
+		default:            components = 4; break;
+	}
+
+	uint8_t* pixels = mPages[region.page].pixels.get();
+	auto texel = [&](unsigned x, unsigned y) { return pixels + ((size_t) y * mPageSize + x) * 4; };
+
+	for(unsigned y = 0; y < bm.height(); y++) {
+		uint8_t const* src = bm.data() + (size_t) y * bm.width() * components;
+		uint8_t*       dst = texel(region.x, region.y + y);
+		for(unsigned x = 0; x < bm.width(); x++, src += components, dst += 4) {
+			switch(components) {
+				case 1: dst[0] = dst[1] = dst[2] = 255; dst[3] = src[0]; break;
+				case 3: dst[0] = src[0]; dst[1] = src[1]; dst[2] = src[2]; dst[3] = 255; break;
+				default: memcpy(dst, src, 4); break;
+			}
+		}
+	}
+
+	// Repeat the edges into the padding, so linear filtering doesn't blend in the neighbours
+	unsigned x0 = region.x, x1 = region.x + region.width - 1;
+	unsigned y0 = region.y, y1 = region.y + region.height - 1;
+	for(unsigned y = y0; y <= y1; y++) {
+		for(unsigned p = 1; p <= mPadding; p++) {
+			memcpy(texel(x0 - p, y), texel(x0, y), 4);
+			memcpy(texel(x1 + p, y), texel(x1, y), 4);
+		}
+	}
+	for(unsigned p = 1; p <= mPadding; p++) {
+		size_t rowBytes = (size_t) (region.width + 2 * mPadding) * 4;
+		memcpy(texel(x0 - mPadding, y0 - p), texel(x0 - mPadding, y0), rowBytes);
+		memcpy(texel(x0 - mPadding, y1 + p), texel(x0 - mPadding, y1), rowBytes);
+	}
+
+	return region;
+}
+
+bool TextureAtlas::release(Region const& region) {
+	if(!region || region.page >= mPages.size()) return false;
+
+	Page& page = mPages[region.page];
+	auto shelf = std::find_if(page.shelves.begin(), page.shelves.end(), [&](Shelf const& s) {
+		return region.y >= s.y && region.y < s.y + s.height;
+	});
+	if(shelf == page.shelves.end() || shelf->live == 0) return false;
+
+	shelf->live--;
+	page.live--;
+
+	if(page.live == 0) {
+		page.shelves.clear();
+		page.pixels.reset();
+		return true;
+	}
+
+	// Give the space of empty shelves at the bottom back to the page
+	while(!page.shelves.empty() && page.shelves.back().live == 0)
+		page.shelves.pop_back();
+	return false;
+}
+
+uint8_t const* TextureAtlas::pixels(unsigned page) const noexcept {
+	return page < mPages.size() ? mPages[page].pixels.get() : nullptr;
+}
+
+size_t TextureAtlas::pageCount() const noexcept {
+	return std::count_if(mPages.begin(), mPages.end(), [](Page const& p) { return p.pixels != nullptr; });
+}
+
+} // namespace wwidget
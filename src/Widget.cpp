@@ -3,6 +3,8 @@
 #include "../include/wwidget/Context.hpp"
 
 #include "../include/wwidget/Canvas.hpp"
+#include "../include/wwidget/InputQueue.hpp"
+#include "../include/wwidget/LayerCache.hpp"
 
 #include "../include/wwidget/Error.hpp"
 #include "../include/wwidget/AttributeCollector.hpp"
@@ -32,9 +34,15 @@ Widget::Widget() noexcept :
 	mFlags.needsRedraw        = true;
 	mFlags.childNeedsRedraw   = true;
 	mFlags.recalcPrefSize     = true;
+	mFlags.cacheAsLayer       = false;
+	mFlags.hovered            = false;
+	mFlags.handlers           = Click::handlerBit | KeyEvent::handlerBit; // The default on() for them handles focus
+	mFlags.subtreeHandlers    = mFlags.handlers;
 }
 
 Widget::~Widget() {
+	if(mFlags.cacheAsLayer && mContext) mContext->layers().remove(this);
+	if(mFlags.hovered && mContext) mContext->input().unhover(*this);
 	remove();
 	clearChildrenQuietly();
 }
@@ -48,6 +56,8 @@ Widget::Widget(Widget&& other) noexcept :
 }
 Widget& Widget::operator=(Widget&& other) noexcept {
 	remove();
+	if(mFlags.cacheAsLayer && mContext) mContext->layers().remove(this);
+	if(other.mFlags.hovered && other.mContext) other.mContext->input().unhover(other);
 
 	mName          = std::move(other.mName);
 	mClasses       = std::move(other.mClasses);
@@ -77,7 +87,14 @@ Widget& Widget::operator=(Widget&& other) noexcept {
 		}
 	}
 	mContext = other.mContext; other.mContext = nullptr;
+	unsigned handlers = mFlags.handlers; // Declared by the class of this, which other might not have
 	mFlags   = other.mFlags;
+	mFlags.handlers        = handlers;
+	mFlags.subtreeHandlers = handlers | other.mFlags.subtreeHandlers;
+	if(mFlags.cacheAsLayer && mContext) {
+		mContext->layers().remove(&other);
+		mContext->layers().add(this);
+	}
 	other.mFlags.childNeedsRelayout = false;
 	other.mFlags.needsRelayout      = true;
 	other.mFlags.focused            = false;
@@ -85,6 +102,9 @@ Widget& Widget::operator=(Widget&& other) noexcept {
 	other.mFlags.needsRedraw        = true;
 	other.mFlags.childNeedsRedraw   = true;
 	other.mFlags.recalcPrefSize     = true;
+	other.mFlags.cacheAsLayer       = false;
+	other.mFlags.hovered            = false;
+	other.mFlags.subtreeHandlers    = other.mFlags.handlers; // It has no children anymore
 
 	return *this;
 }
@@ -99,16 +119,59 @@ Widget::Widget(Widget const& other) noexcept :
 Widget& Widget::operator=(Widget const& other) noexcept {
 	mName    = other.mName; // TODO: Should the copy constructor copy the name?
 	mClasses = other.mClasses;
+	auto flags = mFlags;
 	mFlags   = other.mFlags;
+	mFlags.cacheAsLayer    = flags.cacheAsLayer;
+	mFlags.hovered         = flags.hovered;
+	mFlags.handlers        = flags.handlers; // other might be another class, and has other children
+	mFlags.subtreeHandlers = flags.subtreeHandlers;
+	cacheAsLayer(other.mFlags.cacheAsLayer);
 	return *this;
 }
 
+// ** Clone *******************************************************
+
+shared<Widget> Widget::onClone() const {
+	auto copy = make_shared<Widget>();
+	cloneAttributes(*copy);
+	return copy;
+}
+
+void Widget::cloneAttributes(Widget& to) const {
+	to.mName    = mName;
+	to.mClasses = mClasses;
+	to.size(mSize);
+	to.set(mOffset);
+	to.set(mAlign);
+	to.set(mPadding);
+	to.cacheAsLayer(mFlags.cacheAsLayer);
+}
+
+shared<Widget> Widget::clone() const {
+	shared<Widget> copy = onClone();
+	if(typeid(*copy) != typeid(*this)) {
+		throw exceptions::InvalidOperation(std::string(typeid(*this).name()) + " can't be cloned, it doesn't implement onClone()");
+	}
+
+	Widget* last = nullptr;
+	for(Widget* child = mChildren.get(); child; child = child->mNextSibling.get()) {
+		auto childCopy = child->clone();
+		if(last) last->insertNextSibling(childCopy);
+		else     copy->add(childCopy);
+		last = childCopy.get();
+	}
+	return copy;
+}
+
 // ** Tree operations *******************************************************
 
 void Widget::notifyChildAdded(Widget& newChild) {
 	newChild.context(context());
 	newChild.onAddTo(*this);
 	onAdd(newChild);
+	for(Widget* p = this; p && (p->mFlags.subtreeHandlers | newChild.mFlags.subtreeHandlers) != p->mFlags.subtreeHandlers; p = p->parent().get()) {
+		p->mFlags.subtreeHandlers |= newChild.mFlags.subtreeHandlers;
+	}
 	if(newChild.needsRelayout()) {
 		onChildPreferredSizeChanged(newChild);
 
@@ -123,6 +186,16 @@ void Widget::notifyChildAdded(Widget& newChild) {
 void Widget::notifyChildRemoved(Widget& noLongerChild) {
 	noLongerChild.onRemoveFrom(*this);
 	onRemove(noLongerChild);
+	// Only event types the removed subtree handled can disappear from the masks of the parents
+	unsigned removed = noLongerChild.mFlags.subtreeHandlers;
+	for(Widget* p = this; p && (removed & ~p->mFlags.handlers); p = p->parent().get()) {
+		unsigned mask = p->mFlags.handlers;
+		for(Widget* c = p->mChildren.get(); c && mask != p->mFlags.subtreeHandlers; c = c->mNextSibling.get())
+			mask |= c->mFlags.subtreeHandlers;
+		if(mask == p->mFlags.subtreeHandlers) break;
+		p->mFlags.subtreeHandlers = mask;
+	}
+	requestRedraw();
 }
 
 shared<Widget> Widget::add(shared<Widget> w) {
@@ -227,6 +300,7 @@ shared<Widget> Widget::removeQuiet() {
 	shared<Widget> result = *this;
 
 	removeFocus();
+	if(mFlags.hovered && mContext) mContext->input().unhover(*this);
 	if(mParent) {
 		if(auto prev = mPrevSibling.lock()) {
 			if(mNextSibling) {
@@ -306,9 +380,10 @@ shared<Widget> Widget::lastChild() const noexcept {
 		return nullptr;
 	}
 
-	shared<Widget> w = children();
-	while(w->nextSibling()) w = w->nextSibling();
-	return w;
+	// Without copying shared pointers on the way, adding to long lists would be dominated by reference counting
+	Widget* w = mChildren.get();
+	while(w->mNextSibling) w = w->mNextSibling.get();
+	return *w;
 }
 
 // Tree changed events
@@ -452,6 +527,8 @@ void Widget::on(Click const& c) {
 void Widget::on(Scroll  const& s) { }
 void Widget::on(Moved   const& c) { }
 void Widget::on(Dragged const& s) { }
+void Widget::on(Enter   const& e) { }
+void Widget::on(Leave   const& e) { }
 void Widget::on(KeyEvent  const& k) {
 	if(k.scancode == 9 && focused()) {
 		removeFocus();
@@ -459,61 +536,55 @@ void Widget::on(KeyEvent  const& k) {
 }
 void Widget::on(TextInput const& t) { }
 
+Widget& Widget::handles(unsigned eventBits) noexcept {
+	mFlags.handlers = eventBits;
+	if(!mChildren) mFlags.subtreeHandlers = eventBits;
+	for(Widget* p = this; p && (p->mFlags.subtreeHandlers | eventBits) != p->mFlags.subtreeHandlers; p = p->parent().get()) {
+		p->mFlags.subtreeHandlers |= eventBits;
+	}
+	return *this;
+}
+
 void Widget::onDescendendFocused(Rect const& area, Widget& w) {}
 bool Widget::onFocus(bool b, FocusType type) { return !b; }
 
 // Drawing events
 void Widget::onDrawBackground(Canvas& graphics) {}
 void Widget::onDraw(Canvas& graphics) {}
+std::pair<Widget*, Widget*> Widget::visibleChildren(Rect const& area) {
+	return { children().get(), nullptr };
+}
 
 // Attributes
-bool Widget::setAttribute(std::string_view s, Attribute const& value) {
-	switch(fnv1a(s)) {
-	case fnv1a("name"):
-		mName.reset(value.toString());
-		return true;
-	case fnv1a("class"):
-		classes(value.toString());
-		return true;
-	case fnv1a("width"):
-		size(value.toFloat(), height());
-		return true;
-	case fnv1a("height"):
-		size(width(), value.toFloat());
-		return true;
-	case fnv1a("offset"):
-		set((Offset)value.toPoint()); // TODO: Attribute::toOffset
-		align(AlignNone);
-		return true;
-	case fnv1a("x"):
-		offset(value.toFloat(), offsety());
-		alignx(AlignNone);
-		return true;
-	case fnv1a("y"):
-		offset(offsetx(), value.toFloat());
-		aligny(AlignNone);
-		return true;
-	case fnv1a("align"):
-		align(value.toAlignment());
-		return true;
-	case fnv1a("alignx"):
-		alignx(value.toAlignment().x); // TODO: Attribute::toHalfAlignment
-		return true;
-	case fnv1a("aligny"):
-		aligny(value.toAlignment().y); // TODO: Attribute::toHalfAlignment
-		return true;
-	case fnv1a("padding"):
-		set(value.toPadding());
-		return true;
-	case fnv1a("text"):
-		text(value.toString());
-		return true;
-	case fnv1a("image"):
-		image(value.toString());
-		return true;
-	}
-
-	return false;
+AttributeTable const& Widget::classAttributes() noexcept {
+	static constexpr AttributeInfo attributes[] = {
+		{ "name",    [](Widget& w, std::string s) { w.mName.reset(s); },        [](Widget const& w) { return std::string(w.name()); }, "$.name(%);" },
+		{ "class",   [](Widget& w, std::string s) { w.classes(s); },            nullptr, "$.classes(%);" },
+		{ "width",   [](Widget& w, float f) { w.size(f, w.height()); },         [](Widget const& w) { return w.width(); }, "$.size(%, $.height());" },
+		{ "height",  [](Widget& w, float f) { w.size(w.width(), f); },          [](Widget const& w) { return w.height(); }, "$.size($.width(), %);" },
+		{ "offset",  [](Widget& w, Offset o) { w.set(o); w.align(AlignNone); }, [](Widget const& w) { return w.offset(); }, "$.set(%); $.align(AlignNone);" },
+		{ "x",       [](Widget& w, float f) { w.offset(f, w.offsety()); w.alignx(AlignNone); }, [](Widget const& w) { return w.offsetx(); }, "$.offset(%, $.offsety()); $.alignx(AlignNone);" },
+		{ "y",       [](Widget& w, float f) { w.offset(w.offsetx(), f); w.aligny(AlignNone); }, [](Widget const& w) { return w.offsety(); }, "$.offset($.offsetx(), %); $.aligny(AlignNone);" },
+		{ "align",   [](Widget& w, Alignment a) { w.align(a); },                [](Widget const& w) { return w.mAlign; }, "$.align(%);" },
+		{ "alignx",  [](Widget& w, HalfAlignment a) { w.alignx(a); },           [](Widget const& w) { return w.alignx(); }, "$.alignx(%);" },
+		{ "aligny",  [](Widget& w, HalfAlignment a) { w.aligny(a); },           [](Widget const& w) { return w.aligny(); }, "$.aligny(%);" },
+		{ "padding", [](Widget& w, Padding p) { w.set(p); },                    [](Widget const& w) { return w.padding(); }, "$.set(%);" },
+		{ "text",    [](Widget& w, std::string s) { w.text(s); },               nullptr, "$.text(%);" },
+		{ "image",   [](Widget& w, std::string s) { w.image(s); },              nullptr, "$.image(%);" },
+		{ "cacheAsLayer", [](Widget& w, bool b) { w.cacheAsLayer(b); },         [](Widget const& w) { return w.cacheAsLayer(); }, "$.cacheAsLayer(%);" },
+	};
+	static constexpr AttributeTable table("wwidget::Widget", attributes);
+	return table;
+}
+AttributeTable const& Widget::attributeTable() const noexcept {
+	return classAttributes();
+}
+
+bool Widget::setAttribute(std::string_view name, Attribute const& value) {
+	AttributeInfo const* attribute = attributeTable().find(name);
+	if(!attribute) return false;
+	attribute->set(*this, value);
+	return true;
 }
 
 void Widget::getAttributes(wwidget::AttributeCollectorInterface& collector) {
@@ -557,6 +628,7 @@ void Widget::getAttributes(wwidget::AttributeCollectorInterface& collector) {
 	collector("offset",  offset(), { alignx() == AlignNone ? offsetx() : 0, aligny() == AlignNone ? offsety() : 0 });
 	collector("align",   mAlign, Alignment{AlignDefault});
 	collector("padding", mPadding, {});
+	collector("cacheAsLayer", cacheAsLayer(), false);
 	// TODO: text() and image()
 
 	collector.endSection();
@@ -566,25 +638,34 @@ template<typename T>
 bool Widget::sendEvent(T const& t, bool skip_focused) {
 	if(t.handled) return t.handled;
 
+	if(!(mFlags.subtreeHandlers & T::handlerBit)) return t.handled;
+
 	if(T::positional && !Rect(size()).contains(t.position)) return t.handled;
 
 	if(skip_focused && focused()) return t.handled;
 
 	t.direction = Event::DIR_DOWN;
-	on(t);
+	if(mFlags.handlers & T::handlerBit) on(t);
 
-	for(shared<Widget> child = lastChild(); !t.handled && child; child = child->prevSibling()) {
+	// Whether a child might handle it, only known if the event went past all of them
+	bool childHandles = false;
+	shared<Widget> child = lastChild();
+	for(; !t.handled && child; child = child->prevSibling()) {
 		Point old_pos = t.position;
 		t.position.x -= child->offsetx();
 		t.position.y -= child->offsety();
 		child->sendEvent(t, skip_focused);
 		t.position = old_pos;
+		childHandles = childHandles || (child->mFlags.subtreeHandlers & T::handlerBit);
 	}
 
 	if(t.handled) return t.handled;
 
 	t.direction = Event::DIR_UP;
-	on(t);
+	if(mFlags.handlers & T::handlerBit) on(t);
+
+	if(!child && !childHandles && !(mFlags.handlers & T::handlerBit))
+		mFlags.subtreeHandlers &= ~T::handlerBit;
 
 	return t.handled;
 };
@@ -624,18 +705,32 @@ bool Widget::send(TextInput const& character) {
 }
 
 void Widget::drawRecursive(Canvas& canvas, bool minimal) {
+	drawRecursive(canvas, minimal, Rect(size()));
+}
+void Widget::drawRecursive(Canvas& canvas, bool minimal, Rect const& area) {
 	// TODO: don't ignore minimal
 	onDrawBackground(canvas);
 
-	eachChild([&](shared<Widget> w) {
-		if(w->offsetx() > -w->width() && w->offsety() > -w->height() && w->offsetx() < width() && w->offsety() < height()) {
+	auto [first, end] = visibleChildren(area);
+	for(Widget* w = first; w != end; w = w->nextSibling().get()) {
+		Rect bounds(w->offset(), w->size());
+		if(bounds.max.x > area.min.x && bounds.max.y > area.min.y && bounds.min.x < area.max.x && bounds.min.y < area.max.y) {
 			canvas.pushState();
-			canvas.scissorIntersect({w->offset(), w->size()});
+			canvas.scissorIntersect(bounds);
 			canvas.translate(w->offsetx(), w->offsety());
-			w->drawRecursive(canvas, minimal);
+			Layer const* layer = w->mFlags.cacheAsLayer && mContext ? mContext->layers().find(w) : nullptr;
+			if(layer) {
+				canvas.drawLayer(*layer, {0, 0, (float) layer->width, (float) layer->height}); // 1:1, the scissor cuts off what ceil() added
+			}
+			else {
+				Rect visible = area.clip(bounds);
+				w->drawRecursive(canvas, minimal, Rect::absolute(
+					visible.min.x - w->offsetx(), visible.min.y - w->offsety(),
+					visible.max.x - w->offsetx(), visible.max.y - w->offsety()));
+			}
 			canvas.popState();
 		}
-	});
+	}
 
 	onDraw(canvas);
 
@@ -676,6 +771,7 @@ bool Widget::forceRelayout(PreferredSize const& constraint) {
 
 	mFlags.needsRelayout = false;
 	onLayout();
+	requestRedraw(); // Children might have moved
 
 	if(!mFlags.childNeedsRelayout) return false;
 
@@ -715,12 +811,10 @@ void Widget::paddingChanged() {
 
 
 void Widget::requestRedraw() {
-	if(!mFlags.needsRedraw) {
-		for(shared<Widget> p = parent(); p && !p->mFlags.childNeedsRedraw; p = p->parent()) {
-			if(p->mFlags.childNeedsRedraw)
-				break;
-			p->mFlags.childNeedsRedraw = true;
-		}
+	mFlags.needsRedraw = true;
+	// Not stopping at parents which are already flagged: they might have been skipped by the last draw
+	for(shared<Widget> p = parent(); p; p = p->parent()) {
+		p->mFlags.childNeedsRedraw = true;
 	}
 }
 
@@ -972,6 +1066,11 @@ Widget& Widget::context(Context* app) {
 	if(mContext != app) {
 		Context* oldContext = mContext;
 		mContext = app;
+		if(mFlags.hovered && oldContext) oldContext->input().unhover(*this);
+		if(mFlags.cacheAsLayer) {
+			if(oldContext) oldContext->layers().remove(this);
+			if(mContext) mContext->layers().add(this);
+		}
 		eachChild([&](shared<Widget> w) {
 			if(w->context() == oldContext || w->context() == nullptr) {
 				w->context(mContext);
@@ -982,6 +1081,18 @@ Widget& Widget::context(Context* app) {
 	return *this;
 }
 
+Widget& Widget::cacheAsLayer(bool b) {
+	if(mFlags.cacheAsLayer != b) {
+		mFlags.cacheAsLayer = b;
+		if(mContext) {
+			if(b) mContext->layers().add(this);
+			else  mContext->layers().remove(this);
+		}
+		requestRedraw();
+	}
+	return *this;
+}
+
 void Widget::defer(std::function<void()> fn) {
 	auto* a = context();
 	if(a) {
@@ -993,6 +1104,15 @@ void Widget::defer(std::function<void()> fn) {
 		fn();
 	}
 }
+void Widget::defer(TaskPriority priority, std::function<void()> fn) {
+	auto* a = context();
+	if(a) {
+		a->defer(priority, std::move(fn));
+	}
+	else {
+		fn();
+	}
+}
 // void Widget::deferDraw(std::function<void()> fn) {
 // 	auto* a = context();
 // 	assert(a);
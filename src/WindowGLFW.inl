@@ -1,6 +1,8 @@
 #include "../include/wwidget/Window.hpp"
 
 #include "../include/wwidget/CanvasNVG.cpp"
+#include "../include/wwidget/InputQueue.hpp"
+#include "../include/wwidget/LayerCache.hpp"
 
 #include <GLFW/glfw3.h>
 
@@ -42,9 +44,21 @@ static PFNGLUNIFORM2FVPROC               glUniform2fv;
 static PFNGLDISABLEVERTEXATTRIBARRAYPROC glDisableVertexAttribArray;
 static PFNGLDELETEVERTEXARRAYSPROC       glDeleteVertexArrays;
 static PFNGLDELETEBUFFERSPROC            glDeleteBuffers;
+// Offscreen layers, see nanovg_gl_utils.h
+static PFNGLGENFRAMEBUFFERSPROC          glGenFramebuffers;
+static PFNGLBINDFRAMEBUFFERPROC          glBindFramebuffer;
+static PFNGLFRAMEBUFFERTEXTURE2DPROC     glFramebufferTexture2D;
+static PFNGLCHECKFRAMEBUFFERSTATUSPROC   glCheckFramebufferStatus;
+static PFNGLDELETEFRAMEBUFFERSPROC       glDeleteFramebuffers;
+static PFNGLGENRENDERBUFFERSPROC         glGenRenderbuffers;
+static PFNGLBINDRENDERBUFFERPROC         glBindRenderbuffer;
+static PFNGLRENDERBUFFERSTORAGEPROC      glRenderbufferStorage;
+static PFNGLFRAMEBUFFERRENDERBUFFERPROC  glFramebufferRenderbuffer;
+static PFNGLDELETERENDERBUFFERSPROC      glDeleteRenderbuffers;
 
 
 #include <nanovg_gl.h>
+#include <nanovg_gl_utils.h>
 
 #include <stdexcept>
 #include <iostream>
@@ -55,6 +69,33 @@ namespace wwidget {
 
 static int gNumWindows = 0;
 
+// == Offscreen layers of CanvasNVG ==
+static GLint gLayerViewport[4]; // Of the window, restored when a layer is done
+
+static
+void* createLayerTarget(NVGcontext* ctx, unsigned width, unsigned height, int* image) {
+	NVGLUframebuffer* fb = nvgluCreateFramebuffer(ctx, width, height, 0);
+	if(fb) *image = fb->image;
+	return fb;
+}
+static
+void beginLayerTarget(void* target, unsigned width, unsigned height) {
+	glGetIntegerv(GL_VIEWPORT, gLayerViewport);
+	nvgluBindFramebuffer((NVGLUframebuffer*) target);
+	glViewport(0, 0, width, height);
+	glClearColor(0, 0, 0, 0);
+	glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+}
+static
+void endLayerTarget(void* target) {
+	nvgluBindFramebuffer(nullptr);
+	glViewport(gLayerViewport[0], gLayerViewport[1], gLayerViewport[2], gLayerViewport[3]);
+}
+static
+void destroyLayerTarget(void* target) {
+	nvgluDeleteFramebuffer((NVGLUframebuffer*) target);
+}
+
 static
 void myGlfwErrorCallback(int level, const char* msg) {
 	std::cerr << "GLFW: (" << level << "): " << msg << std::endl;
@@ -70,6 +111,12 @@ void myGlfwWindowResized(GLFWwindow* win, int width, int height) {
 	glViewport(0, 0, width, height);
 }
 
+static
+void myGlfwWindowRefresh(GLFWwindow* win) {
+	Window* window = (Window*) glfwGetWindowUserPointer(win);
+	window->redraw(); // The contents were damaged, e.g. by other windows
+}
+
 static
 void myGlfwWindowPosition(GLFWwindow* win, int x, int y) {
 	Window* window = (Window*) glfwGetWindowUserPointer(win);
@@ -99,12 +146,13 @@ void myGlfwCursorPosition(GLFWwindow* win, double x, double y) {
 	drag.position.y = window->mouse().y = y + window->offsety();
 	drag.moved_x    = drag.position.x - drag.old_x;
 	drag.moved_y    = drag.position.y - drag.old_y;
+	drag.time       = glfwGetTime();
 
 	if(window->mouse().buttons.any()) {
-		window->send(drag);
+		window->input().push(drag);
 	}
 	else {
-		window->send((Moved&)drag);
+		window->input().push((Moved&)drag);
 	}
 }
 
@@ -120,7 +168,8 @@ void myGlfwClick(GLFWwindow* win, int button, int action, int mods) {
 		case GLFW_PRESS:   click.state = Event::DOWN; break;
 		case GLFW_REPEAT:  click.state = Event::DOWN_REPEATING; break;
 	}
-	window->send(click);
+	click.time = glfwGetTime();
+	window->input().push(click);
 }
 
 static
@@ -134,7 +183,8 @@ void myGlfwScroll(GLFWwindow* win, double x, double y) {
 	scroll.clicks_y = (float) y;
 	scroll.pixels_x = scroll.clicks_x * 48;
 	scroll.pixels_y = scroll.clicks_y * 48;
-	window->send(scroll);
+	scroll.time = glfwGetTime();
+	window->input().push(scroll);
 }
 
 static
@@ -152,7 +202,8 @@ void myGlfwKeyInput(GLFWwindow* win, int key, int scancode, int action, int mods
 	k.mods     = mods;
 	k.key      = key;
 	k.scancode = scancode;
-	window->send(k);
+	k.time = glfwGetTime();
+	window->input().push(k);
 }
 
 static
@@ -166,7 +217,8 @@ void myGlfwCharInput(GLFWwindow* win, unsigned int codepoint, int mods) {
 
 	t.utf32 = codepoint;
 	t.calcUtf8();
-	window->send(t);
+	t.time = glfwGetTime();
+	window->input().push(t);
 }
 
 
@@ -185,6 +237,8 @@ Window::Window(const char* title, unsigned width, unsigned height, uint32_t flag
 
 Window::~Window() {
 	clearChildren();
+	// BasicContext is destroyed before Widget, detach while both are complete
+	BasicContext::rootWidget(nullptr);
 	close();
 }
 
@@ -242,6 +296,7 @@ void Window::open(const char* title, unsigned width, unsigned height, uint32_t f
 	glfwSetFramebufferSizeCallback(mWindow, myGlfwWindowResized);
 	glfwSetWindowPosCallback(mWindow, myGlfwWindowPosition);
 	glfwSetWindowIconifyCallback(mWindow, myGlfwWindowIconify);
+	glfwSetWindowRefreshCallback(mWindow, myGlfwWindowRefresh);
 
 	glfwSetCursorPosCallback(mWindow, myGlfwCursorPosition);
 	glfwSetMouseButtonCallback(mWindow, myGlfwClick);
@@ -252,6 +307,7 @@ void Window::open(const char* title, unsigned width, unsigned height, uint32_t f
 	glfwSwapInterval((flags & FlagNoVsync) == 0 ? 1 : 0);
 
 	mFlags = flags;
+	renderOnDemand(flags & FlagRenderOnDemand);
 
 	#define GLPROC(NAME) NAME = reinterpret_cast<decltype(NAME)>(glfwGetProcAddress(#NAME))
 	GLPROC(glBlendFuncSeparate);
@@ -287,17 +343,37 @@ void Window::open(const char* title, unsigned width, unsigned height, uint32_t f
 	GLPROC(glDisableVertexAttribArray);
 	GLPROC(glDeleteVertexArrays);
 	GLPROC(glDeleteBuffers);
+	GLPROC(glGenFramebuffers);
+	GLPROC(glBindFramebuffer);
+	GLPROC(glFramebufferTexture2D);
+	GLPROC(glCheckFramebufferStatus);
+	GLPROC(glDeleteFramebuffers);
+	GLPROC(glGenRenderbuffers);
+	GLPROC(glBindRenderbuffer);
+	GLPROC(glRenderbufferStorage);
+	GLPROC(glFramebufferRenderbuffer);
+	GLPROC(glDeleteRenderbuffers);
 	#undef GLPROC
 
 	// TODO: don't ignore FlagAnaglyph3d
-	canvas(make_shared<CanvasNVG>(nvgCreateGL3((flags & FlagAntialias) ? NVG_ANTIALIAS : 0), nvgDeleteGL3));
+	auto nvg = make_shared<CanvasNVG>(nvgCreateGL3((flags & FlagAntialias) ? NVG_ANTIALIAS : 0), nvgDeleteGL3);
+	CanvasNVG::Offscreen offscreen;
+	offscreen.create  = createLayerTarget;
+	offscreen.begin   = beginLayerTarget;
+	offscreen.end     = endLayerTarget;
+	offscreen.destroy = destroyLayerTarget;
+	nvg->offscreen(offscreen);
+	canvas(std::move(nvg));
 
 	++gNumWindows;
 }
 
 void Window::close() {
 	if(mWindow) {
+		glfwMakeContextCurrent(mWindow);
+		layers().clear(); // Their framebuffers belong to the window's GL context
 		glfwDestroyWindow(mWindow);
+		mWindow = nullptr;
 		--gNumWindows;
 		if(gNumWindows <= 0) {
 			glfwTerminate();
@@ -312,8 +388,8 @@ void Window::requestClose() {
 }
 
 bool Window::update() {
-	if(mFlags & FlagUpdateOnEvent)
-		glfwWaitEvents();
+	if(mFlags & (FlagUpdateOnEvent | FlagRenderOnDemand))
+		waitEvents();
 	else
 		glfwPollEvents();
 
@@ -322,6 +398,32 @@ bool Window::update() {
 	return !glfwWindowShouldClose(mWindow);
 }
 
+void Window::waitEvents() {
+	// Something is waiting to be drawn, e.g. a widget requested a redraw while it was drawn
+	if(needsDraw()) {
+		glfwPollEvents();
+		return;
+	}
+
+	auto deadline = frameDeadline();
+	if(deadline == Clock::time_point::max()) {
+		glfwWaitEvents();
+	}
+	else {
+		auto now = Clock::now();
+		if(deadline > now)
+			glfwWaitEventsTimeout(std::chrono::duration<double>(deadline - now).count());
+		else
+			glfwPollEvents();
+	}
+}
+
+void Window::wakeup() {
+	if(mWindow) {
+		glfwPostEmptyEvent();
+	}
+}
+
 void Window::keepOpen() {
 	while(update()) {
 		draw();
@@ -360,6 +462,8 @@ float calcDPI(GLFWwindow* window) {
 }
 
 void Window::draw(float dpi) {
+	if(renderOnDemand() && !needsDraw()) return; // Keep the last frame, without clearing or swapping
+
 	glfwMakeContextCurrent(mWindow);
 
 	glClear(GL_COLOR_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
@@ -0,0 +1,229 @@
+#include "../../include/wwidget/async/FileWatcher.hpp"
+
+#include "../../include/wwidget/Error.hpp"
+
+#include <filesystem>
+#include <set>
+#include <vector>
+
+#ifdef __linux__
+#	include <cerrno>
+#	include <cstring>
+#	include <poll.h>
+#	include <sys/inotify.h>
+#	include <unistd.h>
+#else
+#	include <chrono>
+#	include <condition_variable>
+#endif
+
+namespace wwidget {
+
+namespace {
+
+std::string directoryOf(std::string const& path) {
+	auto dir = std::filesystem::path(path).parent_path().string();
+	return dir.empty() ? "." : dir;
+}
+std::string filenameOf(std::string const& path) {
+	return std::filesystem::path(path).filename().string();
+}
+
+} // namespace
+
+#ifdef __linux__
+
+// =============================================================
+// == inotify =============================================
+// =============================================================
+
+struct FileWatcher::Implementation {
+	int fd      = -1;
+	int stop[2] = { -1, -1 }; //!< Written to by the destructor to end the thread
+
+	struct Directory {
+		int    wd;
+		size_t count = 0; //!< Paths in it, by this spelling of the directory
+	};
+	std::map<std::string, Directory> directories;
+	std::map<int, size_t>            watches; //!< Spellings of the directory by watch descriptor, they are the same for the same directory
+};
+
+FileWatcher::FileWatcher(Callback callback) :
+	mCallback(std::move(callback)),
+	mImpl(new Implementation)
+{
+	mImpl->fd = inotify_init1(IN_CLOEXEC);
+	if(mImpl->fd < 0 || pipe(mImpl->stop) != 0) {
+		int error = errno;
+		if(mImpl->fd >= 0) close(mImpl->fd);
+		delete mImpl;
+		throw exceptions::InvalidOperation(std::string("Can't watch files: ") + strerror(error));
+	}
+	mThread = std::thread([this]() { threadMain(); });
+}
+FileWatcher::~FileWatcher() {
+	char c = 0;
+	(void) !write(mImpl->stop[1], &c, 1);
+	mThread.join();
+	close(mImpl->fd);
+	close(mImpl->stop[0]);
+	close(mImpl->stop[1]);
+	delete mImpl;
+}
+
+void FileWatcher::add(std::string const& path) {
+	std::lock_guard<std::mutex> lock(mMutex);
+	if(mPaths[path]++ > 0) return;
+
+	auto  name = directoryOf(path);
+	auto& dir  = mImpl->directories[name];
+	if(dir.count++ > 0) return;
+
+	dir.wd = inotify_add_watch(mImpl->fd, name.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_ATTRIB);
+	if(dir.wd < 0) {
+		int error = errno;
+		mImpl->directories.erase(name);
+		mPaths.erase(path);
+		throw exceptions::FailedLoadingFile(path, std::string("Can't watch ") + name + ": " + strerror(error));
+	}
+	mImpl->watches[dir.wd]++;
+}
+
+void FileWatcher::remove(std::string const& path) {
+	std::lock_guard<std::mutex> lock(mMutex);
+	auto iter = mPaths.find(path);
+	if(iter == mPaths.end() || --iter->second > 0) return;
+	mPaths.erase(iter);
+
+	auto dir = mImpl->directories.find(directoryOf(path));
+	if(--dir->second.count > 0) return;
+	int wd = dir->second.wd;
+	mImpl->directories.erase(dir);
+	if(--mImpl->watches[wd] == 0) {
+		mImpl->watches.erase(wd);
+		inotify_rm_watch(mImpl->fd, wd);
+	}
+}
+
+void FileWatcher::threadMain() {
+	alignas(inotify_event) char buffer[4096];
+	pollfd fds[2] = {
+		{ mImpl->fd,      POLLIN, 0 },
+		{ mImpl->stop[0], POLLIN, 0 },
+	};
+	while(true) {
+		if(poll(fds, 2, -1) < 0) {
+			if(errno == EINTR) continue;
+			return;
+		}
+		if(fds[1].revents) return;
+
+		ssize_t size = read(mImpl->fd, buffer, sizeof(buffer));
+		if(size <= 0) continue;
+
+		// Editors usually cause several events per save, they are reported once
+		std::set<std::string> changed;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			for(char* p = buffer; p < buffer + size; ) {
+				auto* event = reinterpret_cast<inotify_event*>(p);
+				p += sizeof(inotify_event) + event->len;
+				if(!event->len) continue;
+
+				for(auto& [path, count] : mPaths) {
+					auto dir = mImpl->directories.find(directoryOf(path));
+					if(dir != mImpl->directories.end() && dir->second.wd == event->wd && filenameOf(path) == event->name)
+						changed.insert(path);
+				}
+			}
+		}
+		for(auto& path : changed) this->changed(path);
+	}
+}
+
+#else
+
+// =============================================================
+// == Polling =============================================
+// =============================================================
+
+struct FileWatcher::Implementation {
+	std::condition_variable                                condition;
+	bool                                                   stop = false;
+	std::map<std::string, std::filesystem::file_time_type> modified;
+};
+
+FileWatcher::FileWatcher(Callback callback) :
+	mCallback(std::move(callback)),
+	mImpl(new Implementation)
+{
+	mThread = std::thread([this]() { threadMain(); });
+}
+FileWatcher::~FileWatcher() {
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mImpl->stop = true;
+	}
+	mImpl->condition.notify_one();
+	mThread.join();
+	delete mImpl;
+}
+
+void FileWatcher::add(std::string const& path) {
+	std::error_code error;
+	auto modified = std::filesystem::last_write_time(path, error);
+
+	std::lock_guard<std::mutex> lock(mMutex);
+	if(mPaths[path]++ > 0) return;
+	mImpl->modified[path] = modified;
+}
+
+void FileWatcher::remove(std::string const& path) {
+	std::lock_guard<std::mutex> lock(mMutex);
+	auto iter = mPaths.find(path);
+	if(iter == mPaths.end() || --iter->second > 0) return;
+	mPaths.erase(iter);
+	mImpl->modified.erase(path);
+}
+
+void FileWatcher::threadMain() {
+	std::unique_lock<std::mutex> lock(mMutex);
+	while(!mImpl->condition.wait_for(lock, std::chrono::milliseconds(pollInterval), [this]() { return mImpl->stop; })) {
+		std::vector<std::string> changed;
+		for(auto& [path, modified] : mImpl->modified) {
+			std::error_code error;
+			auto now = std::filesystem::last_write_time(path, error);
+			if(!error && now != modified) {
+				modified = now;
+				changed.push_back(path);
+			}
+		}
+
+		lock.unlock();
+		for(auto& path : changed) this->changed(path);
+		lock.lock();
+	}
+}
+
+#endif
+
+// =============================================================
+// == Common =============================================
+// =============================================================
+
+void FileWatcher::changed(std::string const& path) {
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		if(!mPaths.count(path)) return;
+	}
+	// Without the lock, so the callback can add and remove paths
+	mCallback(path);
+}
+
+size_t FileWatcher::size() {
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mPaths.size();
+}
+
+} // namespace wwidget
@@ -1,30 +1,136 @@
 #include "../../include/wwidget/async/Queue.hpp"
 
+#include <stdexcept>
+
 namespace wwidget {
 
-TaskQueue::TaskQueue() {
+TaskQueue::TaskQueue(size_t capacity) :
+	mEnqueuePos(0),
+	mDequeuePos(0),
+	mHasOverflow(false),
+	mSignaled(false)
+{
+	if(capacity < 2 || (capacity & (capacity - 1)) != 0) {
+		throw std::invalid_argument("TaskQueue capacity has to be a power of two");
+	}
 
+	mSlots.reset(new Slot[capacity]);
+	mMask = capacity - 1;
+	for(size_t i = 0; i < capacity; i++) {
+		mSlots[i].sequence.store(i, std::memory_order_relaxed);
+	}
 }
 TaskQueue::~TaskQueue() {
 
 }
 
-void TaskQueue::add(std::function<void()> fn) {
-	mMutex.lock();
-	mTasks.emplace_back(std::move(fn));
-	mMutex.unlock();
+bool TaskQueue::tryPush(Task& t) {
+	size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+	Slot*  slot;
+	while(true) {
+		slot = &mSlots[pos & mMask];
+		size_t   seq  = slot->sequence.load(std::memory_order_acquire);
+		intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+		if(diff == 0) {
+			if(mEnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				break;
+		}
+		else if(diff < 0) {
+			return false; // Full
+		}
+		else {
+			pos = mEnqueuePos.load(std::memory_order_relaxed);
+		}
+	}
+
+	slot->task = std::move(t);
+	slot->sequence.store(pos + 1, std::memory_order_release);
+	return true;
+}
+
+Task TaskQueue::tryPop() {
+	Slot& slot = mSlots[mDequeuePos & mMask];
+	if(slot.sequence.load(std::memory_order_acquire) != mDequeuePos + 1)
+		return nullptr;
+
+	Task result = std::move(slot.task);
+	slot.sequence.store(mDequeuePos + mMask + 1, std::memory_order_release);
+	++mDequeuePos;
+	return result;
+}
+
+void TaskQueue::add(Task t) {
+	if(!t) return;
+
+	// Once something overflowed everyone has to use the overflow list until it's drained, otherwise
+	// a thread's later task could end up in the ring and overtake its earlier one.
+	if(mHasOverflow.load(std::memory_order_acquire) || !tryPush(t)) {
+		auto l = std::lock_guard<std::mutex>(mOverflowMutex);
+		mOverflow.emplace_back(std::move(t));
+		mHasOverflow.store(true, std::memory_order_release);
+	}
+
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if(!mSignaled.exchange(true) && mWakeup) {
+		mWakeup();
+	}
+}
+
+bool TaskQueue::empty() const noexcept {
+	return
+		mCarried.empty() &&
+		mSlots[mDequeuePos & mMask].sequence.load(std::memory_order_acquire) != mDequeuePos + 1 &&
+		!mHasOverflow.load(std::memory_order_acquire);
+}
+
+size_t TaskQueue::size() {
+	size_t result = mCarried.size() + mEnqueuePos.load(std::memory_order_acquire) - mDequeuePos;
+	if(mHasOverflow.load(std::memory_order_acquire)) {
+		auto l = std::lock_guard<std::mutex>(mOverflowMutex);
+		result += mOverflow.size();
+	}
+	return result;
 }
 
 size_t TaskQueue::executeSingleConsumer() {
+	return executeSingleConsumer(Clock::time_point::max());
+}
+
+size_t TaskQueue::executeSingleConsumer(Clock::time_point deadline) {
+	bool   unbounded = deadline == Clock::time_point::max();
 	size_t n = 0;
-	std::deque<std::function<void()>> tasks;
-	while(!mTasks.empty()) {
-		mMutex.lock();
-		tasks.swap(mTasks);
-		mMutex.unlock();
-		n += tasks.size();
-		for(auto& task : tasks) task();
-		tasks.clear();
+	while(true) {
+		// Carried over from the last call, everything in the ring and overflow list was added after them
+		while(!mCarried.empty()) {
+			Task task = std::move(mCarried.front());
+			mCarried.pop_front();
+			task();
+			++n;
+			if(!unbounded && Clock::now() >= deadline) return n;
+		}
+
+		while(Task task = tryPop()) {
+			task();
+			++n;
+			if(!unbounded && Clock::now() >= deadline) return n;
+		}
+
+		if(mHasOverflow.load(std::memory_order_acquire)) {
+			auto l = std::lock_guard<std::mutex>(mOverflowMutex);
+			// Whatever is in the ring now was added before the overflowing tasks
+			while(Task task = tryPop())
+				mCarried.emplace_back(std::move(task));
+			for(auto& task : mOverflow)
+				mCarried.emplace_back(std::move(task));
+			mOverflow.clear();
+			mHasOverflow.store(false, std::memory_order_release);
+			continue;
+		}
+
+		// Producers which add after this point see mSignaled == false and call the wakeup hook
+		mSignaled.store(false);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if(empty()) break;
 	}
 	return n;
 }
@@ -2,8 +2,49 @@
 
 namespace wwidget {
 
+namespace {
+
+struct CurrentWorker {
+	Threadpool const* pool  = nullptr;
+	size_t            index = 0;
+};
+
+thread_local CurrentWorker tCurrentWorker;
+
+} // namespace
+
+// =============================================================
+// == WorkQueue =============================================
+// =============================================================
+
+void Threadpool::WorkQueue::push(Task&& t) {
+	auto l = std::lock_guard<std::mutex>(mutex);
+	tasks.emplace_back(std::move(t));
+}
+Task Threadpool::WorkQueue::popBack() {
+	auto l = std::lock_guard<std::mutex>(mutex);
+	if(tasks.empty()) return nullptr;
+	Task result = std::move(tasks.back());
+	tasks.pop_back();
+	return result;
+}
+Task Threadpool::WorkQueue::popFront() {
+	auto l = std::lock_guard<std::mutex>(mutex);
+	if(tasks.empty()) return nullptr;
+	Task result = std::move(tasks.front());
+	tasks.pop_front();
+	return result;
+}
+
+// =============================================================
+// == Threadpool =============================================
+// =============================================================
+
 Threadpool::Threadpool() :
-	mRunning(false)
+	mRunning(false),
+	mPending(0),
+	mNextQueue(0),
+	mSleeping(0)
 {}
 Threadpool::Threadpool(size_t size) :
 	Threadpool()
@@ -18,53 +59,135 @@ void Threadpool::start(size_t size) {
 	stop();
 
 	mRunning = true;
+	mQueues.clear();
+	mQueues.reserve(size);
+	while(mQueues.size() < size)
+		mQueues.emplace_back(std::make_unique<WorkQueue>());
+
 	mThreads.reserve(size);
 	while(mThreads.size() < size) {
-		mThreads.emplace_back([this]() {
-			while(auto task = await_pop()) {
-				task();
-			}
+		mThreads.emplace_back([this, index = mThreads.size()]() {
+			workerMain(index);
 		});
 	}
 }
 void Threadpool::stop() {
-	mRunning = false;
+	{
+		auto l = std::lock_guard<std::mutex>(mSleepMutex);
+		mRunning = false;
+	}
 	mWaiting.notify_all();
 	for(auto& thread : mThreads)
 		thread.join();
 	mThreads.clear();
+
+	// Keep tasks which weren't executed for the next start() or try_pop()
+	for(auto& queue : mQueues) {
+		while(Task t = queue->popFront())
+			mInjected.push(std::move(t));
+	}
+	mQueues.clear();
 }
-void Threadpool::add(std::function<void()>&& fn) {
-	auto l = std::lock_guard<std::mutex>(mMutex);
-	mTasks.emplace_back(fn);
-	mWaiting.notify_one();
+
+void Threadpool::workerMain(size_t index) {
+	tCurrentWorker = { this, index };
+	while(Task task = await_pop()) {
+		task();
+	}
+	tCurrentWorker = {};
 }
 
-std::function<void()> Threadpool::await_pop() {
-	auto l = std::unique_lock<std::mutex>(mMutex);
+Threadpool::WorkQueue* Threadpool::ownQueue() const noexcept {
+	if(tCurrentWorker.pool != this) return nullptr;
+	return mQueues[tCurrentWorker.index].get();
+}
 
-	std::function<void()> result;
-	if(mTasks.empty()) {
-		mWaiting.wait(l, [this]() {
-			return !running() || !mTasks.empty();
-		});
+void Threadpool::wakeOne() {
+	if(mSleeping.load() > 0) {
+		{ auto l = std::lock_guard<std::mutex>(mSleepMutex); }
+		mWaiting.notify_one();
+	}
+}
+
+void Threadpool::add(Task&& task) {
+	if(!task) return;
 
-		if(!running()) return nullptr;
+	// Counted before it's visible, so mPending never underflows when it's stolen right away
+	mPending.fetch_add(1);
+
+	if(WorkQueue* own = ownQueue()) {
+		own->push(std::move(task));
+	}
+	else if(mQueues.empty()) {
+		mInjected.push(std::move(task));
+	}
+	else {
+		size_t n = mNextQueue.fetch_add(1, std::memory_order_relaxed);
+		mQueues[n % mQueues.size()]->push(std::move(task));
 	}
 
-	result = mTasks.front();
-	mTasks.pop_front();
+	wakeOne();
+}
+void Threadpool::add(std::function<void()>&& fn) {
+	if(fn) add(Task(std::move(fn)));
+}
+
+Task Threadpool::steal(size_t first) {
+	if(Task t = mInjected.popFront())
+		return t;
 
-	return result;
+	size_t count = mQueues.size();
+	for(size_t i = 0; i < count; i++) {
+		if(Task t = mQueues[(first + i) % count]->popFront())
+			return t;
+	}
+	return nullptr;
 }
-std::function<void()> Threadpool::try_pop() {
-	auto l = std::unique_lock<std::mutex>(mMutex);
-	std::function<void()> result;
-	if(!mTasks.empty()) {
-		result = mTasks.front();
-		mTasks.pop_front();
+
+Task Threadpool::try_pop() {
+	if(mPending.load(std::memory_order_relaxed) == 0) return nullptr;
+
+	Task result;
+	if(WorkQueue* own = ownQueue()) {
+		result = own->popBack();
+		if(!result) result = steal(tCurrentWorker.index + 1);
+	}
+	else {
+		result = steal(mNextQueue.load(std::memory_order_relaxed));
 	}
+
+	if(result) mPending.fetch_sub(1);
 	return result;
 }
 
-} // namespace wwidget
\ No newline at end of file
+Task Threadpool::await_pop() {
+	while(true) {
+		if(Task t = try_pop())
+			return t;
+
+		if(mPending.load() > 0) {
+			// Counted but not yet pushed, or taken by another thief: don't hammer the queues
+			std::this_thread::yield();
+			continue;
+		}
+
+		auto l = std::unique_lock<std::mutex>(mSleepMutex);
+		mSleeping.fetch_add(1);
+		mWaiting.wait(l, [this]() {
+			return !running() || mPending.load() > 0;
+		});
+		mSleeping.fetch_sub(1);
+
+		if(!running() && mPending.load() == 0) return nullptr;
+	}
+}
+
+bool Threadpool::runOne() {
+	if(Task t = try_pop()) {
+		t();
+		return true;
+	}
+	return false;
+}
+
+} // namespace wwidget
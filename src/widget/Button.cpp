@@ -52,12 +52,15 @@ Button* Button::onClick(std::string_view const& command) {
 
 void Button::on(Click const& click) {
 	if(mPressed && click.up() && mOnClick) {
-		defer(mOnClick);
+		defer(TaskPriority::Input, mOnClick);
 	}
 	mPressed = click.down();
 	click.handled = true;
 }
 
+void Button::on(Enter const& e) { requestRedraw(); }
+void Button::on(Leave const& e) { requestRedraw(); }
+
 PreferredSize Button::onCalcPreferredSize(PreferredSize const& constraint) {
 	return calcBoxAroundChildren(5, 5, constraint);
 }
@@ -69,6 +72,12 @@ void Button::onDrawBackground(Canvas& canvas) {
 			.rect({0, 0, width(), height()})
 			.fill();
 	}
+	else if(hovered()) {
+		canvas
+			.fillColor(rgba(255, 255, 255, 0.08))
+			.rect({0, 0, width(), height()})
+			.fill();
+	}
 }
 
 void Button::onDraw(Canvas& canvas) {
@@ -78,14 +87,30 @@ void Button::onDraw(Canvas& canvas) {
 		.stroke();
 }
 
-bool Button::setAttribute(std::string_view name, Attribute const& value) {
-	if(name == "content" || name == "text") {
-		text(value.toString()); return true;
-	}
-	if(name == "onclick") {
-		onClick(value.toString()); return true;
-	}
-	return Widget::setAttribute(name, value);
+shared<Widget> Button::onClone() const {
+	auto copy = make_shared<Button>();
+	cloneAttributes(*copy);
+	return copy;
+}
+void Button::cloneAttributes(Button& to) const {
+	Widget::cloneAttributes(to);
+	// Commands are bound to the button, other callbacks are copied as they are
+	if(auto* exec = mOnClick.target<StringExecutor>())
+		to.onClick(std::string_view(exec->command));
+	else
+		to.mOnClick = mOnClick;
+}
+
+AttributeTable const& Button::classAttributes() noexcept {
+	static constexpr AttributeInfo attributes[] = {
+		{ "content", [](Widget& w, std::string s) { w.text(s); }, nullptr, "$.text(%);" },
+		{ "onclick", [](Widget& w, std::string s) { static_cast<Button&>(w).onClick(std::string_view(s)); }, nullptr, "$.onClick(std::string_view(%));" },
+	};
+	static constexpr AttributeTable table("wwidget::Button", attributes, &Widget::classAttributes);
+	return table;
+}
+AttributeTable const& Button::attributeTable() const noexcept {
+	return classAttributes();
 }
 void Button::getAttributes(AttributeCollectorInterface& collector) {
 	if(collector.startSection("wwidget::Button")) {
@@ -0,0 +1,231 @@
+#include "../../include/wwidget/widget/Form.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <set>
+#include <vector>
+
+namespace wwidget {
+
+// =============================================================
+// == Literals =============================================
+// =============================================================
+
+namespace {
+
+std::string literal(std::string const& s) {
+	std::string result = "\"";
+	for(unsigned char c : s) {
+		switch(c) {
+			case '"':  result += "\\\""; break;
+			case '\\': result += "\\\\"; break;
+			case '\n': result += "\\n"; break;
+			case '\r': result += "\\r"; break;
+			case '\t': result += "\\t"; break;
+			default:
+				if(c < 0x20 || c == 0x7F) {
+					char octal[8];
+					snprintf(octal, sizeof(octal), "\\%03o", c);
+					result += octal;
+				}
+				else {
+					result += (char) c;
+				}
+		}
+	}
+	return result + "\"";
+}
+
+std::string literal(float f) {
+	if(!std::isfinite(f)) throw std::domain_error("Not a finite number");
+	char buffer[32];
+	snprintf(buffer, sizeof(buffer), "%.9g", f);
+	std::string result = buffer;
+	if(result.find_first_of(".e") == std::string::npos) result += ".";
+	return result + "f";
+}
+
+std::string literal(HalfAlignment a) {
+	switch(a) {
+		case AlignNone:   return "AlignNone";
+		case AlignCenter: return "AlignCenter";
+		case AlignMax:    return "AlignMax";
+		case AlignMin:    return "AlignMin";
+		case AlignFill:   return "AlignFill";
+	}
+	return "(HalfAlignment) " + std::to_string((int) a);
+}
+
+std::string literal(Flow f) {
+	switch(f) {
+		case FlowDown:  return "FlowDown";
+		case FlowUp:    return "FlowUp";
+		case FlowRight: return "FlowRight";
+		case FlowLeft:  return "FlowLeft";
+		default:        return "(Flow) " + std::to_string((int) f);
+	}
+}
+
+/// The value as a C++ literal of the type the attribute is set as
+std::string literal(AttributeType type, Attribute const& a) {
+	switch(type) {
+		case AttributeType::Bool:          return a.toBool() ? "true" : "false";
+		case AttributeType::Float:         return literal(a.toFloat());
+		case AttributeType::Int:           return "int64_t(" + std::to_string(a.toInt()) + ")";
+		case AttributeType::String:        return literal(a.toString());
+		case AttributeType::Flow:          return literal(a.toFlow());
+		case AttributeType::HalfAlignment: return literal(a.toHalfAlignment());
+		case AttributeType::Alignment: {
+			Alignment al = a.toAlignment();
+			return "Alignment(" + literal(al.x) + ", " + literal(al.y) + ")";
+		}
+		case AttributeType::Padding: {
+			Padding p = a.toPadding();
+			return "Padding(" + literal(p.left) + ", " + literal(p.top) + ", " + literal(p.right) + ", " + literal(p.bottom) + ")";
+		}
+		case AttributeType::Point: {
+			Point p = a.toPoint();
+			return "Point(" + literal(p.x) + ", " + literal(p.y) + ")";
+		}
+		case AttributeType::Offset: {
+			Offset o = a.toOffset();
+			return "Offset(" + literal(o.x) + ", " + literal(o.y) + ")";
+		}
+		case AttributeType::Size: {
+			Size s = a.toSize();
+			return "Size(" + literal(s.x) + ", " + literal(s.y) + ")";
+		}
+		case AttributeType::Rect: {
+			Rect r = a.toRect();
+			return "Rect::absolute(" + literal(r.min.x) + ", " + literal(r.min.y) + ", " + literal(r.max.x) + ", " + literal(r.max.y) + ")";
+		}
+		case AttributeType::Color: {
+			Color c = a.toColor();
+			return "Color(" + literal(c.r) + ", " + literal(c.g) + ", " + literal(c.b) + ", " + literal(c.a) + ")";
+		}
+	}
+	throw std::domain_error("Unknown attribute type");
+}
+
+// =============================================================
+// == Classes =============================================
+// =============================================================
+
+/// The header declaring a default widget, e.g. wwidget::Text is in wwidget/widget/Text.hpp. Empty for other classes.
+std::string header(std::string const& type) {
+	constexpr std::string_view Namespace = "wwidget::";
+	if(type.compare(0, Namespace.size(), Namespace) != 0) return {};
+	std::string name = type.substr(Namespace.size());
+	if(name.empty() || name.find_first_of(":<") != std::string::npos) return {};
+	if(name == "Widget" || name == "Window") return "wwidget/" + name + ".hpp";
+	return "wwidget/widget/" + name + ".hpp";
+}
+
+/// Replaces $ with the widget and % with the value
+std::string expand(const char* code, std::string const& widget, std::string const& value) {
+	std::string result;
+	for(const char* c = code; *c; c++) {
+		if(*c == '$')      result += widget;
+		else if(*c == '%') result += value;
+		else               result += *c;
+	}
+	return result;
+}
+
+} // namespace
+
+// =============================================================
+// == Generator =============================================
+// =============================================================
+
+class Form::CodeGenerator final : public Form::ParseListener {
+	/// An element whose code isn't complete yet
+	struct Element {
+		std::string           variable;
+		std::string           type;
+		AttributeTable const* attributes;
+		std::string           body; //!< Attributes and children, indented by one level more than the element
+	};
+
+	std::vector<Element>  mStack;
+	std::set<std::string> mHeaders;
+	size_t                mVariables = 0;
+
+	std::string indent() const { return std::string(mStack.size(), '\t'); }
+
+public:
+	CodeGenerator() {
+		mStack.push_back({ "form", "wwidget::Form", &Form::classAttributes(), {} });
+		mHeaders.insert("wwidget/widget/Form.hpp");
+	}
+
+	bool attribute(Widget& to, std::string_view name, std::string_view value) override {
+		// The widget is still built, later attributes can depend on earlier ones and unknown attributes are reported like in parse()
+		bool success = to.setAttribute(name, StringAttribute(value));
+		if(!success) return false;
+
+		auto& element = mStack.back();
+		std::string code;
+		AttributeInfo const* info = element.attributes->find(name);
+		if(info && info->code()) {
+			try {
+				code = expand(info->code(), element.variable, literal(info->type(), StringAttribute(value)));
+			}
+			catch(std::exception&) {
+				// The value doesn't parse, but the widget accepted it anyway: leave it to the widget at runtime
+			}
+		}
+		if(code.empty()) {
+			code = element.variable + ".setAttribute(" + literal(std::string(name)) + ", StringAttribute(" + literal(std::string(value)) + "));";
+		}
+		element.body += indent() + code + "\n";
+		return true;
+	}
+	void begin(std::string_view element, Widget& created) override {
+		std::string type    = Form::typeName(typeid(created));
+		std::string include = header(type);
+		if(include.empty()) throw exceptions::ParsingError("No code can be generated for '" + std::string(element) + "' (" + type + "), only for the default widgets");
+		mHeaders.insert(include);
+		mStack.push_back({ "w" + std::to_string(++mVariables), type, &created.attributeTable(), {} });
+	}
+	void end() override {
+		Element element = std::move(mStack.back());
+		mStack.pop_back();
+
+		auto& parent = mStack.back();
+		std::string add = parent.variable + ".add<" + element.type + ">()";
+		if(element.body.empty()) {
+			parent.body += indent() + add + ";\n";
+		}
+		else {
+			parent.body += indent() + "{\n";
+			parent.body += indent() + "\tauto& " + element.variable + " = *" + add + ";\n";
+			parent.body += element.body;
+			parent.body += indent() + "}\n";
+		}
+	}
+
+	std::string generate(std::string const& function) const {
+		std::string result = "// Generated by Form::generateCpp(), do not edit\n";
+		for(auto& header : mHeaders) result += "#include <" + header + ">\n";
+		result += "\n";
+		result += "wwidget::Form& " + function + "(wwidget::Form& form) {\n";
+		result += "\tusing namespace wwidget;\n";
+		result += mStack.front().body;
+		result += "\treturn form;\n";
+		result += "}\n";
+		return result;
+	}
+};
+
+std::string Form::generateCpp(const char* text, std::string const& function) {
+	auto scratch = make_shared<Form>();
+	scratch->mFactories = mFactories;
+	if(!scratch->hasFactories()) scratch->addDefaultFactories();
+
+	CodeGenerator generator;
+	scratch->parse(text, &generator);
+	return generator.generate(function);
+}
+
+} // namespace wwidget
@@ -0,0 +1,393 @@
+#include "../../include/wwidget/widget/Form.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+namespace wwidget {
+
+// =============================================================
+// == Format =============================================
+// =============================================================
+
+// A compiled form is a pool of strings, a table of factory names and a stream of operations, in the byte order of the machine:
+//  Header | String[stringCount] | char[stringBytes] | uint32_t factory name[factoryCount] | uint8_t operations[opBytes]
+// The operations begin at the form itself: Begin adds a child created by a factory and continues with it, End returns to its parent.
+// Every operation starts with a byte holding its OpCode in the low bits, and for attributes the ValueType above them:
+//  Begin:     head | varint factory index
+//  Attribute: head | varint name string index | varint text string index | value, sized by the ValueType
+//  End:       head
+
+namespace {
+
+constexpr char     Magic[4] = { 'W', 'W', 'F', 'C' };
+constexpr uint32_t Version  = 2;
+
+struct Header {
+	char     magic[4];
+	uint32_t version;
+	uint32_t stringCount, stringBytes;
+	uint32_t factoryCount;
+	uint32_t opBytes;
+};
+
+struct String {
+	uint32_t offset, length;
+};
+
+enum OpCode : uint8_t {
+	OpBegin,
+	OpAttribute,
+	OpEnd,
+};
+constexpr unsigned OpCodeBits = 2;
+
+/// The type an attribute was read as when it was compiled
+enum ValueType : uint8_t {
+	ValueText, //!< Not read, or as a string: only the text is stored
+	ValueColor,
+	ValuePoint, //!< Point, Size and Offset
+	ValueRect,
+	ValueAlignment,
+	ValueHalfAlignment,
+	ValuePadding,
+	ValueFlow,
+	ValueFloat,
+	ValueBool,
+	ValueInt,
+};
+
+/// An attribute value as it was parsed when compiling
+struct Value {
+	ValueType type = ValueText;
+	float     f[4] = {};  //!< Color, Point, Rect, Padding, Float
+	int64_t   i    = 0;   //!< Alignment, HalfAlignment, Flow, Bool, Int
+};
+
+/// Number of floats and of integer bytes stored for a ValueType
+struct ValueSize { unsigned floats, bytes; };
+ValueSize valueSize(ValueType type) noexcept {
+	switch(type) {
+		case ValueColor:         return { 4, 0 };
+		case ValuePoint:         return { 2, 0 };
+		case ValueRect:          return { 4, 0 };
+		case ValueAlignment:     return { 0, 2 };
+		case ValueHalfAlignment: return { 0, 1 };
+		case ValuePadding:       return { 4, 0 };
+		case ValueFlow:          return { 0, 1 };
+		case ValueFloat:         return { 1, 0 };
+		case ValueBool:          return { 0, 1 };
+		case ValueInt:           return { 0, 8 };
+		default:                 return { 0, 0 };
+	}
+}
+
+void writeVarint(std::string& to, uint32_t v) {
+	for(; v >= 0x80; v >>= 7) to.push_back((char)(v | 0x80));
+	to.push_back((char) v);
+}
+
+void writeValue(std::string& to, Value const& value) {
+	ValueSize size = valueSize(value.type);
+	to.append((const char*) value.f, size.floats * sizeof(float));
+	for(unsigned b = 0; b < size.bytes; b++) to.push_back((char)((uint64_t) value.i >> (b * 8)));
+}
+
+/// Reads the operation stream, every read past its end throws
+struct OpReader {
+	const uint8_t* at;
+	const uint8_t* end;
+
+	bool done() const noexcept { return at == end; }
+
+	void need(size_t n) const {
+		if((size_t)(end - at) < n) throw exceptions::ParsingError("Corrupt compiled form: truncated operation");
+	}
+	uint8_t byte() {
+		need(1);
+		return *at++;
+	}
+	uint32_t varint() {
+		uint32_t result = 0;
+		for(unsigned shift = 0; shift < 35; shift += 7) {
+			uint8_t b = byte();
+			result |= (uint32_t)(b & 0x7F) << shift;
+			if(!(b & 0x80)) return result;
+		}
+		throw exceptions::ParsingError("Corrupt compiled form: invalid number");
+	}
+	Value value(ValueType type) {
+		Value result;
+		result.type = type;
+		ValueSize size = valueSize(type);
+		need(size.floats * sizeof(float) + size.bytes);
+		memcpy(result.f, at, size.floats * sizeof(float));
+		at += size.floats * sizeof(float);
+		uint64_t i = 0;
+		for(unsigned b = 0; b < size.bytes; b++) i |= (uint64_t) *at++ << (b * 8);
+		result.i = (int64_t) i;
+		return result;
+	}
+};
+
+/// Reads an attribute which was parsed when the form was compiled
+struct CompiledAttribute final : public Attribute {
+	Value const&     value;
+	std::string_view text;
+
+	CompiledAttribute(Value const& value, std::string_view text) : value(value), text(text) {}
+
+	template<class T>
+	T parsed(T (Attribute::*to)() const) const {
+		return (StringAttribute(text).*to)();
+	}
+
+	Color         toColor() const override         { return value.type == ValueColor ? Color(value.f[0], value.f[1], value.f[2], value.f[3]) : parsed(&Attribute::toColor); }
+	Point         toPoint() const override         { return value.type == ValuePoint ? Point(value.f[0], value.f[1]) : parsed(&Attribute::toPoint); }
+	Offset        toOffset() const override        { return value.type == ValuePoint ? Offset(value.f[0], value.f[1]) : parsed(&Attribute::toOffset); }
+	Size          toSize() const override          { return value.type == ValuePoint ? Size(value.f[0], value.f[1]) : parsed(&Attribute::toSize); }
+	Rect          toRect() const override          { return value.type == ValueRect ? Rect::absolute(value.f[0], value.f[1], value.f[2], value.f[3]) : parsed(&Attribute::toRect); }
+	Alignment     toAlignment() const override     { return value.type == ValueAlignment ? Alignment((HalfAlignment)(value.i & 0xFF), (HalfAlignment)(value.i >> 8)) : parsed(&Attribute::toAlignment); }
+	HalfAlignment toHalfAlignment() const override { return value.type == ValueHalfAlignment ? (HalfAlignment) value.i : parsed(&Attribute::toHalfAlignment); }
+	Padding       toPadding() const override       { return value.type == ValuePadding ? Padding(value.f[0], value.f[1], value.f[2], value.f[3]) : parsed(&Attribute::toPadding); }
+	Flow          toFlow() const override          { return value.type == ValueFlow ? (Flow) value.i : parsed(&Attribute::toFlow); }
+
+	std::string toString() const override { return std::string(text); }
+	float       toFloat() const override  { return value.type == ValueFloat ? value.f[0] : parsed(&Attribute::toFloat); }
+	bool        toBool() const override   { return value.type == ValueBool ? value.i != 0 : parsed(&Attribute::toBool); }
+	int64_t     toInt() const override    { return value.type == ValueInt ? value.i : parsed(&Attribute::toInt); }
+};
+
+/// Parses like a StringAttribute, and stores the first value which is read
+struct RecordingAttribute final : public StringAttribute {
+	Value& value;
+
+	RecordingAttribute(std::string_view s, Value& value) : StringAttribute(s), value(value) {}
+
+	template<class T>
+	T record(ValueType type, T v) const {
+		if(value.type == ValueText) value.type = type;
+		return v;
+	}
+
+	Color toColor() const override {
+		Color c = StringAttribute::toColor();
+		if(value.type == ValueText) { value.f[0] = c.r; value.f[1] = c.g; value.f[2] = c.b; value.f[3] = c.a; }
+		return record(ValueColor, c);
+	}
+	Point toPoint() const override {
+		Point p = StringAttribute::toPoint();
+		if(value.type == ValueText) { value.f[0] = p.x; value.f[1] = p.y; }
+		return record(ValuePoint, p);
+	}
+	Offset toOffset() const override { return (Offset) toPoint(); }
+	Size   toSize() const override   { return (Size) toPoint(); }
+	Rect toRect() const override {
+		Rect r = StringAttribute::toRect();
+		if(value.type == ValueText) { value.f[0] = r.min.x; value.f[1] = r.min.y; value.f[2] = r.max.x; value.f[3] = r.max.y; }
+		return record(ValueRect, r);
+	}
+	Alignment toAlignment() const override {
+		Alignment a = StringAttribute::toAlignment();
+		if(value.type == ValueText) value.i = a.x | (a.y << 8);
+		return record(ValueAlignment, a);
+	}
+	HalfAlignment toHalfAlignment() const override {
+		HalfAlignment a = StringAttribute::toHalfAlignment();
+		if(value.type == ValueText) value.i = a;
+		return record(ValueHalfAlignment, a);
+	}
+	Padding toPadding() const override {
+		Padding p = StringAttribute::toPadding();
+		if(value.type == ValueText) { value.f[0] = p.left; value.f[1] = p.top; value.f[2] = p.right; value.f[3] = p.bottom; }
+		return record(ValuePadding, p);
+	}
+	Flow toFlow() const override {
+		Flow f = StringAttribute::toFlow();
+		if(value.type == ValueText) value.i = f;
+		return record(ValueFlow, f);
+	}
+
+	float toFloat() const override {
+		float f = StringAttribute::toFloat();
+		if(value.type == ValueText) value.f[0] = f;
+		return record(ValueFloat, f);
+	}
+	bool toBool() const override {
+		bool b = StringAttribute::toBool();
+		if(value.type == ValueText) value.i = b;
+		return record(ValueBool, b);
+	}
+	int64_t toInt() const override {
+		int64_t i = StringAttribute::toInt();
+		if(value.type == ValueText) value.i = i;
+		return record(ValueInt, i);
+	}
+};
+
+} // namespace
+
+// =============================================================
+// == Compiler =============================================
+// =============================================================
+
+class Form::Compiler final : public Form::ParseListener {
+	std::vector<String>                       mStrings;
+	std::string                               mStringBytes;
+	std::unordered_map<std::string, uint32_t> mStringIndex;
+	std::vector<uint32_t>                     mFactories; //!< String indices
+	std::unordered_map<uint32_t, uint32_t>    mFactoryIndex;
+	std::string                               mOps;
+
+	uint32_t string(std::string_view s) {
+		auto [iter, inserted] = mStringIndex.emplace(std::string(s), (uint32_t) mStrings.size());
+		if(inserted) {
+			mStrings.push_back({ (uint32_t) mStringBytes.size(), (uint32_t) s.size() });
+			mStringBytes.append(s);
+		}
+		return iter->second;
+	}
+public:
+	bool attribute(Widget& to, std::string_view name, std::string_view text) override {
+		Value value;
+		bool success = to.setAttribute(name, RecordingAttribute(text, value));
+		mOps.push_back((char)(OpAttribute | value.type << OpCodeBits));
+		writeVarint(mOps, string(name));
+		writeVarint(mOps, string(text));
+		writeValue(mOps, value);
+		return success;
+	}
+	void begin(std::string_view element, Widget&) override {
+		uint32_t name = string(element);
+		auto [iter, inserted] = mFactoryIndex.emplace(name, (uint32_t) mFactories.size());
+		if(inserted) mFactories.push_back(name);
+
+		mOps.push_back((char) OpBegin);
+		writeVarint(mOps, iter->second);
+	}
+	void end() override {
+		mOps.push_back((char) OpEnd);
+	}
+
+	std::string serialize() const {
+		Header header;
+		memcpy(header.magic, Magic, sizeof(Magic));
+		header.version      = Version;
+		header.stringCount  = mStrings.size();
+		header.stringBytes  = mStringBytes.size();
+		header.factoryCount = mFactories.size();
+		header.opBytes      = mOps.size();
+
+		std::string result;
+		result.append((const char*) &header, sizeof(header));
+		result.append((const char*) mStrings.data(), mStrings.size() * sizeof(String));
+		result.append(mStringBytes);
+		result.append((const char*) mFactories.data(), mFactories.size() * sizeof(uint32_t));
+		result.append(mOps);
+		return result;
+	}
+};
+
+std::string Form::compile(const char* text) {
+	auto scratch = make_shared<Form>();
+	scratch->mFactories = mFactories;
+	if(!scratch->hasFactories()) scratch->addDefaultFactories();
+
+	Compiler compiler;
+	scratch->parse(text, &compiler);
+	return compiler.serialize();
+}
+
+// =============================================================
+// == Loading =============================================
+// =============================================================
+
+Form& Form::loadCompiled(std::string const& path) {
+	std::ifstream file(path, std::ios::binary);
+	if(!file) throw exceptions::FailedLoadingFile(path);
+	std::string data { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+	try {
+		return parseCompiled(data.data(), data.size());
+	}
+	catch(exceptions::ParsingError& e) {
+		e.setFile(path);
+		throw;
+	}
+}
+
+Form& Form::parseCompiled(const void* data, size_t size) {
+	if(!hasFactories()) addDefaultFactories();
+
+	auto const* bytes = (const char*) data;
+	Header header;
+	if(size < sizeof(Header)) throw exceptions::ParsingError("Not a compiled form: too short");
+	memcpy(&header, bytes, sizeof(Header));
+	if(memcmp(header.magic, Magic, sizeof(Magic)) != 0) throw exceptions::ParsingError("Not a compiled form");
+	if(header.version != Version) throw exceptions::ParsingError("Unsupported compiled form version " + std::to_string(header.version));
+
+	size_t stringsAt   = sizeof(Header);
+	size_t bytesAt     = stringsAt + header.stringCount * sizeof(String);
+	size_t factoriesAt = bytesAt + header.stringBytes;
+	size_t opsAt       = factoriesAt + header.factoryCount * sizeof(uint32_t);
+	if(opsAt + (size_t) header.opBytes != size) throw exceptions::ParsingError("Corrupt compiled form: wrong size");
+
+	// The buffer might not be aligned, copy the tables
+	std::vector<String>   strings(header.stringCount);
+	std::vector<uint32_t> factoryNames(header.factoryCount);
+	memcpy(strings.data(), bytes + stringsAt, strings.size() * sizeof(String));
+	memcpy(factoryNames.data(), bytes + factoriesAt, factoryNames.size() * sizeof(uint32_t));
+
+	auto string = [&](uint32_t index) -> std::string_view {
+		if(index >= strings.size() || strings[index].offset + (size_t) strings[index].length > header.stringBytes)
+			throw exceptions::ParsingError("Corrupt compiled form: invalid string");
+		return std::string_view(bytes + bytesAt + strings[index].offset, strings[index].length);
+	};
+
+	// Every factory is looked up once
+	std::vector<FactoryFn const*> factories(header.factoryCount);
+	for(size_t i = 0; i < factories.size(); i++) {
+		auto name = string(factoryNames[i]);
+		factories[i] = mFactories->find(name);
+		if(!factories[i] || !*factories[i])
+			throw exceptions::ParsingError("Unknown element type " + std::string(name));
+	}
+
+	std::vector<Widget*> stack = { this };
+	OpReader ops { (const uint8_t*) bytes + opsAt, (const uint8_t*) bytes + size };
+	while(!ops.done()) {
+		uint8_t head = ops.byte();
+		switch(head & ((1 << OpCodeBits) - 1)) {
+			case OpBegin: {
+				uint32_t factory = ops.varint();
+				if(factory >= factories.size()) throw exceptions::ParsingError("Corrupt compiled form: invalid factory");
+				auto w = create(*factories[factory]);
+				Widget* child = w.get();
+				stack.back()->add(std::move(w));
+				stack.push_back(child);
+			} break;
+			case OpAttribute: {
+				auto name = string(ops.varint());
+				auto text = string(ops.varint());
+				auto type = (ValueType)(head >> OpCodeBits);
+				if(type > ValueInt) throw exceptions::ParsingError("Corrupt compiled form: invalid value type");
+				Value value = ops.value(type);
+				if(!stack.back()->setAttribute(name, CompiledAttribute(value, text))) {
+					std::cerr << "Unknown attribute '" << name << "'" << std::endl;
+				}
+			} break;
+			case OpEnd: {
+				if(stack.size() <= 1) throw exceptions::ParsingError("Corrupt compiled form: unbalanced end");
+				stack.pop_back();
+			} break;
+			default: throw exceptions::ParsingError("Corrupt compiled form: invalid operation");
+		}
+	}
+	if(stack.size() > 1) throw exceptions::ParsingError("Corrupt compiled form: unclosed element");
+
+	return *this;
+}
+
+} // namespace wwidget
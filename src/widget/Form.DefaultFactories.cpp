@@ -3,6 +3,7 @@
 #include "../../include/wwidget/widget/Button.hpp"
 #include "../../include/wwidget/widget/Text.hpp"
 #include "../../include/wwidget/widget/TextField.hpp"
+#include "../../include/wwidget/widget/TextView.hpp"
 #include "../../include/wwidget/widget/Image.hpp"
 
 #include "../../include/wwidget/widget/List.hpp"
@@ -22,6 +23,21 @@
 namespace wwidget {
 
 Form& Form::addDefaultFactories() {
+	// Forms without factories of their own share the defaults, so forms loaded from the same file can share prototypes
+	if(!hasFactories()) {
+		static const shared<FormFactories> defaults = []() {
+			Form form;
+			form.registerDefaultFactories();
+			return form.mFactories;
+		}();
+		mFactories = defaults;
+		return *this;
+	}
+	registerDefaultFactories();
+	return *this;
+}
+
+void Form::registerDefaultFactories() {
 	factory<Widget>();
 	factory<Widget>("widget");
 
@@ -50,6 +66,9 @@ Form& Form::addDefaultFactories() {
 	factory<TextField>();
 	factory<TextField>("textfield");
 
+	factory<TextView>();
+	factory<TextView>("textview");
+
 	factory<FileBrowser>();
 	factory<FileBrowser>("filebrowser");
 
@@ -58,22 +77,14 @@ Form& Form::addDefaultFactories() {
 	factory<Window>("window");
 #endif // ifndef WWIDGET_NO_WINDOWS
 
-	// Do not misread
-	auto createChildForm = [this]() -> shared<Widget> {
-		auto p = make_shared<Form>();
-		p->mFactories = this->mFactories;
-		return p;
-	};
-
-	factory("wwidget::Form", createChildForm);
-	factory("form", createChildForm);
+	// Nested forms get the factories of the form they are created by, see Form::create
+	factory<Form>();
+	factory<Form>("form");
 
 	// std::cout << "Registered factories:" << std::endl;
 	// for(auto& pair : mFactories) {
 	// 	std::cout << "\t" << pair.first << std::endl;
 	// }
-
-	return *this;
 }
 
 } // namespace wwidget
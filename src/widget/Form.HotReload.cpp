@@ -0,0 +1,364 @@
+#include "../../include/wwidget/widget/Form.hpp"
+
+#include "../../include/wwidget/Context.hpp"
+#include "../../include/wwidget/async/FileWatcher.hpp"
+
+#include "../thirdparty/rapidxml/rapidxml.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <vector>
+
+namespace wwidget {
+
+// =============================================================
+// == Source =============================================
+// =============================================================
+
+/// An element of a form file
+struct Form::SourceElement {
+	std::string_view                                 type; //!< Points into the text, only valid while it's parsed
+	std::string                                      typeName;
+	std::vector<std::pair<std::string, std::string>> attributes; //!< Text in the element is a 'content' attribute, like in parse()
+	std::vector<SourceElement>                       children;
+	weak<Widget>                                     widget; //!< Created for it, owned by its parent, which might have removed it since
+
+	std::string const* attribute(std::string_view name) const noexcept {
+		for(auto iter = attributes.rbegin(); iter != attributes.rend(); ++iter)
+			if(iter->first == name) return &iter->second;
+		return nullptr;
+	}
+
+	/// Elements of the same type and name are the same element
+	bool same(SourceElement const& other) const noexcept {
+		if(typeName != other.typeName) return false;
+		auto* a = attribute("name");
+		auto* b = other.attribute("name");
+		return a == b || (a && b && *a == *b);
+	}
+	/// Whether other can't be applied to the widget of this by setting attributes
+	bool needsReplacing(SourceElement const& other) const noexcept {
+		for(auto& [name, value] : attributes)
+			if(!other.attribute(name)) return true;
+		// Forms load their file again when it's set, on top of what they loaded
+		if(dynamic_cast<Form*>(widget.lock().get()))
+			for(const char* name : { "src", "source" })
+				if(auto* a = attribute(name); a && *a != *other.attribute(name)) return true;
+		return false;
+	}
+};
+
+shared<Form::SourceElement> Form::readSource(const char* text) {
+	using namespace rapidxml;
+	constexpr int options = parse_comment_nodes | parse_non_destructive | parse_fastest;
+
+	xml_document<> doc;
+	try {
+		doc.parse<options>(const_cast<char*>(text)); // We use the non-destructive mode, const_cast is safe
+	}
+	catch(rapidxml::parse_error const& e) {
+		throw exceptions::ParsingError(e.what(), e.where<char>(), text);
+	}
+
+	auto readRecursive = [](auto& readRecursive, SourceElement& to, xml_node<>* to_data) -> void {
+		to.type     = std::string_view(to_data->name(), to_data->name_size());
+		to.typeName = to.type;
+		for(xml_attribute<>* attrib = to_data->first_attribute(); attrib; attrib = attrib->next_attribute()) {
+			to.attributes.emplace_back(
+				std::string(attrib->name(), attrib->name_size()),
+				std::string(attrib->value(), attrib->value_size()));
+		}
+		for(xml_node<>* data = to_data->first_node(); data; data = data->next_sibling()) {
+			switch(data->type()) {
+			case rapidxml::node_element:
+				readRecursive(readRecursive, to.children.emplace_back(), data);
+				continue;
+			case rapidxml::node_cdata:
+			case rapidxml::node_data:
+				to.attributes.emplace_back("content", std::string(data->value(), data->value_size()));
+				continue;
+			default: continue;
+			}
+		}
+	};
+
+	xml_node<>* form_data = doc.first_node("form");
+	if(!form_data) {
+		throw exceptions::ParsingError("Expected a '<form>' element at root level");
+	}
+	auto result = make_shared<SourceElement>();
+	readRecursive(readRecursive, *result, form_data);
+	return result;
+}
+
+void Form::checkSource(SourceElement const& element, const char* text) const {
+	for(auto& child : element.children) {
+		FactoryFn const* factory = mFactories ? mFactories->find(child.type) : nullptr;
+		if(!factory || !*factory) {
+			throw exceptions::ParsingError("Unknown element type " + child.typeName, child.type.data(), text);
+		}
+		checkSource(child, text);
+	}
+}
+
+shared<Widget> Form::create(SourceElement& element, const char* text) {
+	auto w = create(*mFactories->find(element.type));
+	// Forms loaded by 'src' are watched as well
+	if(auto* form = dynamic_cast<Form*>(w.get()); form && mWatching) form->watch(true);
+	element.widget = w;
+	return w;
+}
+
+void Form::build(Widget& widget, SourceElement& element, const char* text) {
+	for(auto& [name, value] : element.attributes) {
+		if(!widget.setAttribute(name, StringAttribute(value))) {
+			std::cerr << "Unknown attribute '" << name << "' for '" << element.typeName << "'" << std::endl;
+		}
+	}
+	for(auto& child : element.children) {
+		auto w = create(child, text);
+		widget.add(w);
+		build(*w, child, text);
+	}
+}
+
+void Form::loadSource(std::string const& path) {
+	std::ifstream file(path, std::ios::binary);
+	if(!file) throw exceptions::FailedLoadingFile(path);
+	std::string text { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+	shared<SourceElement> source;
+	try {
+		source = readSource(text.c_str());
+		checkSource(*source, text.c_str());
+	}
+	catch(exceptions::ParsingError& e) {
+		e.setFile(path);
+		throw;
+	}
+
+	if(path != mPath) {
+		bool watching = mWatching;
+		watch(false);
+		mPath = path;
+		watch(watching);
+	}
+
+	build(*this, *source, text.c_str());
+	mSource = std::move(source);
+}
+
+// =============================================================
+// == Diffing =============================================
+// =============================================================
+
+void Form::patch(Widget& widget, SourceElement& from, SourceElement& to, const char* text) {
+	to.widget = from.widget;
+
+	for(auto& [name, value] : to.attributes) {
+		auto* old = from.attribute(name);
+		if(old && *old == value) continue;
+		if(!widget.setAttribute(name, StringAttribute(value))) {
+			std::cerr << "Unknown attribute '" << name << "' for '" << to.typeName << "'" << std::endl;
+		}
+	}
+
+	// Widgets removed or moved elsewhere since they were created are forgotten, their elements are built anew
+	auto& olds = from.children;
+	olds.erase(std::remove_if(olds.begin(), olds.end(), [&](SourceElement const& old) {
+		auto w = old.widget.lock();
+		return !w || w->parent().get() != &widget;
+	}), olds.end());
+
+	auto&          news = to.children;
+	size_t         o    = 0;
+	shared<Widget> last; // The widget of the last element of news handled
+
+	auto insert = [&](SourceElement& element) {
+		auto w = create(element, text);
+		if(last)                 last->insertNextSibling(w);
+		else if(o < olds.size()) olds[o].widget.lock()->insertPrevSibling(w);
+		else                     widget.add(w);
+		build(*w, element, text);
+	};
+	auto neededLater = [&](SourceElement const& old, size_t n) {
+		for(size_t i = n + 1; i < news.size(); i++)
+			if(old.same(news[i])) return true;
+		return false;
+	};
+
+	for(size_t n = 0; n < news.size(); n++) {
+		auto& element = news[n];
+		while(true) {
+			if(o < olds.size() && olds[o].same(element)) {
+				auto w = olds[o].widget.lock();
+				if(olds[o].needsReplacing(element)) {
+					insert(element);
+					w->remove();
+				}
+				else {
+					patch(*w, olds[o], element, text);
+				}
+				o++;
+				break;
+			}
+			// Named elements are looked for further on, the ones before were removed
+			if(o < olds.size() && element.attribute("name")) {
+				size_t found = o + 1;
+				while(found < olds.size() && !olds[found].same(element)) found++;
+				if(found < olds.size()) {
+					for(; o < found; o++) olds[o].widget.lock()->remove();
+					continue;
+				}
+			}
+			if(o == olds.size() || neededLater(olds[o], n)) {
+				insert(element);
+				break;
+			}
+			olds[o++].widget.lock()->remove();
+		}
+		last = element.widget.lock();
+	}
+	for(; o < olds.size(); o++) olds[o].widget.lock()->remove();
+}
+
+Form& Form::reload() {
+	if(mPath.empty()) throw exceptions::InvalidOperation("Form::reload(): Nothing was loaded from a file");
+
+	std::ifstream file(mPath, std::ios::binary);
+	if(!file) throw exceptions::FailedLoadingFile(mPath);
+	std::string text { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+	shared<SourceElement> source;
+	try {
+		source = readSource(text.c_str());
+		checkSource(*source, text.c_str());
+	}
+	catch(exceptions::ParsingError& e) {
+		e.setFile(mPath);
+		throw;
+	}
+
+	if(mSource) {
+		patch(*this, *mSource, *source, text.c_str());
+		mSource = std::move(source);
+	}
+	else {
+		// It's unknown which widgets were loaded from the file
+		clearChildren();
+		loadSource(mPath);
+	}
+
+	if(onReloaded) onReloaded();
+	return *this;
+}
+
+// =============================================================
+// == Watching =============================================
+// =============================================================
+
+namespace {
+
+/// The forms watching their files, the reloads are deferred to their contexts
+class Watches {
+	struct Watch {
+		std::string path;
+		Context*    context;
+		bool        pending = false; //!< A reload was deferred
+	};
+
+	std::mutex                      mMutex;
+	std::unordered_map<Form*, Watch> mForms;
+	FileWatcher                     mWatcher; // Last, its thread calls changed()
+
+	void changed(std::string const& path) {
+		std::lock_guard<std::mutex> lock(mMutex);
+		std::vector<Context*> contexts;
+		for(auto& [form, watch] : mForms) {
+			if(watch.path != path || !watch.context || watch.pending) continue;
+			watch.pending = true;
+			if(std::find(contexts.begin(), contexts.end(), watch.context) == contexts.end())
+				contexts.push_back(watch.context);
+		}
+		for(Context* context : contexts)
+			context->defer(TaskPriority::Layout, [this, path]() { reload(path); });
+	}
+
+	void reload(std::string const& path) {
+		std::vector<Form*> forms;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			for(auto& [form, watch] : mForms) {
+				if(watch.path == path && watch.pending) {
+					watch.pending = false;
+					forms.push_back(form);
+				}
+			}
+		}
+		for(Form* form : forms) {
+			{
+				// Reloading one form can remove others
+				std::lock_guard<std::mutex> lock(mMutex);
+				if(!mForms.count(form)) continue;
+			}
+			try {
+				form->reload();
+			}
+			catch(std::exception& e) {
+				std::cerr << "Failed reloading " << path << ": " << e.what() << std::endl;
+			}
+		}
+	}
+
+public:
+	Watches() : mWatcher([this](std::string const& path) { changed(path); }) {}
+
+	void add(Form* form, std::string const& path, Context* context) {
+		mWatcher.add(path);
+		std::lock_guard<std::mutex> lock(mMutex);
+		mForms[form] = { path, context };
+	}
+	void remove(Form* form) {
+		std::unique_lock<std::mutex> lock(mMutex);
+		auto iter = mForms.find(form);
+		if(iter == mForms.end()) return;
+		std::string path = std::move(iter->second.path);
+		mForms.erase(iter);
+		lock.unlock();
+		mWatcher.remove(path);
+	}
+	void context(Form* form, Context* context) {
+		std::lock_guard<std::mutex> lock(mMutex);
+		if(auto iter = mForms.find(form); iter != mForms.end())
+			iter->second.context = context;
+	}
+};
+
+Watches& watches() {
+	static Watches result;
+	return result;
+}
+
+} // namespace
+
+Form& Form::watch(bool b) {
+	if(mWatching && !mPath.empty()) watches().remove(this);
+	mWatching = b;
+	if(mWatching && !mPath.empty()) watches().add(this, mPath, context());
+	if(!mWatching) mSource.reset();
+	return *this;
+}
+
+void Form::onContextChanged() {
+	Widget::onContextChanged();
+	if(mWatching && !mPath.empty()) watches().context(this, context());
+}
+
+Form::~Form() noexcept {
+	if(mWatching && !mPath.empty()) watches().remove(this);
+}
+
+} // namespace wwidget
@@ -0,0 +1,148 @@
+#include "../../include/wwidget/widget/Form.hpp"
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <vector>
+
+namespace wwidget {
+
+// =============================================================
+// == Prototype =============================================
+// =============================================================
+
+/// A file parsed by load(), which is cloned instead of parsed again
+struct Form::Prototype {
+	shared<FormFactories>           factories;
+	std::filesystem::file_time_type modified;
+
+	std::string                                      text; //!< The file, parsed when the prototype can't be cloned
+	shared<Form>                                     form;
+	std::vector<std::pair<std::string, std::string>> attributes; //!< Of the <form> element, which are set on the form which is loaded
+	std::atomic<bool>                                cloneable { true };
+
+	/// Every prototype by path
+	struct Cache {
+		std::mutex                                         mutex;
+		std::unordered_map<std::string, shared<Prototype>> byPath;
+	};
+	static Cache& cache() {
+		static Cache result;
+		return result;
+	}
+};
+
+/// Parses like parse(), and records the attributes of the <form> element
+class Form::PrototypeRecorder final : public Form::ParseListener {
+	Form&      mRoot;
+	Prototype& mPrototype;
+public:
+	PrototypeRecorder(Form& root, Prototype& prototype) : mRoot(root), mPrototype(prototype) {}
+
+	bool attribute(Widget& to, std::string_view name, std::string_view value) override {
+		if(&to == &mRoot) mPrototype.attributes.emplace_back(name, value);
+		return to.setAttribute(name, StringAttribute(value));
+	}
+	void begin(std::string_view element, Widget& created) override {}
+	void end() override {}
+};
+
+// =============================================================
+// == Loading =============================================
+// =============================================================
+
+Form& Form::load(std::string const& path) {
+	if(!hasFactories()) addDefaultFactories();
+	if(mWatching) {
+		loadSource(path);
+		return *this;
+	}
+	mPath = path;
+
+	auto prototype = this->prototype(path);
+	if(prototype->cloneable) {
+		try {
+			instantiate(*prototype);
+			return *this;
+		}
+		catch(exceptions::InvalidOperation const&) {
+			prototype->cloneable = false;
+		}
+	}
+
+	try {
+		return parse(prototype->text.c_str());
+	}
+	catch(exceptions::ParsingError& e) {
+		e.setFile(path);
+		throw;
+	}
+}
+
+shared<Form::Prototype> Form::prototype(std::string const& path) {
+	std::error_code error;
+	auto modified = std::filesystem::last_write_time(path, error);
+	if(error) throw exceptions::FailedLoadingFile(path, error.message());
+
+	auto& cache = Prototype::cache();
+	{
+		std::lock_guard<std::mutex> lock(cache.mutex);
+		auto iter = cache.byPath.find(path);
+		if(iter != cache.byPath.end() && iter->second->modified == modified && iter->second->factories == mFactories)
+			return iter->second;
+	}
+
+	std::ifstream file(path, std::ios::binary);
+	if(!file) throw exceptions::FailedLoadingFile(path);
+
+	auto result = make_shared<Prototype>();
+	result->factories = mFactories;
+	result->modified  = modified;
+	result->text.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	result->form = make_shared<Form>();
+	result->form->mFactories = mFactories;
+
+	PrototypeRecorder recorder(*result->form, *result);
+	try {
+		result->form->parse(result->text.c_str(), &recorder);
+	}
+	catch(exceptions::ParsingError& e) {
+		e.setFile(path);
+		throw;
+	}
+
+	std::lock_guard<std::mutex> lock(cache.mutex);
+	cache.byPath[path] = result;
+	return result;
+}
+
+void Form::instantiate(Prototype const& prototype) {
+	// Everything is cloned before anything is changed, in case a widget can't be cloned
+	std::vector<shared<Widget>> children;
+	for(auto child = prototype.form->children(); child; child = child->nextSibling())
+		children.push_back(child->clone());
+
+	for(auto& [name, value] : prototype.attributes) {
+		if(!setAttribute(name, StringAttribute(value))) {
+			std::cerr << "Unknown attribute '" << name << "' for 'form'" << std::endl;
+		}
+	}
+
+	Widget* last = lastChild().get();
+	for(auto& child : children) {
+		if(last) last->insertNextSibling(child);
+		else     add(child);
+		last = child.get();
+	}
+}
+
+void Form::clearPrototypes() {
+	auto& cache = Prototype::cache();
+	std::lock_guard<std::mutex> lock(cache.mutex);
+	cache.byPath.clear();
+}
+
+} // namespace wwidget
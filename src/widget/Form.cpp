@@ -11,6 +11,32 @@
 
 namespace wwidget {
 
+// =============================================================
+// == FormFactories =============================================
+// =============================================================
+
+FormFactories::FormFactories(FormFactories const& other) :
+	mNames(other.mNames)
+{
+	mFactories.reserve(other.mFactories.size());
+	for(auto& name : mNames)
+		mFactories.emplace(name, other.mFactories.find(name)->second);
+}
+
+FormFactories::FactoryFn const* FormFactories::find(std::string_view name) const noexcept {
+	auto iter = mFactories.find(name);
+	return iter == mFactories.end() ? nullptr : &iter->second;
+}
+
+void FormFactories::set(std::string_view name, FactoryFn&& fn) {
+	auto& interned = *mNames.emplace(name).first;
+	mFactories[interned] = std::move(fn);
+}
+
+// =============================================================
+// == Form =============================================
+// =============================================================
+
 Form::Form() {}
 Form::Form(std::string const& path) :
 	Form()
@@ -22,7 +48,6 @@ Form::Form(std::istream& stream) :
 {
 	load(stream);
 }
-Form::~Form() noexcept {}
 
 Form::Form(Widget* addTo, std::string const& path) :
 	Form(path)
@@ -37,45 +62,52 @@ Form::Form(Widget* addTo, std::istream& stream) :
 
 void Form::onDraw(Canvas&) {}
 
+shared<Widget> Form::onClone() const {
+	auto copy = make_shared<Form>();
+	copy->mFactories = mFactories;
+	cloneAttributes(*copy);
+	return copy;
+}
+
 Form& Form::factory(std::string const& name, FactoryFn&& fn) {
-	mFactories[name] = std::move(fn);
+	factories().set(name, std::move(fn));
 	return *this;
 }
 
+FormFactories& Form::factories() {
+	if(!mFactories)
+		mFactories = make_shared<FormFactories>();
+	else if(mFactories.refcount() > 1)
+		mFactories = make_shared<FormFactories>(*mFactories);
+	return *mFactories;
+}
+
+shared<Widget> Form::create(FactoryFn const& factory) const {
+	auto w = factory();
+	assert(w);
+	// Nested forms use the same factories, without copying them
+	if(auto* form = dynamic_cast<Form*>(w.get()); form && !form->mFactories)
+		form->mFactories = mFactories;
+	return w;
+}
+
 Form& Form::factory(std::type_info const& type, FactoryFn&& fn) {
+	return factory(typeName(type), std::move(fn));
+}
+
+std::string Form::typeName(std::type_info const& type) {
 	// Getting the demangled name (Platform dependent)
 	#ifdef __GNUC__
 		int status;
 		char* demangled = abi::__cxa_demangle(type.name(), 0, 0, &status);
-		factory(std::string(demangled), std::move(fn));
+		std::string result(demangled);
 		free(demangled);
+		return result;
 	#elif defined(_WIN32)
-		factory(std::string(type.name()), std::move(fn));
+		return std::string(type.name());
 	#else
 		#error "Not supported for this compiler, please look above ^, implement it and submit a pull request."
 	#endif
-
-	return *this;
-}
-
-Form& Form::load(std::string const& path) {
-	if(mFactories.empty()) addDefaultFactories();
-
-	rapidxml::file<> file;
-	try {
-		file.load(path.c_str());
-	}
-	catch(std::runtime_error const& e) {
-		throw exceptions::FailedLoadingFile(path);
-	}
-
-	try {
-		return parse(file.data());
-	}
-	catch(exceptions::ParsingError& e) {
-		e.setFile(path);
-		throw;
-	}
 }
 
 Form& Form::load(std::istream& stream) {
@@ -85,6 +117,11 @@ Form& Form::load(std::istream& stream) {
 }
 
 Form& Form::parse(const char* text) {
+	parse(text, nullptr);
+	return *this;
+}
+
+void Form::parse(const char* text, ParseListener* listener) {
 	using namespace rapidxml;
 	constexpr int options = parse_comment_nodes | parse_non_destructive | parse_fastest;
 
@@ -98,10 +135,11 @@ Form& Form::parse(const char* text) {
 
 	auto buildRecursive = [=](auto& buildRecursive, shared<Widget> to, xml_node<>* to_data) -> void {
 		for(xml_attribute<>* attrib = to_data->first_attribute(); attrib; attrib = attrib->next_attribute()) {
-			bool success = to->setAttribute(
-				std::string_view(attrib->name(), attrib->name_size()),
-				StringAttribute(std::string(attrib->value(), attrib->value_size()))
-			);
+			std::string_view name(attrib->name(), attrib->name_size());
+			std::string_view value(attrib->value(), attrib->value_size()); // Non-destructive parsing, it points into the text
+			bool success = listener ?
+				listener->attribute(*to, name, value) :
+				to->setAttribute(name, StringAttribute(value));
 			if(!success) {
 				std::cerr <<
 					"Unknown attribute '" << std::string(attrib->name(), attrib->name_size()) <<
@@ -112,20 +150,24 @@ Form& Form::parse(const char* text) {
 		for(xml_node<>* data = to_data->first_node(); data; data = data->next_sibling()) {
 			switch(data->type()) {
 			case rapidxml::node_element: {
-				if(auto const& factory = mFactories[std::string(data->name(), data->name_size())]) {
-					auto w = factory();
-					assert(w);
+				std::string_view element(data->name(), data->name_size());
+				if(FactoryFn const* factory = mFactories ? mFactories->find(element) : nullptr; factory && *factory) {
+					auto w = create(*factory);
 
+					if(listener) listener->begin(element, *w);
 					buildRecursive(buildRecursive, to->add(std::move(w)), data);
+					if(listener) listener->end();
 				}
 				else {
-					throw exceptions::ParsingError("Unknown element type " + std::string(data->name(), data->name_size()), data->name(), text);
+					throw exceptions::ParsingError("Unknown element type " + std::string(element), data->name(), text);
 				}
 			} continue;
 			case rapidxml::node_cdata:
 			case rapidxml::node_data: {
-				std::string value = std::string(data->value(), data->value_size());
-				bool success = to->setAttribute("content", StringAttribute(value));
+				std::string_view value(data->value(), data->value_size());
+				bool success = listener ?
+					listener->attribute(*to, "content", value) :
+					to->setAttribute("content", StringAttribute(value));
 				if(!success) {
 					std::cerr <<
 						"Couldn't set content for " <<
@@ -143,16 +185,18 @@ Form& Form::parse(const char* text) {
 		throw exceptions::ParsingError("Expected a '<form>' element at root level");
 	}
 	buildRecursive(buildRecursive, shared_from_this(), form_data);
-
-	return *this;
 }
 
-bool Form::setAttribute(std::string_view name, Attribute const& value) {
-	if(name == "source" || name == "src") {
-		load(value.toString());
-		return true;
-	}
-	return Widget::setAttribute(name, value);
+AttributeTable const& Form::classAttributes() noexcept {
+	static constexpr AttributeInfo attributes[] = {
+		{ "src",    [](Widget& w, std::string s) { static_cast<Form&>(w).load(s); }, nullptr, "$.load(%);" },
+		{ "source", [](Widget& w, std::string s) { static_cast<Form&>(w).load(s); }, nullptr, "$.load(%);" },
+	};
+	static constexpr AttributeTable table("wwidget::Form", attributes, &Widget::classAttributes);
+	return table;
+}
+AttributeTable const& Form::attributeTable() const noexcept {
+	return classAttributes();
 }
 
 } // namespace wwidget
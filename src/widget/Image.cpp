@@ -164,24 +164,32 @@ void Image::onDrawBackground(Canvas& c) {
 	}
 }
 void Image::onDraw(Canvas& c) {}
-bool Image::setAttribute(std::string_view name, Attribute const& value) {
-	if(name == "src" || name == "source") {
-		this->image(value.toString()); return true;
-	}
-
-	if(name == "stretch") {
-		this->stretch(value.toBool()); return true;
-	}
-
-	if(name == "max-size") {
-		this->maxSize(value.toSize()); return true;
-	}
-
-	if(name == "tint") {
-		this->tint(value.toColor()); return true;
-	}
-
-	return Widget::setAttribute(name, value);
+shared<Widget> Image::onClone() const {
+	auto copy = make_shared<Image>();
+	cloneAttributes(*copy);
+	return copy;
+}
+void Image::cloneAttributes(Image& to) const {
+	Widget::cloneAttributes(to);
+	// The bitmap is shared, unless it's still loading
+	if(mImage)                 to.image(mImage, mSource);
+	else if(!mSource.empty()) to.image(mSource);
+	to.stretch(mStretch).maxSize(mMaxSize);
+	to.tint(mTint);
+}
+AttributeTable const& Image::classAttributes() noexcept {
+	static constexpr AttributeInfo attributes[] = {
+		{ "src",      [](Widget& w, std::string s) { static_cast<Image&>(w).image(s); }, nullptr, "$.image(std::string(%));" },
+		{ "source",   [](Widget& w, std::string s) { static_cast<Image&>(w).image(s); }, nullptr, "$.image(std::string(%));" },
+		{ "stretch",  [](Widget& w, bool b) { static_cast<Image&>(w).stretch(b); },  [](Widget const& w) { return static_cast<Image const&>(w).stretch(); }, "$.stretch(%);" },
+		{ "max-size", [](Widget& w, Size s) { static_cast<Image&>(w).maxSize(s); },  [](Widget const& w) { return static_cast<Image const&>(w).maxSize(); }, "$.maxSize(%);" },
+		{ "tint",     [](Widget& w, Color c) { static_cast<Image&>(w).tint(c); },    [](Widget const& w) { return static_cast<Image const&>(w).tint(); }, "$.tint(%);" },
+	};
+	static constexpr AttributeTable table("wwidget::Image", attributes, &Widget::classAttributes);
+	return table;
+}
+AttributeTable const& Image::attributeTable() const noexcept {
+	return classAttributes();
 }
 void Image::getAttributes(AttributeCollectorInterface& collector) {
 	if(collector.startSection("wwidget::Image")) {
@@ -24,6 +24,12 @@ Knob::Knob() {
 }
 Knob::~Knob() {}
 
+shared<Widget> Knob::onClone() const {
+	auto copy = make_shared<Knob>();
+	cloneAttributes(*copy);
+	return copy;
+}
+
 PreferredSize Knob::onCalcPreferredSize(PreferredSize const& constraint) {
 	PreferredSize result = Widget::onCalcPreferredSize(constraint);
 
@@ -2,7 +2,10 @@
 
 #include "../../include/wwidget/Canvas.hpp"
 #include "../../include/wwidget/AttributeCollector.hpp"
+#include "../../include/wwidget/Context.hpp"
+#include "../../include/wwidget/LayerCache.hpp"
 
+#include <algorithm>
 #include <cmath>
 
 namespace wwidget {
@@ -13,7 +16,9 @@ List::List() :
 	mScrollable(false),
 	mScrollOffset(0),
 	mTotalLength(0)
-{}
+{
+	handles(handles() | Scroll::handlerBit | Dragged::handlerBit);
+}
 List::List(Widget* addTo) : List() { addTo->add(*this); }
 List::~List() {}
 
@@ -61,7 +66,9 @@ void List::onLayout() {
 	if(practicallyScrollable())
 		pos -= mScrollOffset;
 
+	mLaidOut.clear();
 	for(Widget* child = children().get(); child; child = child->nextSibling().get()) {
+		mLaidOut.push_back(child);
 		auto& info = child->preferredSize({size()});
 
 		if(mFlow & BitFlowHorizontal) {
@@ -226,10 +233,12 @@ void List::on(Scroll const& scroll) {
 }
 
 void List::onAdd(Widget& child) {
+	mLaidOut.clear();
 	preferredSizeChanged();
 	requestRelayout();
 }
 void List::onRemove(Widget& child) {
+	mLaidOut.clear();
 	preferredSizeChanged();
 	requestRelayout();
 }
@@ -249,17 +258,50 @@ void List::onDraw(Canvas& c) {
 		 .fill();
 	}
 }
-bool List::setAttribute(std::string_view name, Attribute const& value) {
-	if(name == "flow") {
-		flow(value.toFlow()); return true;
+std::pair<Widget*, Widget*> List::visibleChildren(Rect const& area) {
+	if(mLaidOut.empty()) return Widget::visibleChildren(area);
+
+	// The children are laid out one after another, so the visible ones can be found by bisection
+	bool  horizontal = mFlow & BitFlowHorizontal;
+	float min = horizontal ? area.min.x : area.min.y;
+	float max = horizontal ? area.max.x : area.max.y;
+	auto  start = [&](Widget* w) { return horizontal ? w->offsetx() : w->offsety(); };
+	auto  end   = [&](Widget* w) { return horizontal ? w->offsetx() + w->width() : w->offsety() + w->height(); };
+
+	decltype(mLaidOut)::iterator first, last;
+	if(mFlow & BitFlowInvert) {
+		first = std::partition_point(mLaidOut.begin(), mLaidOut.end(), [&](Widget* w) { return start(w) >= max; });
+		last  = std::partition_point(first, mLaidOut.end(), [&](Widget* w) { return end(w) > min; });
 	}
-
-	if(name == "scrollable") {
-		scrollable(value.toBool());
-		return true;
+	else {
+		first = std::partition_point(mLaidOut.begin(), mLaidOut.end(), [&](Widget* w) { return end(w) <= min; });
+		last  = std::partition_point(first, mLaidOut.end(), [&](Widget* w) { return start(w) < max; });
 	}
-
-	return Widget::setAttribute(name, value);
+	return {
+		first == mLaidOut.end() ? nullptr : *first,
+		last  == mLaidOut.end() ? nullptr : *last
+	};
+}
+shared<Widget> List::onClone() const {
+	auto copy = make_shared<List>();
+	cloneAttributes(*copy);
+	return copy;
+}
+void List::cloneAttributes(List& to) const {
+	Widget::cloneAttributes(to);
+	to.flow(mFlow);
+	to.scrollable(mScrollable);
+}
+AttributeTable const& List::classAttributes() noexcept {
+	static constexpr AttributeInfo attributes[] = {
+		{ "flow",       [](Widget& w, Flow f) { static_cast<List&>(w).flow(f); },       [](Widget const& w) { return static_cast<List const&>(w).flow(); }, "$.flow(%);" },
+		{ "scrollable", [](Widget& w, bool b) { static_cast<List&>(w).scrollable(b); }, [](Widget const& w) { return static_cast<List const&>(w).scrollable(); }, "$.scrollable(%);" },
+	};
+	static constexpr AttributeTable table("wwidget::List", attributes, &Widget::classAttributes);
+	return table;
+}
+AttributeTable const& List::attributeTable() const noexcept {
+	return classAttributes();
 }
 void List::getAttributes(AttributeCollectorInterface& collector) {
 	if(collector.startSection("wwidget::List")) {
@@ -295,8 +337,17 @@ List& List::scrollable(bool b) {
 List& List::scrollOffset(float f) {
 	f = std::clamp(f, 0.f, maxScrollOffset());
 	if(f != mScrollOffset) {
+		// Scrolling moves the children, their layout stays the same
+		float delta = mScrollOffset - f;
+		Point move  = (mFlow & BitFlowHorizontal) ? Point(delta, 0) : Point(0, delta);
 		mScrollOffset = f;
-		requestRelayout();
+		for(Widget* child = children().get(); child; child = child->nextSibling().get()) {
+			child->offset(child->offsetx() + move.x, child->offsety() + move.y);
+		}
+
+		// Cached: move the last frame, only what scrolled into view and the scroll bar are drawn
+		if(!(cacheAsLayer() && context() && context()->layers().scroll(this, move, scrollBar())))
+			requestRedraw();
 	}
 	return *this;
 }
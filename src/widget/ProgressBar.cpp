@@ -43,16 +43,33 @@ void ProgressBar::onDraw(Canvas& canvas) {
 	// canvas.outlineRRect(100, 3, 0, 0, width(), height(), rgb(70, 70, 70));
 }
 
+shared<Widget> ProgressBar::onClone() const {
+	auto copy = make_shared<ProgressBar>();
+	cloneAttributes(*copy);
+	return copy;
+}
+void ProgressBar::cloneAttributes(ProgressBar& to) const {
+	Widget::cloneAttributes(to);
+	to.scale(mScale);
+	to.progress(mProgress);
+	to.mProgressInterpolated = mProgressInterpolated;
+}
+
+AttributeTable const& ProgressBar::classAttributes() noexcept {
+	static constexpr AttributeInfo attributes[] = {
+		{ "progress", [](Widget& w, float f) { static_cast<ProgressBar&>(w).progress(f); }, [](Widget const& w) { return static_cast<ProgressBar const&>(w).progress(); }, "$.progress(%);" },
+		{ "scale",    [](Widget& w, float f) { static_cast<ProgressBar&>(w).scale(f); },    [](Widget const& w) { return static_cast<ProgressBar const&>(w).scale(); }, "$.scale(%);" },
+	};
+	static constexpr AttributeTable table("wwidget::ProgressBar", attributes, &Widget::classAttributes);
+	return table;
+}
+AttributeTable const& ProgressBar::attributeTable() const noexcept {
+	return classAttributes();
+}
 bool ProgressBar::setAttribute(std::string_view name, Attribute const& value) {
-	if(name == "progress") {
-		try { progress(value.toFloat()); return true; }
-		catch(...) { return false; }
-	}
-	if(name == "scale") {
-		try { scale(value.toFloat()); return true; }
-		catch(...) { return false; }
-	}
-	return Widget::setAttribute(name, value);
+	// Values which aren't numbers are unknown attributes, instead of exceptions
+	try { return Widget::setAttribute(name, value); }
+	catch(std::logic_error const&) { return false; }
 }
 
 void ProgressBar::getAttributes(AttributeCollectorInterface& collector) {
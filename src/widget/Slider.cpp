@@ -14,6 +14,7 @@ Slider::Slider() :
 	mExponent(1)
 {
 	align(AlignFill);
+	handles(handles() | Scroll::handlerBit | Dragged::handlerBit);
 }
 Slider::Slider(Widget* addTo) :
 	Slider()
@@ -82,11 +83,26 @@ double Slider::valueToFraction(double x) const noexcept {
 	return std::clamp(x, 0.0, 1.0);
 }
 
-bool Slider::setAttribute(std::string_view name, Attribute const& value) {
-	if(name == "start")    { start(value.toFloat());    return true; }
-	if(name == "scale")    { scale(value.toFloat());    return true; }
-	if(name == "exponent") { exponent(value.toFloat()); return true; }
-	return Widget::setAttribute(name, value);
+shared<Widget> Slider::onClone() const {
+	auto copy = make_shared<Slider>();
+	cloneAttributes(*copy);
+	return copy;
+}
+void Slider::cloneAttributes(Slider& to) const {
+	Widget::cloneAttributes(to);
+	to.start(mStart)->scale(mScale)->exponent(mExponent)->value(mValue);
+}
+AttributeTable const& Slider::classAttributes() noexcept {
+	static constexpr AttributeInfo attributes[] = {
+		{ "start",    [](Widget& w, float f) { static_cast<Slider&>(w).start(f); },    [](Widget const& w) { return (float) static_cast<Slider const&>(w).start(); }, "$.start(%);" },
+		{ "scale",    [](Widget& w, float f) { static_cast<Slider&>(w).scale(f); },    [](Widget const& w) { return (float) static_cast<Slider const&>(w).scale(); }, "$.scale(%);" },
+		{ "exponent", [](Widget& w, float f) { static_cast<Slider&>(w).exponent(f); }, [](Widget const& w) { return (float) static_cast<Slider const&>(w).exponent(); }, "$.exponent(%);" },
+	};
+	static constexpr AttributeTable table("wwidget::Slider", attributes, &Widget::classAttributes);
+	return table;
+}
+AttributeTable const& Slider::attributeTable() const noexcept {
+	return classAttributes();
 }
 void Slider::getAttributes(AttributeCollectorInterface& collector) {
 	if(collector.startSection("wwidget::Slider")) {
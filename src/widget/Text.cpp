@@ -2,6 +2,7 @@
 
 #include "../../include/wwidget/Context.hpp"
 #include "../../include/wwidget/Canvas.hpp"
+#include "../../include/wwidget/TextMetricsCache.hpp"
 
 #include "../../include/wwidget/AttributeCollector.hpp"
 
@@ -12,6 +13,7 @@ Text::Text() :
 	Widget(),
 	mFontColor(Color::white()),
 	mFontSize(0.f),
+	mTextHash(fnv1a(std::string_view())),
 	mWrap(false)
 {}
 Text::Text(std::string content) :
@@ -36,7 +38,9 @@ Text::Text(Text&& other) noexcept :
 	mFontColor(other.mFontColor),
 	mFontSize(0.f),
 	mFont(std::move(other.mFont)),
-	mText(std::move(other.mText))
+	mText(std::move(other.mText)),
+	mTextHash(other.mTextHash),
+	mWrap(other.mWrap)
 {
 	other.mFontColor = Color::white();
 }
@@ -46,16 +50,22 @@ Text& Text::operator=(Text&& other) noexcept {
 	mFontSize  = other.mFontSize;
 	mFont      = std::move(other.mFont);
 	mText      = std::move(other.mText);
+	mTextHash  = other.mTextHash;
+	mWrap      = other.mWrap;
 	return *this;
 }
 
 Text& Text::content(std::string s) {
+	setContent(std::move(s));
+	return *this;
+}
+void Text::setContent(std::string s) {
 	if(mText != s) {
-		mText = std::move(s);
+		mText     = std::move(s);
+		mTextHash = fnv1a(mText);
 		preferredSizeChanged();
 		requestRedraw();
 	}
-	return *this;
 }
 Text& Text::font(std::string const& name) {
 	if(mFont != name) {
@@ -83,17 +93,32 @@ Text& Text::wrap(bool b) {
 	return *this;
 }
 
-bool Text::setAttribute(std::string_view name, Attribute const& value) {
-	if(name == "content") { content(value.toString()); return true; }
-	if(name == "font")    { font(value.toString()); return true; }
-	if(name == "fontColor") { fontColor(value.toColor()); return true; }
-	if(name == "fontSize") { fontSize(value.toFloat()); return true; }
-	if(name == "wrap") { wrap(value.toBool()); return true; }
-	return Widget::setAttribute(name, value);
+shared<Widget> Text::onClone() const {
+	auto copy = make_shared<Text>();
+	cloneAttributes(*copy);
+	return copy;
+}
+void Text::cloneAttributes(Text& to) const {
+	Widget::cloneAttributes(to);
+	to.content(content()).font(mFont).fontColor(mFontColor).fontSize(mFontSize).wrap(mWrap);
+}
+AttributeTable const& Text::classAttributes() noexcept {
+	static constexpr AttributeInfo attributes[] = {
+		{ "content",   [](Widget& w, std::string s) { static_cast<Text&>(w).content(std::move(s)); }, [](Widget const& w) { return static_cast<Text const&>(w).content(); }, "$.content(%);" },
+		{ "font",      [](Widget& w, std::string s) { static_cast<Text&>(w).font(s); },               [](Widget const& w) { return static_cast<Text const&>(w).font(); }, "$.font(%);" },
+		{ "fontColor", [](Widget& w, Color c) { static_cast<Text&>(w).fontColor(c); },                [](Widget const& w) { return static_cast<Text const&>(w).fontColor(); }, "$.fontColor(%);" },
+		{ "fontSize",  [](Widget& w, float f) { static_cast<Text&>(w).fontSize(f); },                 [](Widget const& w) { return static_cast<Text const&>(w).fontSize(); }, "$.fontSize(%);" },
+		{ "wrap",      [](Widget& w, bool b) { static_cast<Text&>(w).wrap(b); },                      [](Widget const& w) { return static_cast<Text const&>(w).wrap(); }, "$.wrap(%);" },
+	};
+	static constexpr AttributeTable table("wwidget::Text", attributes, &Widget::classAttributes);
+	return table;
+}
+AttributeTable const& Text::attributeTable() const noexcept {
+	return classAttributes();
 }
 void Text::getAttributes(AttributeCollectorInterface& collector) {
 	if(collector.startSection("wwidget::Text")) {
-		collector("content",   mText, "");
+		collector("content",   content(), "");
 		collector("font",      mFont, "");
 		collector("fontSize",  mFontSize, 0);
 		collector("fontColor", mFontColor, Color::white());
@@ -112,42 +137,31 @@ PreferredSize Text::onCalcPreferredSize(PreferredSize const& constraint) {
 	auto* ctxt = context();
 	if(!ctxt) return {};
 
-	auto& c = ctxt->canvas();
-
-	c.fillColor(mFontColor)
-	 .font(mFont.c_str())
-	 .fontSize(mFontSize);
+	float wrapWidth = mWrap ? constraint.max.x : TextMetricsCache::NoWrap;
 
-	PreferredSize size;
-
-	if(mWrap) {
-		size = {
-			{5},
-			c.textBoxBounds({}, constraint.max.x, mText).size(),
-			Size::infinite()
-		};
-	}
-	else {
-		size = {
-			{5},
-			c.textBounds({}, mText).size(),
-			Size::infinite()
-		};
-	}
+	PreferredSize size = {
+		{5},
+		ctxt->textMetrics().bounds(ctxt->canvas(), mFont, mFontSize, 0, wrapWidth, mText, mTextHash).size(),
+		Size::infinite()
+	};
 
 	size.sanitize();
 
 	return size;
 }
 void Text::onDraw(Canvas& c) {
+	float ascend = context() ?
+		context()->textMetrics().fontMetrics(c, mFont, mFontSize).ascend :
+		c.font(mFont.c_str()).fontSize(mFontSize).fontMetrics().ascend;
+
 	c.fillColor(mFontColor)
 	 .font(mFont.c_str())
 	 .fontSize(mFontSize);
 
 	if(mWrap)
-		c.textBox(Point(0, c.fontMetrics().ascend), width(), mText);
+		c.textBox(Point(0, ascend), width(), mText);
 	else
-		c.text(Point(0, c.fontMetrics().ascend), mText);
+		c.text(Point(0, ascend), mText);
 }
 
 } // namespace wwidget
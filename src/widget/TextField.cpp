@@ -1,10 +1,39 @@
 #include "../../include/wwidget/widget/TextField.hpp"
 #include "../../include/wwidget/Canvas.hpp"
+#include "../../include/wwidget/Context.hpp"
+#include "../../include/wwidget/TextMetricsCache.hpp"
 
 namespace wwidget {
 
-TextField::TextField() {
+namespace {
+
+enum Scancode { // X11
+	ScancodeBackspace = 22,
+	ScancodeEnter     = 36,
+	ScancodeA         = 38,
+	ScancodeHome      = 110,
+	ScancodeLeft      = 113,
+	ScancodeRight     = 114,
+	ScancodeEnd       = 115,
+	ScancodeDelete    = 119,
+};
+enum Mods { // Same as GLFW
+	ModShift   = 1,
+	ModControl = 2,
+};
+
+} // namespace
+
+TextField::TextField() :
+	mContentValid(true),
+	mUpdatePending(false),
+	mMeasuredSize(0),
+	mMeasured(false),
+	mScrollX(0),
+	mPreferredWidth(0)
+{
 	align(AlignFill, AlignMin);
+	handles(handles() | TextInput::handlerBit);
 }
 TextField::TextField(Widget* addTo) :
 	TextField()
@@ -16,51 +45,172 @@ TextField::~TextField() {}
 
 bool TextField::onFocus(bool b, FocusType type) { return true; }
 
-void TextField::on(KeyEvent const& k) {
-	if(k.scancode == 22) { // Backspace
-		k.handled = true;
-
-		if(k.state != Event::UP) {
-			std::string c = content();
-			while(!c.empty()) {
-				bool wasContinuationByte = (c[c.size() - 1] & 0xC0) == 0x80;
-				c.pop_back();
-				if(!wasContinuationByte)
-					break;
-			}
-			content(c);
-		}
+TextBuffer::Measure TextField::measure() {
+	auto* ctxt = context();
+	if(!ctxt) return nullptr;
+	return [this, ctxt](std::string_view character) {
+		return ctxt->textMetrics().bounds(ctxt->canvas(), mFont, mFontSize, 0, TextMetricsCache::NoWrap, character).width();
+	};
+}
+
+void TextField::ensureMeasured() {
+	if(mMeasured && mMeasuredFont == mFont && mMeasuredSize == mFontSize) return;
+	if(auto m = measure()) {
+		mBuffer.remeasure(m);
+		mMeasuredFont = mFont;
+		mMeasuredSize = mFontSize;
+		mMeasured     = true;
+	}
+}
+
+void TextField::edited() {
+	mContentValid = false;
+
+	// The preferred width only matters once the text doesn't fit anymore
+	if(mBuffer.width() > width() || mPreferredWidth > width()) {
+		preferredSizeChanged();
 	}
-	else if(k.scancode == 36) { // Enter
-		k.handled = true;
-		if(k.state != Event::UP) {
-			if(mOnReturn) {
-				defer(mOnReturn);
+	requestRedraw();
+
+	if(mOnUpdate && !mUpdatePending) {
+		mUpdatePending = true;
+		defer([this]() {
+			mUpdatePending = false;
+			if(mOnUpdate) mOnUpdate();
+		});
+	}
+}
+
+void TextField::on(KeyEvent const& k) {
+	bool shift = k.mods & ModShift;
+	bool ctrl  = k.mods & ModControl;
+
+	bool handled = true;
+	switch(k.scancode) {
+		case ScancodeBackspace: if(k.state != Event::UP) { mBuffer.eraseBackward(); edited(); } break;
+		case ScancodeDelete:    if(k.state != Event::UP) { mBuffer.eraseForward(); edited(); } break;
+		case ScancodeLeft:      if(k.state != Event::UP) { mBuffer.moveLeft(shift); requestRedraw(); } break;
+		case ScancodeRight:     if(k.state != Event::UP) { mBuffer.moveRight(shift); requestRedraw(); } break;
+		case ScancodeHome:      if(k.state != Event::UP) { mBuffer.moveHome(shift); requestRedraw(); } break;
+		case ScancodeEnd:       if(k.state != Event::UP) { mBuffer.moveEnd(shift); requestRedraw(); } break;
+		case ScancodeA:
+			if(!ctrl) { handled = false; break; }
+			if(k.state != Event::UP) { mBuffer.selectAll(); requestRedraw(); }
+			break;
+		case ScancodeEnter:
+			if(k.state != Event::UP && mOnReturn) {
+				defer(TaskPriority::Input, mOnReturn);
 			}
-		}
+			break;
+		default: handled = false; break;
 	}
+	if(handled) k.handled = true;
+
 	Widget::on(k);
 }
 
 void TextField::on(wwidget::TextInput const& t) {
-	content(content() + t.utf8);
+	ensureMeasured();
+	mBuffer.insert(t.utf8, measure());
+	edited();
 
 	t.handled = true;
 }
 
+void TextField::on(Click const& click) {
+	if(click.down()) {
+		ensureMeasured();
+		mBuffer.moveCursor(mBuffer.positionAt(click.position.x + mScrollX));
+		requestRedraw();
+	}
+	Widget::on(click);
+}
+
+void TextField::onContextChanged() {
+	mMeasured = false;
+	Text::onContextChanged();
+}
+
+PreferredSize TextField::onCalcPreferredSize(PreferredSize const& constraint) {
+	auto* ctxt = context();
+	if(!ctxt) return {};
+
+	ensureMeasured();
+	FontMetrics metrics = ctxt->textMetrics().fontMetrics(ctxt->canvas(), mFont, mFontSize);
+
+	mPreferredWidth = mBuffer.width();
+	PreferredSize size = {
+		{5},
+		{mBuffer.width(), metrics.line_height},
+		Size::infinite()
+	};
+	size.sanitize();
+	return size;
+}
+
 void TextField::onDraw(Canvas& c) {
-	Text::onDraw(c);
+	ensureMeasured();
+
+	float ascend = context() ?
+		context()->textMetrics().fontMetrics(c, mFont, mFontSize).ascend :
+		c.font(mFont.c_str()).fontSize(mFontSize).fontMetrics().ascend;
+
+	// Scroll just enough to keep the cursor visible
+	float cursor = mBuffer.cursorX();
+	if(cursor - mScrollX > width() - 2) mScrollX = cursor - width() + 2;
+	if(cursor - mScrollX < 0)           mScrollX = cursor;
+	mScrollX = std::clamp(mScrollX, 0.f, std::max(0.f, mBuffer.width() - width() + 2));
+
+	if(mBuffer.hasSelection()) {
+		float x0 = mBuffer.xAt(mBuffer.selectionBegin()) - mScrollX;
+		float x1 = mBuffer.xAt(mBuffer.selectionEnd()) - mScrollX;
+		c.fillColor(rgba(215, 150, 0, .35f))
+		 .rect({x0, 0, x1 - x0, height()})
+		 .fill();
+	}
+
+	// The text on both sides of the gap, no need to copy it into one string
+	c.fillColor(mFontColor)
+	 .font(mFont.c_str())
+	 .fontSize(mFontSize);
+	c.text(Point(-mScrollX, ascend), mBuffer.beforeCursor());
+	c.text(Point(cursor - mScrollX, ascend), mBuffer.afterCursor());
+
+	if(focused()) {
+		c.fillColor(rgb(215, 150, 0))
+		 .rect({cursor - mScrollX, 2, 1, height() - 4})
+		 .fill();
+	}
+
 	c.strokeColor(focused() ? rgb(215, 150, 0) : rgba(0, 0, 0, 0.3))
 	 .rect(size())
 	 .stroke();
 }
 
+std::string const& TextField::content() const {
+	if(!mContentValid) {
+		mContent      = mBuffer.str();
+		mContentValid = true;
+	}
+	return mContent;
+}
 TextField* TextField::content(std::string c) {
-	Text::content(c);
+	setContent(std::move(c));
+	return this;
+}
+void TextField::setContent(std::string c) {
+	if(content() == c) return;
+
+	ensureMeasured();
+	mBuffer.assign(c, measure());
+	mContent      = std::move(c);
+	mContentValid = true;
+
+	preferredSizeChanged();
+	requestRedraw();
 	if(mOnUpdate) {
 		defer(mOnUpdate);
 	}
-	return this;
 }
 
 TextField* TextField::onReturn(std::function<void()> ret) {
@@ -70,4 +220,23 @@ TextField* TextField::onUpdate(std::function<void()> update) {
 	mOnUpdate = std::move(update); return this;
 }
 
+shared<Widget> TextField::onClone() const {
+	auto copy = make_shared<TextField>();
+	cloneAttributes(*copy);
+	return copy;
+}
+void TextField::cloneAttributes(TextField& to) const {
+	Text::cloneAttributes(to);
+}
+AttributeTable const& TextField::classAttributes() noexcept {
+	static constexpr AttributeInfo attributes[] = {
+		{ "content", [](Widget& w, std::string s) { static_cast<TextField&>(w).content(std::move(s)); }, [](Widget const& w) { return static_cast<TextField const&>(w).content(); }, "$.content(%);" },
+	};
+	static constexpr AttributeTable table("wwidget::TextField", attributes, &Text::classAttributes);
+	return table;
+}
+AttributeTable const& TextField::attributeTable() const noexcept {
+	return classAttributes();
+}
+
 } // namespace wwidget
@@ -0,0 +1,323 @@
+#include "../../include/wwidget/widget/TextView.hpp"
+
+#include "../../include/wwidget/Context.hpp"
+#include "../../include/wwidget/Canvas.hpp"
+#include "../../include/wwidget/TextMetricsCache.hpp"
+#include "../../include/wwidget/AttributeCollector.hpp"
+#include "../../include/wwidget/Error.hpp"
+
+#include <cmath>
+
+namespace wwidget {
+
+TextView::TextView() :
+	List(),
+	mTotalLines(0),
+	mWrapCount(0),
+	mFontColor(Color::white()),
+	mFontSize(0.f),
+	mWrap(true),
+	mWrapWidth(0),
+	mLineHeight(18),
+	mAscend(14),
+	mMetricsChanged(true)
+{
+	scrollable(true);
+}
+TextView::TextView(Widget* addTo) : TextView() { addTo->add(*this); }
+TextView::~TextView() {}
+
+// =============================================================
+// == Content =============================================
+// =============================================================
+
+TextView& TextView::content(std::string_view text) {
+	mParagraphs.clear();
+	mBlockLines.clear();
+	mTotalLines = 0;
+	return replace(0, 0, text);
+}
+std::string TextView::content() const {
+	std::string result;
+	for(size_t i = 0; i < mParagraphs.size(); i++) {
+		if(i > 0) result += '\n';
+		result += mParagraphs[i].text;
+	}
+	return result;
+}
+
+TextView& TextView::append(std::string_view text) {
+	if(mParagraphs.empty()) return replace(0, 0, text);
+
+	size_t newline = text.find('\n');
+	size_t last    = mParagraphs.size() - 1;
+
+	auto&  p        = mParagraphs[last];
+	size_t oldCount = lineCountOf(p);
+	p.text += text.substr(0, newline);
+	p.wrappedFor = -1;
+	size_t newCount = lineCountOf(p);
+	mBlockLines[last / BlockSize] += newCount - oldCount;
+	mTotalLines                   += newCount - oldCount;
+
+	if(newline != std::string_view::npos)
+		return replace(mParagraphs.size(), 0, text.substr(newline + 1));
+
+	totalLength(mTotalLines * mLineHeight);
+	requestRelayout();
+	requestRedraw();
+	return *this;
+}
+
+TextView& TextView::replace(size_t first, size_t count, std::string_view text) {
+	first = std::min(first, mParagraphs.size());
+	count = std::min(count, mParagraphs.size() - first);
+
+	std::vector<Paragraph> inserted;
+	size_t pos = 0;
+	while(true) {
+		size_t end = text.find('\n', pos);
+		inserted.push_back({ std::string(text.substr(pos, end - pos)), {}, -1 });
+		if(end == std::string_view::npos) break;
+		pos = end + 1;
+	}
+
+	// Paragraphs behind the edit only move to other blocks if the number of paragraphs changes
+	size_t last = inserted.size() == count ? first + count : mParagraphs.size() - count + inserted.size();
+
+	mParagraphs.erase(mParagraphs.begin() + first, mParagraphs.begin() + first + count);
+	mParagraphs.insert(mParagraphs.begin() + first,
+		std::make_move_iterator(inserted.begin()), std::make_move_iterator(inserted.end()));
+
+	rebuildBlocks(first, last);
+	totalLength(mTotalLines * mLineHeight);
+	requestRelayout();
+	requestRedraw();
+	return *this;
+}
+
+// =============================================================
+// == Line breaking =============================================
+// =============================================================
+
+size_t TextView::lineCountOf(Paragraph const& p) const noexcept {
+	if(!stale(p)) return p.lines.size();
+	if(!mWrap || p.text.empty() || mWrapWidth <= 0) return 1;
+
+	// Scale the last result, or guess from the length
+	if(p.wrappedFor > 0)
+		return std::max<size_t>(1, (size_t) std::lround(p.lines.size() * p.wrappedFor / mWrapWidth));
+
+	float charWidth = (mFontSize > 0 ? mFontSize : 18) * .5f;
+	return std::max<size_t>(1, (size_t) std::ceil(p.text.size() * charWidth / mWrapWidth));
+}
+
+void TextView::wrap(Canvas& c, size_t index) {
+	auto&  p        = mParagraphs[index];
+	size_t oldCount = lineCountOf(p);
+
+	p.lines.clear();
+	if(mWrap && !p.text.empty() && mWrapWidth > 0)
+		c.textBreakLines(p.text, mWrapWidth, p.lines);
+	else
+		p.lines.push_back(0);
+	p.wrappedFor = mWrapWidth;
+	++mWrapCount;
+
+	size_t newCount = p.lines.size();
+	mBlockLines[index / BlockSize] += newCount - oldCount;
+	mTotalLines                    += newCount - oldCount;
+}
+
+void TextView::rebuildBlocks(size_t firstParagraph, size_t endParagraph) {
+	size_t blocks = (mParagraphs.size() + BlockSize - 1) / BlockSize;
+	mBlockLines.resize(blocks);
+
+	size_t endBlock = std::min(blocks, (endParagraph + BlockSize - 1) / BlockSize);
+	for(size_t b = firstParagraph / BlockSize; b < endBlock; b++) {
+		size_t lines = 0;
+		size_t end   = std::min(mParagraphs.size(), (b + 1) * BlockSize);
+		for(size_t i = b * BlockSize; i < end; i++)
+			lines += lineCountOf(mParagraphs[i]);
+		mBlockLines[b] = lines;
+	}
+
+	mTotalLines = 0;
+	for(size_t lines : mBlockLines) mTotalLines += lines;
+}
+
+size_t TextView::paragraphAt(size_t line, size_t& lineInParagraph) const noexcept {
+	size_t b = 0;
+	while(b < mBlockLines.size() && line >= mBlockLines[b]) {
+		line -= mBlockLines[b];
+		++b;
+	}
+
+	size_t end = std::min(mParagraphs.size(), (b + 1) * BlockSize);
+	for(size_t i = b * BlockSize; i < end; i++) {
+		size_t count = lineCountOf(mParagraphs[i]);
+		if(line < count) {
+			lineInParagraph = line;
+			return i;
+		}
+		line -= count;
+	}
+
+	lineInParagraph = 0;
+	return mParagraphs.size();
+}
+
+void TextView::invalidate() {
+	for(auto& p : mParagraphs) p.wrappedFor = -1;
+	mMetricsChanged = true;
+	rebuildBlocks(0, mParagraphs.size());
+	requestRelayout();
+	requestRedraw();
+}
+
+void TextView::updateMetrics(Canvas& c) {
+	if(!mMetricsChanged) return;
+	mMetricsChanged = false;
+
+	FontMetrics metrics = context() ?
+		context()->textMetrics().fontMetrics(c, mFont, mFontSize) :
+		c.font(mFont.c_str()).fontSize(mFontSize).fontMetrics();
+	mLineHeight = metrics.line_height > 0 ? metrics.line_height : (mFontSize > 0 ? mFontSize : 18);
+	mAscend     = metrics.ascend;
+}
+
+// =============================================================
+// == Widget =============================================
+// =============================================================
+
+void TextView::onContextChanged() {
+	invalidate();
+}
+
+void TextView::onAdd(Widget& child) {
+	throw exceptions::InvalidOperation("TextView can't have children");
+}
+
+PreferredSize TextView::onCalcPreferredSize(PreferredSize const& constraint) {
+	PreferredSize result = {
+		{ 0,   mLineHeight },
+		{ 400, mLineHeight * 20 },
+		Size::infinite()
+	};
+	result.sanitize();
+	return result;
+}
+
+void TextView::onLayout() {
+	if(context()) updateMetrics(context()->canvas());
+
+	if(width() != mWrapWidth) {
+		// Stale paragraphs are re-wrapped when they become visible, until then their line count is estimated
+		mWrapWidth = width();
+		rebuildBlocks(0, mParagraphs.size());
+	}
+	totalLength(mTotalLines * mLineHeight);
+	scrollOffset(scrollOffset()); // Clamp, the content might have become shorter
+	requestRedraw();
+}
+
+void TextView::onDraw(Canvas& c) {
+	updateMetrics(c);
+
+	c.fillColor(mFontColor)
+	 .font(mFont.c_str())
+	 .fontSize(mFontSize);
+
+	float  offset = practicallyScrollable() ? scrollOffset() : 0;
+	size_t first  = (size_t) (offset / mLineHeight);
+	float  y      = first * mLineHeight - offset;
+
+	size_t line;
+	for(size_t i = paragraphAt(first, line); i < mParagraphs.size() && y < height(); i++, line = 0) {
+		if(stale(mParagraphs[i])) wrap(c, i);
+
+		auto& p = mParagraphs[i];
+		std::string_view text = p.text;
+		for(; line < p.lines.size() && y < height(); line++) {
+			size_t begin = p.lines[line];
+			size_t end   = line + 1 < p.lines.size() ? p.lines[line + 1] : text.size();
+			mVisibleLines.push_back({ Point(0, y + mAscend), text.substr(begin, end - begin) });
+			y += mLineHeight;
+		}
+	}
+	c.glyphRuns(mVisibleLines.data(), mVisibleLines.size());
+	mVisibleLines.clear();
+
+	totalLength(mTotalLines * mLineHeight);
+
+	List::onDraw(c);
+}
+
+// =============================================================
+// == Attributes =============================================
+// =============================================================
+
+TextView& TextView::font(std::string const& name) {
+	if(mFont != name) {
+		mFont = name;
+		invalidate();
+	}
+	return *this;
+}
+TextView& TextView::fontColor(Color const& c) {
+	mFontColor = c;
+	requestRedraw();
+	return *this;
+}
+TextView& TextView::fontSize(float f) {
+	if(mFontSize != f) {
+		mFontSize = f;
+		invalidate();
+	}
+	return *this;
+}
+TextView& TextView::wrap(bool b) {
+	if(mWrap != b) {
+		mWrap = b;
+		invalidate();
+	}
+	return *this;
+}
+
+shared<Widget> TextView::onClone() const {
+	auto copy = make_shared<TextView>();
+	cloneAttributes(*copy);
+	return copy;
+}
+void TextView::cloneAttributes(TextView& to) const {
+	List::cloneAttributes(to);
+	to.font(mFont).fontColor(mFontColor).fontSize(mFontSize).wrap(mWrap);
+	to.content(content());
+}
+AttributeTable const& TextView::classAttributes() noexcept {
+	static constexpr AttributeInfo attributes[] = {
+		{ "content",   [](Widget& w, std::string s) { static_cast<TextView&>(w).content(s); },   [](Widget const& w) { return static_cast<TextView const&>(w).content(); }, "$.content(%);" },
+		{ "font",      [](Widget& w, std::string s) { static_cast<TextView&>(w).font(s); },      [](Widget const& w) { return static_cast<TextView const&>(w).font(); }, "$.font(%);" },
+		{ "fontColor", [](Widget& w, Color c) { static_cast<TextView&>(w).fontColor(c); },       [](Widget const& w) { return static_cast<TextView const&>(w).fontColor(); }, "$.fontColor(%);" },
+		{ "fontSize",  [](Widget& w, float f) { static_cast<TextView&>(w).fontSize(f); },        [](Widget const& w) { return static_cast<TextView const&>(w).fontSize(); }, "$.fontSize(%);" },
+		{ "wrap",      [](Widget& w, bool b) { static_cast<TextView&>(w).wrap(b); },             [](Widget const& w) { return static_cast<TextView const&>(w).wrap(); }, "$.wrap(%);" },
+	};
+	static constexpr AttributeTable table("wwidget::TextView", attributes, &List::classAttributes);
+	return table;
+}
+AttributeTable const& TextView::attributeTable() const noexcept {
+	return classAttributes();
+}
+void TextView::getAttributes(AttributeCollectorInterface& collector) {
+	if(collector.startSection("wwidget::TextView")) {
+		collector("content",   content(), "");
+		collector("font",      mFont, "");
+		collector("fontSize",  mFontSize, 0);
+		collector("fontColor", mFontColor, Color::white());
+		collector("wrap",      mWrap, true);
+		collector.endSection();
+	}
+	List::getAttributes(collector);
+}
+
+} // namespace wwidget